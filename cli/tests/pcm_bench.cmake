@@ -0,0 +1,95 @@
+# Times decode-only PCM rendering (vgmstream-cli -O), to compare PCM decoder changes.
+# Uses any files as PCM data (via .txth) so it doesn't need real game files; the RIFF case is
+# rendered from the TXTH one. Pass CLI_BASE (a vgmstream-cli built from another commit) to compare.
+#
+# usage: cmake -DCLI=<vgmstream-cli> [-DCLI_BASE=<vgmstream-cli>] -DSOURCE_DIR=<vgmstream dir>
+#            -DWORK_DIR=<temp dir> [-DSIZE_MB=80] [-DRUNS=3] -P pcm_bench.cmake
+# (needs CMake 3.23+ for sub-second timestamps)
+
+if(NOT SIZE_MB)
+	set(SIZE_MB 80)
+endif()
+if(NOT RUNS)
+	set(RUNS 3)
+endif()
+
+get_filename_component(CLI ${CLI} ABSOLUTE)
+if(CLI_BASE)
+	get_filename_component(CLI_BASE ${CLI_BASE} ABSOLUTE)
+endif()
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# ~1MB of data, written SIZE_MB times
+file(READ ${SOURCE_DIR}/doc/BUILD.md DATA)
+string(LENGTH "${DATA}" DATA_SIZE)
+while(DATA_SIZE LESS 1048576)
+	string(APPEND DATA "${DATA}")
+	string(LENGTH "${DATA}" DATA_SIZE)
+endwhile()
+file(WRITE ${WORK_DIR}/data.bin "")
+foreach(i RANGE 1 ${SIZE_MB})
+	file(APPEND ${WORK_DIR}/data.bin "${DATA}")
+endforeach()
+
+# name, txth pairs (same data with different codecs/layouts)
+set(CASES
+	"s16le_i2;codec = PCM16LE\nchannels = 2\ninterleave = 2\n"
+	"s16be_i2;codec = PCM16BE\nchannels = 2\ninterleave = 2\n"
+	"s8_i1;codec = PCM8\nchannels = 2\ninterleave = 1\n"
+	"s16le_4ch;codec = PCM16LE\nchannels = 4\ninterleave = 0x10000\n")
+list(LENGTH CASES CASES_COUNT)
+math(EXPR CASES_LAST "${CASES_COUNT} - 1")
+foreach(i RANGE 0 ${CASES_LAST} 2)
+	math(EXPR j "${i} + 1")
+	list(GET CASES ${i} NAME)
+	list(GET CASES ${j} TXTH)
+	file(CREATE_LINK ${WORK_DIR}/data.bin ${WORK_DIR}/${NAME}.bin COPY_ON_ERROR)
+	file(WRITE ${WORK_DIR}/${NAME}.bin.txth "${TXTH}sample_rate = 48000\nnum_samples = data_size\n")
+	list(APPEND FILES ${NAME}.bin)
+endforeach()
+
+execute_process(
+	COMMAND ${CLI} -o riff.wav s16le_i2.bin
+	WORKING_DIRECTORY ${WORK_DIR}
+	RESULT_VARIABLE RESULT
+	OUTPUT_QUIET)
+if(NOT RESULT EQUAL 0)
+	message(FATAL_ERROR "vgmstream-cli failed making riff.wav: ${RESULT}")
+endif()
+list(PREPEND FILES riff.wav)
+
+# best of RUNS, in ms
+function(bench EXE FILENAME)
+	set(BEST "")
+	foreach(i RANGE 1 ${RUNS})
+		string(TIMESTAMP START "%s%f")
+		execute_process(
+			COMMAND ${EXE} -O ${FILENAME}
+			WORKING_DIRECTORY ${WORK_DIR}
+			RESULT_VARIABLE RESULT
+			OUTPUT_QUIET)
+		string(TIMESTAMP END "%s%f")
+		if(NOT RESULT EQUAL 0)
+			message(FATAL_ERROR "${EXE} -O ${FILENAME} failed: ${RESULT}")
+		endif()
+		math(EXPR TIME "(${END} - ${START}) / 1000")
+		if(BEST STREQUAL "" OR TIME LESS BEST)
+			set(BEST ${TIME})
+		endif()
+	endforeach()
+	set(TIME ${BEST} PARENT_SCOPE)
+endfunction()
+
+message(STATUS "decode-only PCM, ${SIZE_MB}MB, best of ${RUNS}")
+foreach(FILENAME ${FILES})
+	bench(${CLI} ${FILENAME})
+	set(LINE "${FILENAME}: ${TIME}ms")
+	if(CLI_BASE)
+		set(CLI_TIME ${TIME})
+		bench(${CLI_BASE} ${FILENAME})
+		set(LINE "${FILENAME}: ${TIME}ms (base) -> ${CLI_TIME}ms")
+	endif()
+	message(STATUS "  ${LINE}")
+endforeach()
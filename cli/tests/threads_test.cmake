@@ -0,0 +1,51 @@
+# Checks that threaded rendering (-j layers, -n segment preroll) outputs the same as regular rendering.
+# Uses any files as PCM data (via .txth) so it doesn't need real game files.
+#
+# usage: cmake -DCLI=<vgmstream-cli> -DSOURCE_DIR=<vgmstream dir> -DWORK_DIR=<temp dir> -P threads_test.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+configure_file(${SOURCE_DIR}/doc/BUILD-LIB.md ${WORK_DIR}/a.bin COPYONLY)
+configure_file(${SOURCE_DIR}/doc/BUILD.md ${WORK_DIR}/b.bin COPYONLY)
+file(WRITE ${WORK_DIR}/.bin.txth
+	"codec = PCM16LE\n"
+	"channels = 1\n"
+	"sample_rate = 32000\n"
+	"num_samples = data_size\n")
+
+# many segments made of layers, so preroll and layer threads render at the same time
+set(TXTP "")
+foreach(i RANGE 1 40)
+	string(APPEND TXTP "a.bin\nb.bin\n")
+endforeach()
+string(APPEND TXTP "group = 1L2R\n")
+file(WRITE ${WORK_DIR}/threads.txtp "${TXTP}")
+
+function(render OUTPUT)
+	execute_process(
+		COMMAND ${CLI} ${ARGN} -o ${WORK_DIR}/${OUTPUT} threads.txtp
+		WORKING_DIRECTORY ${WORK_DIR}
+		RESULT_VARIABLE RESULT
+		OUTPUT_QUIET)
+	if(NOT RESULT EQUAL 0)
+		string(REPLACE ";" " " ARGS_TEXT "${ARGN}")
+		message(FATAL_ERROR "vgmstream-cli ${ARGS_TEXT} failed: ${RESULT}")
+	endif()
+	file(SHA256 ${WORK_DIR}/${OUTPUT} HASH)
+	set(HASH ${HASH} PARENT_SCOPE)
+endfunction()
+
+render(base.wav)
+set(BASE_HASH ${HASH})
+
+foreach(ARGS "-j;4" "-n" "-j;4;-n")
+	# races don't happen every time
+	foreach(i RANGE 1 5)
+		render(test.wav ${ARGS})
+		if(NOT HASH STREQUAL BASE_HASH)
+			string(REPLACE ";" " " ARGS_TEXT "${ARGS}")
+			message(FATAL_ERROR "vgmstream-cli ${ARGS_TEXT} output differs from regular output")
+		endif()
+	endforeach()
+endforeach()
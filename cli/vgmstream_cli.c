@@ -67,7 +67,7 @@ static void print_usage(const char* progname, bool is_help) {
             "    -L: append a smpl chunk and create a looping wav\n"
             "    -w: allow .wav in original sample format rather than mixing to PCM16\n"
             "    -V: print version info and supported extensions as JSON\n"
-            "    -I: print requested file info as JSON\n"
+            "    -I: print requested file info and IO stats as JSON\n"
             "    -h: print all commands\n"
             , progname);
 
@@ -91,6 +91,10 @@ static void print_usage(const char* progname, bool is_help) {
             "    -B <samples> force a sample buffer size (for api testing)\n"
             "    -W <type>: force .wav output format (1=PCM16, 2=PCM24, 3=PCM32, 4=float)\n"
             "    -O: decode but don't write to file (for performance testing)\n"
+            "    -J: print formats tried during detection with time and reads as JSON (for performance testing)\n"
+            "    -j N: render layers of multi-layer files in parallel with N threads (-1 = all CPUs)\n"
+            "    -n: decode start of next segment in a background thread (for playback testing)\n"
+            "    -C <file>: load and save keys found for encrypted formats in <file> (for batch testing)\n"
     );
 
 }
@@ -117,7 +121,7 @@ getopt_start:
     // is found). BSD's getopt seem to behave like REQUIRE_ORDER and ignores '+'.
 
     // read config
-    while ((opt = getopt(argc, argv, "+o:l:f:d:ipPcmxeLEFrgb2:s:tTk:K:hOvD:S:B:VIwW:")) != -1) {
+    while ((opt = getopt(argc, argv, "+o:l:f:d:ipPcmxeLEFrgb2:s:tTk:K:hOvD:S:B:VIwW:Jj:nC:")) != -1) {
         switch (opt) {
             case 'o':
                 cfg->outfilename = optarg;
@@ -244,6 +248,18 @@ getopt_start:
             case 'I':
                 cfg->print_metajson = true;
                 break;
+            case 'J':
+                cfg->print_detection = true;
+                break;
+            case 'j':
+                cfg->layer_threads = atoi(optarg);
+                break;
+            case 'n':
+                cfg->segment_preroll = true;
+                break;
+            case 'C':
+                cfg->key_cache = optarg;
+                break;
 
             case '?': // unknown -* flag
             case ':': // bad argument on BSD?
@@ -344,6 +360,10 @@ static void load_vconfig(libvgmstream_config_t* vcfg, cli_config_t* cfg) {
     vcfg->really_force_loop = cfg->really_force_loop;
     vcfg->ignore_fade = cfg->ignore_fade;
 
+    vcfg->format_id = cfg->format_id;
+    vcfg->layer_threads = cfg->layer_threads;
+    vcfg->segment_preroll = cfg->segment_preroll;
+
     vcfg->auto_downmix_channels = cfg->downmix_channels;
     if (cfg->wav_force_output) {
         vcfg->force_sfmt = cfg->wav_force_output;
@@ -495,6 +515,36 @@ fail:
 }
 
 
+static bool profile_file(cli_config_t* cfg) {
+
+    libstreamfile_t* sf = libstreamfile_open_from_stdio(cfg->infilename);
+    if (!sf) {
+        fprintf(stderr, "file %s not found\n", cfg->infilename);
+        return false;
+    }
+
+    libvgmstream_config_t vcfg = {0};
+    load_vconfig(&vcfg, cfg);
+    vcfg.profile_detection = true;
+
+    libvgmstream_t* vgmstream = libvgmstream_init();
+    if (!vgmstream) goto fail;
+
+    libvgmstream_setup(vgmstream, &vcfg);
+
+    // print even if not detected, as unsupported files are often the slowest
+    int err = libvgmstream_open_stream(vgmstream, sf, cfg->subsong_current_index);
+    print_json_detection(vgmstream, cfg, err == 0);
+
+    libstreamfile_close(sf);
+    libvgmstream_free(vgmstream);
+    return err == 0;
+fail:
+    libstreamfile_close(sf);
+    libvgmstream_free(vgmstream);
+    return false;
+}
+
 static bool convert_file(cli_config_t* cfg) {
     libvgmstream_t* vgmstream = NULL;
     char outfilename_temp[CLI_PATH_LIMIT];
@@ -509,6 +559,9 @@ static bool convert_file(cli_config_t* cfg) {
     vgmstream = open_vgmstream(cfg);
     if (!vgmstream) goto fail;
 
+    /* other subsongs are the same format */
+    cfg->format_id = vgmstream->format->format_id;
+
     /* force load total subsongs if signalled */
     if (cfg->subsong_current_end == -1) {
         cfg->subsong_current_end = vgmstream->format->subsong_count;
@@ -580,9 +633,11 @@ static bool convert_file(cli_config_t* cfg) {
     }
 
 
-    /* prints */
+    /* prints (JSON goes after decoding so IO stats include it, unless decoding to stdout) */
+    bool print_json_late = cfg->print_metajson && !cfg->print_metaonly && !cfg->play_sdtout;
     if (cfg->print_metajson) {
-        print_json_info(vgmstream, cfg, VGMSTREAM_VERSION);
+        if (!print_json_late)
+            print_json_info(vgmstream, cfg, VGMSTREAM_VERSION);
     }
     else {
         print_info(vgmstream, cfg);
@@ -600,6 +655,10 @@ static bool convert_file(cli_config_t* cfg) {
     /* main decode */
     write_file(vgmstream, cfg);
 
+    if (print_json_late) {
+        print_json_info(vgmstream, cfg, VGMSTREAM_VERSION);
+    }
+
     /* try again with reset (for testing, simulates a seek to 0 after changing internal state)
      * (could simulate by seeking to last sample then to 0, too) */
     if (cfg->test_reset) {
@@ -672,10 +731,14 @@ int main(int argc, char** argv) {
 #endif
 
     // don't mix logs with JSON
-    if (cfg.print_metajson) {
+    if (cfg.print_metajson || cfg.print_detection) {
         libvgmstream_set_log(LIBVGMSTREAM_LOG_LEVEL_NONE, NULL);
     }
 
+    if (cfg.key_cache) {
+        libvgmstream_set_key_cache(true, cfg.key_cache);
+    }
+
     ok = false;
     for (int i = 1; i < argc; i++) {
         // ignore flags
@@ -685,10 +748,17 @@ int main(int argc, char** argv) {
 
         // current name, to avoid passing params all the time
         cfg.infilename = argv[i];
+        cfg.format_id = 0;
         if (cfg.outfilename_config)
             cfg.outfilename = NULL;
 
-        if (cfg.subsong_index > 0 && cfg.subsong_end != 0) {
+        if (cfg.print_detection) {
+            cfg.subsong_current_index = cfg.subsong_index;
+
+            res = profile_file(&cfg);
+            if (res) ok = true;
+        }
+        else if (cfg.subsong_index > 0 && cfg.subsong_end != 0) {
             res = convert_subsongs(&cfg);
             //if (!res) goto fail;
             if (res) ok = true;
@@ -702,6 +772,8 @@ int main(int argc, char** argv) {
         }
     }
 
+    libvgmstream_set_key_cache(false, NULL);
+
     /* ok if at least one succeeds, for programs that check result code */
     if (!ok)
         goto fail;
@@ -44,6 +44,7 @@ typedef struct {
     bool print_batchvar;
     bool print_title;
     bool print_metajson;
+    bool print_detection;
     const char* tag_filename;
 
     // debug stuff
@@ -54,11 +55,15 @@ typedef struct {
     int seek_samples2;
     int downmix_channels;
     int stereo_track;
+    int layer_threads;
+    bool segment_preroll;
+    const char* key_cache;
 
 
     // not quite config but eh
     int subsong_current_index;
     int subsong_current_end;
+    int format_id; // from first subsong, to speed up reopening the rest
 
     // to detect flags from filenames in argv
     bool flag_index[CLI_MAX_FLAGS];
@@ -73,6 +78,7 @@ void print_title(libvgmstream_t* vgmstream, cli_config_t* cfg);
 
 void print_json_version(const char* vgmstream_version);
 void print_json_info(libvgmstream_t* vgmstream, cli_config_t* cfg, const char* vgmstream_version);
+void print_json_detection(libvgmstream_t* vgmstream, cli_config_t* cfg, bool is_detected);
 
 
 #endif
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include "vgmstream_cli.h"
@@ -228,8 +229,31 @@ void print_json_version(const char* vgmstream_version) {
     printf("%s\n", buf);
 }
 
+static void print_json_io_stack(vjson_t* j, const libvgmstream_io_stack_t* stack) {
+    vjson_obj_open(j);
+        vjson_keyint(j, "files", stack->files);
+        vjson_keyint(j, "depth", stack->depth);
+
+        vjson_key(j, "layers");
+        vjson_arr_open(j);
+        for (int i = 0; i < stack->depth && i < LIBVGMSTREAM_IO_MAX_LAYERS; i++) {
+            const libvgmstream_io_layer_t* layer = &stack->layers[i];
+            vjson_obj_open(j);
+                vjson_keystr(j, "type", layer->type);
+                vjson_keyint(j, "reads", layer->reads);
+                vjson_keyint(j, "bytes", layer->bytes);
+                vjson_keyint(j, "hits", layer->hits);
+                vjson_keyint(j, "misses", layer->misses);
+                vjson_keyint(j, "seeks", layer->seeks);
+                vjson_keyint(j, "reopens", layer->reopens);
+            vjson_obj_close(j);
+        }
+        vjson_arr_close(j);
+    vjson_obj_close(j);
+}
+
 void print_json_info(libvgmstream_t* v, cli_config_t* cfg, const char* vgmstream_version) {
-    char buf[0x1000]; // probably fine with ~0x400
+    char buf[0x4000]; // probably fine with ~0x400 (+ ~0x100 per IO layer)
     vjson_t j = {0};
     vjson_init(&j, buf, sizeof(buf));
 
@@ -291,7 +315,70 @@ void print_json_info(libvgmstream_t* v, cli_config_t* cfg, const char* vgmstream
 
         vjson_keyint(&j, "playSamples", v->format->play_samples);
 
+        libvgmstream_io_stats_t io = {0};
+        vjson_key(&j, "ioStats");
+        if (libvgmstream_get_io_stats(v, &io) == 0) {
+            vjson_obj_open(&j);
+                vjson_key(&j, "open");
+                print_json_io_stack(&j, &io.open);
+                vjson_key(&j, "decode");
+                print_json_io_stack(&j, &io.decode);
+            vjson_obj_close(&j);
+        }
+        else {
+            vjson_null(&j);
+        }
+
+    vjson_obj_close(&j);
+
+    printf("%s\n", buf);
+}
+
+void print_json_detection(libvgmstream_t* v, cli_config_t* cfg, bool is_detected) {
+    const libvgmstream_detection_t* entries = NULL;
+    int count = libvgmstream_get_detection(v, &entries);
+    if (count < 0)
+        count = 0;
+
+    // may be big with unsupported files (~100 bytes per format tried)
+    int buf_size = 0x400 + count * 0x100;
+    char* buf = malloc(buf_size);
+    if (!buf) return;
+
+    vjson_t j = {0};
+    vjson_init(&j, buf, buf_size);
+
+    int64_t total_time = 0;
+    for (int i = 0; i < count; i++) {
+        total_time += entries[i].time_us;
+    }
+
+    vjson_obj_open(&j);
+        vjson_keystr(&j, "filename", cfg->infilename);
+        vjson_keybool(&j, "detected", is_detected);
+        vjson_keyintnull(&j, "formatId", is_detected ? v->format->format_id : 0);
+        vjson_keystr(&j, "metadataSource", is_detected ? v->format->meta_name : NULL);
+        vjson_keyint(&j, "formatsTried", count);
+        vjson_keyint(&j, "totalTimeUs", total_time);
+
+        vjson_key(&j, "formats");
+        vjson_arr_open(&j);
+        for (int i = 0; i < count; i++) {
+            const libvgmstream_detection_t* entry = &entries[i];
+            vjson_obj_open(&j);
+                vjson_keyint(&j, "formatId", entry->format_id);
+                vjson_keybool(&j, "accepted", entry->accepted);
+                vjson_keyint(&j, "timeUs", entry->time_us);
+                vjson_keyint(&j, "reads", entry->reads);
+                vjson_keyint(&j, "bytes", entry->bytes);
+                vjson_keyint(&j, "seeks", entry->seeks);
+                vjson_keyint(&j, "rebuffers", entry->rebuffers);
+            vjson_obj_close(&j);
+        }
+        vjson_arr_close(&j);
+
     vjson_obj_close(&j);
 
     printf("%s\n", buf);
+    free(buf);
 }
@@ -146,6 +146,11 @@ static void vjson_dbl(vjson_t* j, double num) {
 }
 #endif
 
+static void vjson_bool(vjson_t* j, bool val) {
+    vjson_comma_(j);
+    vjson_raw(j, val ? "true" : "false");
+}
+
 static void vjson_null(vjson_t* j){
     vjson_comma_(j);
     vjson_raw(j, "null");
@@ -170,6 +175,11 @@ static void vjson_keyint(vjson_t* j, const char* key, int64_t val) {
     vjson_int(j, val);
 }
 
+static void vjson_keybool(vjson_t* j, const char* key, bool val) {
+    vjson_key(j, key);
+    vjson_bool(j, val);
+}
+
 static void vjson_keyintnull(vjson_t* j, const char* key, int64_t val) {
     vjson_key(j, key);
     vjson_intnull(j, val);
@@ -24,6 +24,10 @@ macro(setup_target TARGET)
 	if(NOT WIN32 AND LINK)
 		# Include libm on non-Windows systems
 		target_link_libraries(${TARGET} PRIVATE m)
+		# Include pthreads for optional worker threads
+		if(NOT EMSCRIPTEN)
+			target_link_libraries(${TARGET} PRIVATE pthread)
+		endif()
 	endif()
 
 	target_compile_definitions(${TARGET} PRIVATE VGM_LOG_OUTPUT)
@@ -51,7 +51,9 @@ LIBVGMSTREAM_API void libvgmstream_free(libvgmstream_t* lib) {
     libvgmstream_priv_t* priv = lib->priv;
     if (priv) {
         close_vgmstream(priv->vgmstream);
+        thread_pool_free(priv->layer_pool);
         free(priv->buf.data);
+        free(priv->detection);
     }
 
     free(priv);
@@ -4,6 +4,8 @@
 #include "info.h"
 #include "play_config.h"
 #include "play_state.h"
+#include "../vgmstream_init.h"
+#include "../layout/layout.h"
 
 
 static void apply_config(libvgmstream_priv_t* priv) {
@@ -143,16 +145,120 @@ void api_apply_config(libvgmstream_priv_t* priv) {
     priv->setup_done = true;
 }
 
+static VGMSTREAM* load_vgmstream_profile(libvgmstream_priv_t* priv, STREAMFILE* sf, int format_id) {
+    VGMSTREAM* vgmstream = NULL;
+    int max_count = get_vgmstream_format_count();
+
+    detect_profile_t profile = {0};
+    profile.entries = calloc(max_count, sizeof(detect_profile_entry_t));
+    if (!profile.entries)
+        return NULL;
+
+    if (!priv->detection) {
+        priv->detection = calloc(max_count, sizeof(libvgmstream_detection_t));
+        if (!priv->detection) goto fail;
+    }
+
+    vgmstream = detect_vgmstream_format_profile(sf, format_id, &profile);
+
+    for (int i = 0; i < profile.count; i++) {
+        detect_profile_entry_t* entry = &profile.entries[i];
+        libvgmstream_detection_t* detection = &priv->detection[i];
+
+        detection->format_id = entry->format_id;
+        detection->accepted = entry->accepted;
+        detection->time_us = entry->time_us;
+        detection->reads = entry->io.reads;
+        detection->bytes = entry->io.bytes;
+        detection->seeks = entry->io.seeks;
+        detection->rebuffers = entry->io.misses;
+    }
+    priv->detection_count = profile.count;
+
+fail:
+    free(profile.entries);
+    return vgmstream;
+}
+
+static void load_io_stack(libvgmstream_io_stack_t* stack, sf_stats_t* layers, int depth, int files) {
+    memset(stack, 0, sizeof(libvgmstream_io_stack_t));
+    stack->files = files;
+    stack->depth = depth;
+
+    for (int i = 0; i < depth && i < LIBVGMSTREAM_IO_MAX_LAYERS; i++) {
+        libvgmstream_io_layer_t* layer = &stack->layers[i];
+
+        layer->type = layers[i].type;
+        layer->reads = layers[i].reads;
+        layer->bytes = layers[i].bytes;
+        layer->hits = layers[i].hits;
+        layer->misses = layers[i].misses;
+        layer->seeks = layers[i].seeks;
+        layer->reopens = layers[i].reopens;
+    }
+}
+
+// renders layers in parallel (pool is kept between streams as thread creation isn't free)
+static void setup_layer_pool(libvgmstream_priv_t* priv) {
+    int threads = priv->cfg.layer_threads;
+    if (threads == 0 || threads == 1)
+        return;
+
+    // number of CPUs: same pool as other parallel work (ex. HCA key searches)
+    if (threads < 0) {
+        thread_pool_free(priv->layer_pool);
+        priv->layer_pool = NULL;
+        setup_layout_layered_pool(priv->vgmstream, thread_pool_get_shared());
+        return;
+    }
+
+    if (priv->layer_pool && priv->layer_threads != threads) {
+        thread_pool_free(priv->layer_pool);
+        priv->layer_pool = NULL;
+    }
+
+    if (!priv->layer_pool) {
+        priv->layer_pool = thread_pool_init(threads);
+        priv->layer_threads = threads;
+    }
+
+    setup_layout_layered_pool(priv->vgmstream, priv->layer_pool);
+}
+
 static void load_vgmstream(libvgmstream_priv_t* priv, libstreamfile_t* libsf, int subsong_index) {
     STREAMFILE* sf_api = open_api_streamfile(libsf);
     if (!sf_api)
         return;
 
-    //TODO: handle format_id
+    if (priv->config_loaded && priv->cfg.read_ahead) {
+        sf_api = open_readahead_streamfile_f(sf_api, 0);
+        if (!sf_api)
+            return;
+    }
 
     sf_api->stream_index = subsong_index;
-    priv->vgmstream = init_vgmstream_from_STREAMFILE(sf_api);
+
+    // a known format skips most detection (falls back to regular detection if parser rejects the file)
+    int format_id = priv->config_loaded ? priv->cfg.format_id : 0;
+    if (priv->config_loaded && priv->cfg.profile_detection)
+        priv->vgmstream = load_vgmstream_profile(priv, sf_api, format_id);
+    else if (format_id > 0)
+        priv->vgmstream = detect_vgmstream_format_id(sf_api, format_id);
+    else
+        priv->vgmstream = init_vgmstream_from_STREAMFILE(sf_api);
+
+    // save before closing (channels use their own SFs)
+    sf_stats_t layers[LIBVGMSTREAM_IO_MAX_LAYERS];
+    int depth = get_streamfile_stats(sf_api, layers, LIBVGMSTREAM_IO_MAX_LAYERS);
+    load_io_stack(&priv->io_open, layers, depth, 1);
+
     close_streamfile(sf_api);
+
+    if (priv->vgmstream && priv->config_loaded) {
+        setup_layer_pool(priv);
+        if (priv->cfg.segment_preroll)
+            setup_layout_segmented_preroll(priv->vgmstream);
+    }
 }
 
 LIBVGMSTREAM_API int libvgmstream_open_stream(libvgmstream_t* lib, libstreamfile_t* libsf, int subsong_index) {
@@ -163,6 +269,8 @@ LIBVGMSTREAM_API int libvgmstream_open_stream(libvgmstream_t* lib, libstreamfile
     libvgmstream_close_stream(lib);
 
     libvgmstream_priv_t* priv = lib->priv;
+    priv->detection_count = 0;
+    memset(&priv->io_open, 0, sizeof(priv->io_open));
     if (subsong_index < 0)
         return LIBVGMSTREAM_ERROR_GENERIC;
 
@@ -197,3 +305,33 @@ LIBVGMSTREAM_API void libvgmstream_close_stream(libvgmstream_t* lib) {
 
     libvgmstream_priv_reset(priv, true);
 }
+
+
+LIBVGMSTREAM_API int libvgmstream_get_detection(libvgmstream_t* lib, const libvgmstream_detection_t** p_entries) {
+    if (!lib || !lib->priv || !p_entries)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+
+    libvgmstream_priv_t* priv = lib->priv;
+
+    *p_entries = priv->detection;
+    return priv->detection_count;
+}
+
+
+LIBVGMSTREAM_API int libvgmstream_get_io_stats(libvgmstream_t* lib, libvgmstream_io_stats_t* stats) {
+    if (!lib || !lib->priv || !stats)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+
+    libvgmstream_priv_t* priv = lib->priv;
+    if (!priv->vgmstream)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+
+    sf_stats_t layers[LIBVGMSTREAM_IO_MAX_LAYERS];
+    int files = 0;
+    int depth = get_vgmstream_io_stats(priv->vgmstream, layers, LIBVGMSTREAM_IO_MAX_LAYERS, &files);
+
+    stats->open = priv->io_open;
+    load_io_stack(&stats->decode, layers, depth, files);
+
+    return LIBVGMSTREAM_OK;
+}
@@ -1,5 +1,6 @@
 #include "api_internal.h"
 #include "info.h"
+#include "../util/key_cache.h"
 
 
 static int get_internal_log_level(libvgmstream_loglevel_t level) {
@@ -24,6 +25,15 @@ LIBVGMSTREAM_API void libvgmstream_set_log(libvgmstream_loglevel_t level, void (
 }
 
 
+LIBVGMSTREAM_API bool libvgmstream_set_key_cache(bool enable, const char* filename) {
+    if (!enable) {
+        key_cache_free();
+        return true;
+    }
+    return key_cache_init(filename);
+}
+
+
 LIBVGMSTREAM_API const char** libvgmstream_get_extensions(int* size) {
     if (!size)
         return NULL;
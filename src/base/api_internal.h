@@ -2,6 +2,7 @@
 #define _API_INTERNAL_H_
 #include "../libvgmstream.h"
 #include "../util/log.h"
+#include "../util/thread_pool.h"
 #include "../vgmstream.h"
 #include "plugins.h"
 #include "sbuf.h"
@@ -52,6 +53,17 @@ typedef struct {
     libvgmstream_priv_position_t pos;
     sbuf_t sbuf; // from last decode
 
+    // detection info (if enabled)
+    libvgmstream_detection_t* detection;
+    int detection_count;
+
+    // IO stats of the opened file (decode stats are taken from the current vgmstream)
+    libvgmstream_io_stack_t io_open;
+
+    // shared by all opened streams (if enabled)
+    thread_pool_t* layer_pool;
+    int layer_threads;
+
     bool config_loaded;
     bool setup_done;
     bool decode_done;
@@ -64,5 +76,7 @@ int api_get_sample_size(libvgmstream_sfmt_t sample_format);
 void api_apply_config(libvgmstream_priv_t* priv);
 
 STREAMFILE* open_api_streamfile(libstreamfile_t* libsf);
+/* internal SF of a libsf made by libstreamfile_open_from_*, or NULL if it's external */
+STREAMFILE* api_libsf_get_streamfile(libstreamfile_t* libsf);
 
 #endif
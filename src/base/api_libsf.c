@@ -89,6 +89,15 @@ fail:
 }
 
 
+STREAMFILE* api_libsf_get_streamfile(libstreamfile_t* libsf) {
+    if (!libsf || libsf->read != libsf_read)
+        return NULL;
+
+    libsf_priv_t* priv = libsf->user_data;
+    return priv->sf;
+}
+
+
 LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_stdio(const char* filename) {
     STREAMFILE* sf = open_stdio_streamfile(filename);
     if (!sf)
@@ -103,6 +112,20 @@ LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_stdio(const char* file
     return libsf;
 }
 
+LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_mmap(const char* filename) {
+    STREAMFILE* sf = open_mmap_streamfile(filename);
+    if (!sf)
+        return NULL;
+
+    libstreamfile_t* libsf = libstreamfile_from_streamfile(sf);
+    if (!libsf) {
+        close_streamfile(sf);
+        return NULL;
+    }
+
+    return libsf;
+}
+
 LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_file(void* file_, const char* filename) {
     FILE* file = file_;
     STREAMFILE* sf = open_stdio_streamfile_by_file(file, filename);
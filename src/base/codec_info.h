@@ -23,6 +23,12 @@ typedef struct {
     bool (*seekable)(VGMSTREAM* v); // if codec may seek to arbitrary samples using ->seek (defaults to slow seek otherwise)
                                     // ->seek is typically only been tested with loops, returning true here meant it can be used
 
+    // optional: save full decoder state (including pending samples in decode_state) when loop start is reached,
+    // and restore it on loop end instead of calling ->seek; for codecs that must decode from the beginning to loop.
+    // restore returns false if nothing was saved (reset should forget the saved state)
+    bool (*snapshot)(VGMSTREAM* v);
+    bool (*restore)(VGMSTREAM* v);
+
     // info for vgmstream
     //uint32_t flags; 
     // alloc size of effect's private data (don't set to manage manually in init/free)
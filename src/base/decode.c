@@ -139,9 +139,26 @@ void decode_seek(VGMSTREAM* vgmstream, int32_t sample) {
 }
 
 void decode_loop(VGMSTREAM* vgmstream) {
+    /* jump to the state saved in decode_loop_start, if possible */
+    if (vgmstream->codec_data && vgmstream->hit_loop) {
+        const codec_info_t* codec_info = codec_get_info(vgmstream);
+        if (codec_info && codec_info->restore && codec_info->restore(vgmstream))
+            return;
+    }
+
     decode_seek(vgmstream, vgmstream->loop_current_sample);
 }
 
+static void decode_loop_start(VGMSTREAM* vgmstream) {
+    if (!vgmstream->codec_data)
+        return;
+
+    const codec_info_t* codec_info = codec_get_info(vgmstream);
+    if (codec_info && codec_info->snapshot) {
+        codec_info->snapshot(vgmstream); /* on failure restore won't do anything */
+    }
+}
+
 void decode_reset(VGMSTREAM* vgmstream) {
     decode_state_reset(vgmstream);
 
@@ -657,6 +674,20 @@ bool decode_uses_internal_offset_updates(VGMSTREAM* vgmstream) {
     return vgmstream->coding_type == coding_MS_IMA || vgmstream->coding_type == coding_MS_IMA_mono;
 }
 
+/* Decoders that handle many consecutive frames per call (reading them in bulk), so layouts don't need
+ * to stop every frame. Frames must be contiguous per channel within a block, same as decoders already
+ * assume when finding the frame of first_sample (and layouts only move offsets between blocks). */
+static bool decode_can_do_multiple_frames(VGMSTREAM* vgmstream) {
+    switch (vgmstream->coding_type) {
+        case coding_NGC_DSP:
+        case coding_PSX:
+        case coding_PSX_badflags:
+            return true;
+        default:
+            return false;
+    }
+}
+
 
 // decode frames for decoders which decode frame by frame and have their own sample buffer
 static void decode_frames(sbuf_t* sdst, VGMSTREAM* vgmstream, int samples_to_do) {
@@ -1493,8 +1524,9 @@ int decode_get_samples_to_do(int samples_this_block, int samples_per_frame, VGMS
         }
     }
 
-    /* if it's a framed encoding don't do more than one frame */
-    if (samples_per_frame > 1 && (vgmstream->samples_into_block % samples_per_frame) + samples_to_do > samples_per_frame)
+    /* if it's a framed encoding don't do more than one frame (unless the decoder can) */
+    if (samples_per_frame > 1 && !decode_can_do_multiple_frames(vgmstream) &&
+            (vgmstream->samples_into_block % samples_per_frame) + samples_to_do > samples_per_frame)
         samples_to_do = samples_per_frame - (vgmstream->samples_into_block % samples_per_frame);
 
     return samples_to_do;
@@ -1575,6 +1607,8 @@ bool decode_do_loop(VGMSTREAM* vgmstream) {
         /* play state is applied over loops and stream decoding, so it's not saved on loops */
         //vgmstream->lstate = vgmstream->pstate;
 
+        decode_loop_start(vgmstream);
+
         vgmstream->hit_loop = true; /* info that loop is now ready to use */
 
         return false; // has not looped
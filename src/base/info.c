@@ -238,6 +238,11 @@ static uint32_t hash_sf(STREAMFILE* sf) {
 /* average bitrate helper to get STREAMFILE for a channel, since some codecs may use their own */
 static STREAMFILE* get_vgmstream_average_bitrate_channel_streamfile(VGMSTREAM* vgmstream, int channel) {
 
+    /* files are closed (not counted, like segments that aren't opened yet) */
+    if (vgmstream->suspended) {
+        return NULL;
+    }
+
     if (vgmstream->coding_type == coding_NWA) {
         return nwa_get_streamfile(vgmstream->codec_data);
     }
@@ -390,3 +395,103 @@ int get_vgmstream_average_bitrate(VGMSTREAM* vgmstream) {
 
     return get_vgmstream_file_bitrate_main(vgmstream, &br, NULL);
 }
+
+
+/*******************************************************************************/
+/* IO STATS                                                                    */
+/*******************************************************************************/
+
+#define IO_STATS_FILES_MAX 256
+
+typedef struct {
+    STREAMFILE* sfs[IO_STATS_FILES_MAX];   /* SFs already added (channels and wrappers may share them) */
+    int sfs_count;
+    int files;
+    int depth;
+
+    sf_stats_t* layers;
+    int max_layers;
+} io_stats_info_t;
+
+static bool is_io_stats_added(io_stats_info_t* info, STREAMFILE* sf) {
+    for (int i = 0; i < info->sfs_count; i++) {
+        if (info->sfs[i] == sf)
+            return true;
+    }
+
+    if (info->sfs_count < IO_STATS_FILES_MAX)
+        info->sfs[info->sfs_count++] = sf;
+    return false;
+}
+
+static void add_io_stats_layer(sf_stats_t* dst, const sf_stats_t* src, bool is_first) {
+    if (is_first)
+        dst->type = src->type;
+    else if (dst->type != src->type)
+        dst->type = "mixed"; /* files with different wrappers at this depth */
+
+    dst->reads += src->reads;
+    dst->bytes += src->bytes;
+    dst->hits += src->hits;
+    dst->misses += src->misses;
+    dst->seeks += src->seeks;
+    dst->reopens += src->reopens;
+}
+
+static void add_io_stats_streamfile(io_stats_info_t* info, STREAMFILE* sf) {
+    if (is_io_stats_added(info, sf))
+        return;
+    info->files++;
+
+    /* inner layers may be shared with other files (like one base SF + a clamp per channel) */
+    int depth = 0;
+    while (sf) {
+        if (depth < info->max_layers && (depth == 0 || !is_io_stats_added(info, sf)))
+            add_io_stats_layer(&info->layers[depth], &sf->stats, depth >= info->depth);
+        depth++;
+        sf = sf->stats_inner;
+    }
+
+    if (info->depth < depth)
+        info->depth = depth;
+}
+
+static void get_vgmstream_io_stats_main(VGMSTREAM* vgmstream, io_stats_info_t* info) {
+    if (vgmstream->layout_type == layout_segmented) {
+        segmented_layout_data* data = vgmstream->layout_data;
+        for (int i = 0; i < data->segment_count; i++) {
+            get_vgmstream_io_stats_main(data->segments[i], info);
+        }
+    }
+    else if (vgmstream->layout_type == layout_layered) {
+        layered_layout_data* data = vgmstream->layout_data;
+        for (int i = 0; i < data->layer_count; i++) {
+            get_vgmstream_io_stats_main(data->layers[i], info);
+        }
+    }
+    else {
+        for (int ch = 0; ch < vgmstream->channels; ch++) {
+            STREAMFILE* sf = vgmstream->ch[ch].streamfile;
+            if (!sf) continue;
+
+            add_io_stats_streamfile(info, sf);
+        }
+    }
+}
+
+int get_vgmstream_io_stats(VGMSTREAM* vgmstream, sf_stats_t* layers, int max_layers, int* p_files) {
+    io_stats_info_t info = {0};
+
+    if (!vgmstream || !layers)
+        return 0;
+
+    memset(layers, 0, max_layers * sizeof(sf_stats_t));
+    info.layers = layers;
+    info.max_layers = max_layers;
+
+    get_vgmstream_io_stats_main(vgmstream, &info);
+
+    if (p_files)
+        *p_files = info.files;
+    return info.depth;
+}
@@ -10,6 +10,10 @@ void describe_vgmstream(VGMSTREAM* vgmstream, char* dst, size_t dst_size);
 /* Return the average bitrate in bps of all unique files contained within this stream. */
 int get_vgmstream_average_bitrate(VGMSTREAM* vgmstream);
 
+/* Sums IO stats of each layer (see get_streamfile_stats) of unique files used by channels, into layers
+ * (up to max_layers). Returns max wrapper depth, and number of files summed in p_files (optional). */
+int get_vgmstream_io_stats(VGMSTREAM* vgmstream, sf_stats_t* layers, int max_layers, int* p_files);
+
 /* Get description info */
 void get_vgmstream_coding_description(VGMSTREAM* vgmstream, char* out, size_t out_size);
 void get_vgmstream_layout_description(VGMSTREAM* vgmstream, char* out, size_t out_size);
@@ -12,9 +12,9 @@
  * Mixer modifies decoded sample buffer before final output. This is implemented
  * with simplicity in mind rather than performance. Process:
  * - detect if mixing applies at current moment or exit (mini performance optimization)
- * - copy/upgrade buf to float mixbuf if needed
+ * - copy/upgrade buf to float mixbuf if needed (planar, so ops work per channel and move channels by swapping planes)
  * - do mixing ops
- * - copy/downgrade mixbuf to original buf if needed
+ * - copy/downgrade mixbuf to original buf if needed (interleaving again)
  * 
  * Mixing ops are added by a meta (ex. TXTP) or plugins through API. Non-sensical config
  * is ignored on add (to avoid rechecking every time).
@@ -46,6 +46,7 @@ void mixer_free(mixer_t* mixer) {
     if (!mixer) return;
 
     free(mixer->mixbuf);
+    free(mixer->mixplanes);
     free(mixer->mixbuf_dst.buf);
     free(mixer);
 }
@@ -105,14 +106,27 @@ static bool setup_mixbuf(mixer_t* mixer, sbuf_t* sbuf) {
         mixer->mixbuf_size = max_size;
     }
 
+    if (mixer->mixing_channels > mixer->mixplanes_count) {
+        void** mixplanes_re = realloc(mixer->mixplanes, mixer->mixing_channels * sizeof(void*));
+        if (!mixplanes_re) return false;
+
+        mixer->mixplanes = mixplanes_re;
+        mixer->mixplanes_count = mixer->mixing_channels;
+    }
+
+    // all planes (including unused channels for upmixing), reset as ops may have moved them
+    for (int ch = 0; ch < mixer->mixing_channels; ch++) {
+        mixer->mixplanes[ch] = mixer->mixbuf + ch * sbuf->samples;
+    }
+
     sbuf_t* smix = &mixer->smix;
 
     // mixbuf (float) can be interpreted as F16, for 1:1 mapping with PCM16 (and possibly less rounding errors with mixops)
     // for others, regular float seems ok and 1:1 as well
     if (sbuf->fmt == SFMT_S16 || sbuf->fmt == SFMT_F16)
-        sbuf_init(smix, SFMT_F16, mixer->mixbuf, sbuf->filled, sbuf->channels);
+        sbuf_init_planar(smix, SFMT_F16, mixer->mixplanes, sbuf->filled, sbuf->channels);
     else
-        sbuf_init(smix, SFMT_FLT, mixer->mixbuf, sbuf->filled, sbuf->channels);
+        sbuf_init_planar(smix, SFMT_FLT, mixer->mixplanes, sbuf->filled, sbuf->channels);
 
     // remix to temp buf (somehow using float buf rather than int32 is faster?)
     sbuf_copy_segments(smix, sbuf, sbuf->filled);
@@ -1,57 +1,63 @@
 #include "mixer_priv.h"
+#include <string.h>
 
 
 // TO-DO: some ops can be done with original PCM sbuf to avoid copying to the float sbuf
 // when there are no actual float ops (ex. 'swap', if no ' volume' )
 // Performance gain is probably fairly small, though.
 
+// mixbuf is planar: ops work over each channel's buf, and moving channels around just moves planes
+
 void mixer_op_swap(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* dst = smix->buf;
-
-    for (int s = 0; s < smix->filled; s++) {
-        float temp_f = dst[op->ch_dst];
-        dst[op->ch_dst] = dst[op->ch_src];
-        dst[op->ch_src] = temp_f;
 
-        dst += smix->channels;
-    }
+    void* temp_p = smix->planes[op->ch_dst];
+    smix->planes[op->ch_dst] = smix->planes[op->ch_src];
+    smix->planes[op->ch_src] = temp_p;
 }
 
 void mixer_op_add(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* dst = smix->buf;
+    float* dst = smix->planes[op->ch_dst];
+    float* src = smix->planes[op->ch_src];
 
     /* could optimize when vol == 1 to avoid one multiplication but whatevs (not common) */
     for (int s = 0; s < smix->filled; s++) {
-        dst[op->ch_dst] = dst[op->ch_dst] + dst[op->ch_src] * op->vol;
+        dst[s] = dst[s] + src[s] * op->vol;
+    }
+}
 
-        dst += smix->channels;
+static void mix_volume(float* dst, int samples, float vol) {
+    for (int s = 0; s < samples; s++) {
+        dst[s] = dst[s] * vol;
     }
 }
 
 void mixer_op_volume(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* dst = smix->buf;
-    
+
     if (op->ch_dst < 0) {
         /* "all channels", most common case */
-        for (int s = 0; s < smix->filled * smix->channels; s++) {
-            dst[s] = dst[s] * op->vol;
+        for (int ch = 0; ch < smix->channels; ch++) {
+            mix_volume(smix->planes[ch], smix->filled, op->vol);
         }
     }
     else {
-        for (int s = 0; s < smix->filled; s++) {
-            dst[op->ch_dst] = dst[op->ch_dst] * op->vol;
+        mix_volume(smix->planes[op->ch_dst], smix->filled, op->vol);
+    }
+}
 
-            dst += smix->channels;
-        }
+static void mix_limit(float* dst, int samples, float temp_max, float temp_min) {
+    for (int s = 0; s < samples; s++) {
+        if (dst[s] > temp_max)
+            dst[s] = temp_max;
+        else if (dst[s] < temp_min)
+            dst[s] = temp_min;
     }
 }
 
 void mixer_op_limit(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* dst = smix->buf;
 
     const float limiter_max = smix->fmt == SFMT_FLT ? 1.0f : 32767.0f;
     const float limiter_min = smix->fmt == SFMT_FLT ? -1.0f : -32768.0f;
@@ -60,92 +66,45 @@ void mixer_op_limit(mixer_t* mixer, mix_op_t* op) {
     const float temp_min = limiter_min * op->vol;
 
     /* could optimize when vol == 1 to avoid one multiplication but whatevs (not common) */
-    for (int s = 0; s < smix->filled; s++) {
-
-        if (op->ch_dst < 0) {
-            for (int ch = 0; ch < smix->channels; ch++) {
-                if (dst[ch] > temp_max)
-                    dst[ch] = temp_max;
-                else if (dst[ch] < temp_min)
-                    dst[ch] = temp_min;
-            }
-        }
-        else {
-            if (dst[op->ch_dst] > temp_max)
-                dst[op->ch_dst] = temp_max;
-            else if (dst[op->ch_dst] < temp_min)
-                dst[op->ch_dst] = temp_min;
+    if (op->ch_dst < 0) {
+        for (int ch = 0; ch < smix->channels; ch++) {
+            mix_limit(smix->planes[ch], smix->filled, temp_max, temp_min);
         }
-
-        dst += smix->channels;
+    }
+    else {
+        mix_limit(smix->planes[op->ch_dst], smix->filled, temp_max, temp_min);
     }
 }
 
 void mixer_op_upmix(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* sbuf = smix->buf;
+    void** planes = smix->planes;
 
-    int max_channels = smix->channels;
-    smix->channels += 1;
+    // use first unused plane (mixbuf has planes for max mixing channels), inserted as silent
+    void* new_plane = planes[smix->channels];
+    memset(new_plane, 0, smix->filled * sizeof(float));
 
-    float* dst = sbuf + smix->filled * smix->channels;
-    float* src = sbuf + smix->filled * max_channels;
+    // 'push' channels forward
+    memmove(&planes[op->ch_dst + 1], &planes[op->ch_dst], (smix->channels - op->ch_dst) * sizeof(void*));
+    planes[op->ch_dst] = new_plane;
 
-    /* copy 'backwards' as otherwise would overwrite samples before moving them forward */
-    for (int s = 0; s < smix->filled; s++) {
-        dst -= smix->channels;
-        src -= max_channels;
-
-        int sbuf_ch = max_channels - 1;
-        for (int ch = smix->channels - 1; ch >= 0; ch--) {
-            if (ch == op->ch_dst) {
-                dst[ch] = 0; // inserted as silent
-            }
-            else {
-                dst[ch] = src[sbuf_ch]; // 'pull' channels backward
-                sbuf_ch--;
-            }
-        }
-    }
+    smix->channels += 1;
 }
 
 void mixer_op_downmix(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* src = smix->buf;
-    float* dst = smix->buf;
-
-    int max_channels = smix->channels;
-    smix->channels -= 1;
+    void** planes = smix->planes;
 
-    for (int s = 0; s < smix->filled; s++) {
+    // 'pull' dropped channels back, and keep removed plane as unused
+    void* old_plane = planes[op->ch_dst];
+    memmove(&planes[op->ch_dst], &planes[op->ch_dst + 1], (smix->channels - 1 - op->ch_dst) * sizeof(void*));
+    planes[smix->channels - 1] = old_plane;
 
-        for (int ch = 0; ch < op->ch_dst; ch++) {
-            dst[ch] = src[ch]; // copy untouched channels
-        }
-
-        for (int ch = op->ch_dst; ch < max_channels - 1; ch++) {
-            dst[ch] = src[ch + 1]; // 'pull' dropped channels back
-        }
-
-        dst += smix->channels;
-        src += max_channels;
-    }
+    smix->channels -= 1;
 }
 
 void mixer_op_killmix(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
-    float* src = smix->buf;
-    float* dst = smix->buf;
 
-    int max_channels = smix->channels;
-    smix->channels = op->ch_dst; // clamp channels
-
-    for (int s = 0; s < smix->filled; s++) {
-        for (int ch = 0; ch < smix->channels; ch++) {
-            dst[ch] = src[ch];
-        }
-
-        dst += smix->channels;
-        src += max_channels;
-    }
+    smix->channels = op->ch_dst; // clamp channels (rest of planes are just unused)
 }
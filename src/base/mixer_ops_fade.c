@@ -116,7 +116,6 @@ static bool get_fade_gain(mix_op_t* op, float* out_cur_vol, int32_t current_subp
 
 void mixer_op_fade(mixer_t* mixer, mix_op_t* mix) {
     sbuf_t* smix = &mixer->smix;
-    float* dst = smix->buf;
     float new_gain = 0.0f;
 
     int channels = smix->channels;
@@ -126,21 +125,21 @@ void mixer_op_fade(mixer_t* mixer, mix_op_t* mix) {
     for (int s = 0; s < smix->filled; s++) {
         bool fade_applies = get_fade_gain(mix, &new_gain, current_subpos);
         if (!fade_applies) { //TODO optimize?
-            dst += channels;
             current_subpos++;
             continue;
         }
 
         if (mix->ch_dst < 0) {
             for (int ch = 0; ch < channels; ch++) {
-                dst[ch] = dst[ch] * new_gain;
+                float* dst = smix->planes[ch];
+                dst[s] = dst[s] * new_gain;
             }
         }
         else {
-            dst[mix->ch_dst] = dst[mix->ch_dst] * new_gain;
+            float* dst = smix->planes[mix->ch_dst];
+            dst[s] = dst[s] * new_gain;
         }
 
-        dst += channels;
         current_subpos++;
     }
 }
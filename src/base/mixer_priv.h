@@ -54,6 +54,8 @@ struct mixer_t {
 
     float* mixbuf;          // internal mixing buffer
     int mixbuf_size;
+    void** mixplanes;       // mixbuf split per channel (mixing is planar), ops may reorder them
+    int mixplanes_count;
 
     sbuf_t smix;            // temp sbuf
     int32_t current_subpos; // state: current sample pos in the stream
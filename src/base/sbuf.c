@@ -2,6 +2,7 @@
 #include <string.h>
 #include "../util.h"
 #include "sbuf.h"
+#include "sbuf_simd.h"
 #include "../util/log.h"
 
 // float-to-int modes
@@ -10,8 +11,13 @@
 
 #if defined(PCM16_ROUNDING_HALF) || defined(PCM16_ROUNDING_LRINT)
 #include <math.h>
+#else
+// vectorized conversions (sbuf_simd.c) only truncate like the default float_to_int
+#define SBUF_USE_SIMD
 #endif
 
+#define SBUF_SIMD_CHUNK 1024 // samples converted at once for non-contiguous copies (temp buf on stack)
+
 /* when casting float to int, value is simply truncated:
  * - (int)1.7 = 1, (int)-1.7 = -1
  * alts for more accurate rounding could be:
@@ -151,6 +157,14 @@ void sbuf_init_default(sbuf_t* sbuf, int samples) {
     sbuf->samples = samples;
 }
 
+void sbuf_init_planar(sbuf_t* sbuf, sfmt_t format, void** planes, int samples, int channels) {
+    memset(sbuf, 0, sizeof(sbuf_t));
+    sbuf->planes = planes;
+    sbuf->samples = samples;
+    sbuf->channels = channels;
+    sbuf->fmt = format;
+}
+
 
 int sfmt_get_sample_size(sfmt_t fmt) {
     switch(fmt) {
@@ -170,6 +184,11 @@ int sfmt_get_sample_size(sfmt_t fmt) {
 }
 
 void* sbuf_get_filled_buf(sbuf_t* sbuf) {
+    if (sbuf->planes) {
+        VGM_LOG_ONCE("SBUF: filled buf of planar sbuf requested\n");
+        return NULL;
+    }
+
     int sample_size = sfmt_get_sample_size(sbuf->fmt);
 
     uint8_t* buf = sbuf->buf;
@@ -186,10 +205,18 @@ void sbuf_consume(sbuf_t* sbuf, int samples) {
     if (samples > sbuf->samples || samples > sbuf->filled) //???
         return;
 
-    uint8_t* buf = sbuf->buf;
-    buf += samples * sbuf->channels * sample_size;
+    if (sbuf->planes) {
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            uint8_t* plane = sbuf->planes[ch];
+            sbuf->planes[ch] = plane + samples * sample_size;
+        }
+    }
+    else {
+        uint8_t* buf = sbuf->buf;
+        buf += samples * sbuf->channels * sample_size;
+        sbuf->buf = buf;
+    }
 
-    sbuf->buf = buf;
     sbuf->filled -= samples;
     sbuf->samples -= samples;
 }
@@ -207,6 +234,14 @@ int sbuf_get_copy_max(sbuf_t* sdst, sbuf_t* ssrc) {
 void sbuf_silence_part(sbuf_t* sbuf, int from, int count) {
     int sample_size = sfmt_get_sample_size(sbuf->fmt);
 
+    if (sbuf->planes) {
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            uint8_t* plane = sbuf->planes[ch];
+            memset(plane + from * sample_size, 0, count * sample_size);
+        }
+        return;
+    }
+
     uint8_t* buf = sbuf->buf;
     buf += from * sbuf->channels * sample_size;
     memset(buf, 0, count * sbuf->channels * sample_size);
@@ -291,6 +326,8 @@ static sbuf_copy_t copy_matrix[SFMT_MAX][SFMT_MAX] = {
 };
 
 
+static void sbuf_copy_planar(sbuf_t* sdst, sbuf_t* ssrc, int samples);
+
 // copy N samples from ssrc into dst (should be clamped externally)
 //TODO: may want to handle sdst->flled + samples externally?
 void sbuf_copy_segments(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
@@ -303,6 +340,12 @@ void sbuf_copy_segments(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
         return;
     }
 
+    if (ssrc->planes || sdst->planes) {
+        sbuf_copy_planar(sdst, ssrc, samples);
+        sdst->filled += samples;
+        return;
+    }
+
     if (ssrc->channels != sdst->channels) {
         // 0'd other channels first (uncommon so probably fine albeit slower-ish)
         sbuf_silence_part(sdst, sdst->filled, samples);
@@ -330,6 +373,14 @@ void sbuf_copy_segments(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
     int dst_pos = sdst->filled * sdst->channels;
     int src_max = samples * ssrc->channels;
 
+#ifdef SBUF_USE_SIMD
+    uint8_t* dst = sdst->buf;
+    if (sbuf_simd_convert(ssrc->buf, ssrc->fmt, dst + dst_pos * sfmt_get_sample_size(sdst->fmt), sdst->fmt, src_max)) {
+        sdst->filled += samples;
+        return;
+    }
+#endif
+
     sbuf_copy_src_dst(ssrc->buf, sdst->buf, src_pos, dst_pos, src_max);
     sdst->filled += samples;
 }
@@ -424,12 +475,101 @@ static sbuf_layer_t layer_matrix[SFMT_MAX][SFMT_MAX] = {
     { NULL, NULL, NULL, NULL, NULL }, //O32
 };
 
+#ifdef SBUF_USE_SIMD
+// vectorized conversion of src frames in chunks, then scatter to dst channels (~3x faster than per-sample layer functions)
+#define DEFINE_SBUF_LAYER_SCATTER(suffix, type) \
+    static void sbuf_scatter_##suffix(void* vsrc, void* vdst, int dst_pos, int frames, int src_channels, int dst_channels) { \
+        type* src = vsrc; \
+        type* dst = vdst; \
+        if (src_channels == 1) { \
+            for (int s = 0; s < frames; s++) { \
+                dst[dst_pos] = src[s]; \
+                dst_pos += dst_channels; \
+            } \
+        } \
+        else if (src_channels == 2) { \
+            for (int s = 0; s < frames; s++) { \
+                dst[dst_pos + 0] = src[s * 2 + 0]; \
+                dst[dst_pos + 1] = src[s * 2 + 1]; \
+                dst_pos += dst_channels; \
+            } \
+        } \
+        else { \
+            int dst_ch_step = (dst_channels - src_channels); \
+            for (int s = 0; s < frames; s++) { \
+                for (int src_ch = 0; src_ch < src_channels; src_ch++) { \
+                    dst[dst_pos++] = *src++; \
+                } \
+                dst_pos += dst_ch_step; \
+            } \
+        } \
+    }
+
+DEFINE_SBUF_LAYER_SCATTER(i16, int16_t);
+DEFINE_SBUF_LAYER_SCATTER(i32, int32_t);
+
+static bool sbuf_layer_simd(const uint8_t* src, sfmt_t src_fmt, int src_channels, void* dst, sfmt_t dst_fmt, int dst_pos, int dst_channels, int src_copy, int dst_max) {
+    // same formats are just copied below
+    if (src_fmt == dst_fmt || src_channels > SBUF_SIMD_CHUNK || !sbuf_simd_can_convert(src_fmt, dst_fmt))
+        return false;
+
+    int src_size = sfmt_get_sample_size(src_fmt);
+    int dst_size = sfmt_get_sample_size(dst_fmt);
+    int chunk_frames = SBUF_SIMD_CHUNK / src_channels;
+    int32_t tmp[SBUF_SIMD_CHUNK]; // fits both s16 and 32-bit samples
+
+    int done = 0;
+    while (done < dst_max) {
+        int frames = dst_max - done;
+        if (frames > chunk_frames)
+            frames = chunk_frames;
+
+        if (done < src_copy) {
+            if (frames > src_copy - done)
+                frames = src_copy - done;
+            sbuf_simd_convert(src + done * src_channels * src_size, src_fmt, tmp, dst_fmt, frames * src_channels);
+        }
+        else if (done == src_copy) {
+            // 0-fill rest past src samples
+            memset(tmp, 0, sizeof(tmp));
+        }
+
+        if (dst_size == 0x02)
+            sbuf_scatter_i16(tmp, dst, dst_pos, frames, src_channels, dst_channels);
+        else
+            sbuf_scatter_i32(tmp, dst, dst_pos, frames, src_channels, dst_channels);
+
+        dst_pos += frames * dst_channels;
+        done += frames;
+    }
+
+    return true;
+}
+#endif
+
+// copies src frames (src_channels each) into dst_channels frames starting from dst_pos
+static void sbuf_layer(const void* src, sfmt_t src_fmt, int src_channels, void* dst, sfmt_t dst_fmt, int dst_pos, int dst_channels, int src_copy, int dst_max) {
+    sbuf_layer_t sbuf_layer_src_dst = layer_matrix[src_fmt][dst_fmt];
+    if (!sbuf_layer_src_dst) {
+        VGM_LOG_ONCE("SBUF: undefined layer function sfmt %i to %i\n", src_fmt, dst_fmt);
+        return;
+    }
+
+#ifdef SBUF_USE_SIMD
+    if (sbuf_layer_simd(src, src_fmt, src_channels, dst, dst_fmt, dst_pos, dst_channels, src_copy, dst_max))
+        return;
+#endif
+
+    sbuf_layer_src_dst((void*)src, dst, 0, dst_pos, src_copy, dst_max, src_channels, dst_channels);
+}
+
+static void sbuf_copy_channel(sbuf_t* sdst, int dst_ch, sbuf_t* ssrc, int src_ch, int src_copy, int dst_max);
+
 // copy interleaving: dst ch1 ch2 ch3 ch4 w/ src ch1 ch2 ch1 ch2 = only fill dst ch1 ch2
 // dst_channels == src_channels isn't likely so ignore that optimization (dst must be >= than src).
 // dst_ch_start indicates it should write to dst's chN,chN+1,etc
 // sometimes one layer has less samples than others and need to 0-fill rest up to dst_max
 void sbuf_copy_layers(sbuf_t* sdst, sbuf_t* ssrc, int dst_ch_start, int dst_max) {
-    int src_pos = 0;
     int dst_pos = sdst->filled * sdst->channels + dst_ch_start;
 
     int src_copy = dst_max;
@@ -441,13 +581,99 @@ void sbuf_copy_layers(sbuf_t* sdst, sbuf_t* ssrc, int dst_ch_start, int dst_max)
         return;
     }
 
-    sbuf_layer_t sbuf_layer_src_dst = layer_matrix[ssrc->fmt][sdst->fmt];
-    if (!sbuf_layer_src_dst) {
-        VGM_LOG_ONCE("SBUF: undefined layer function sfmt %i to %i\n", ssrc->fmt, sdst->fmt);
+    if (ssrc->planes || sdst->planes) {
+        for (int ch = 0; ch < ssrc->channels; ch++) {
+            sbuf_copy_channel(sdst, dst_ch_start + ch, ssrc, ch, src_copy, dst_max);
+        }
         return;
     }
 
-    sbuf_layer_src_dst(ssrc->buf, sdst->buf, src_pos, dst_pos, src_copy, dst_max, ssrc->channels, sdst->channels);
+    sbuf_layer(ssrc->buf, ssrc->fmt, ssrc->channels, sdst->buf, sdst->fmt, dst_pos, sdst->channels, src_copy, dst_max);
+}
+
+
+// returns channel's first sample at pos and step to next sample (1 if planar)
+static uint8_t* sbuf_get_channel(sbuf_t* sbuf, int ch, int pos, int* p_step) {
+    int sample_size = sfmt_get_sample_size(sbuf->fmt);
+
+    if (sbuf->planes) {
+        uint8_t* plane = sbuf->planes[ch];
+        *p_step = 1;
+        return plane + pos * sample_size;
+    }
+
+    uint8_t* buf = sbuf->buf;
+    *p_step = sbuf->channels;
+    return buf + (pos * sbuf->channels + ch) * sample_size;
+}
+
+#define DEFINE_SBUF_GATHER(suffix, type) \
+    static void sbuf_gather_##suffix(void* vsrc, void* vdst, int src_step, int samples) { \
+        type* src = vsrc; \
+        type* dst = vdst; \
+        for (int s = 0; s < samples; s++) { \
+            dst[s] = src[s * src_step]; \
+        } \
+    }
+
+DEFINE_SBUF_GATHER(i16, int16_t);
+DEFINE_SBUF_GATHER(i32, int32_t);
+
+// copies one channel from ssrc's start to sdst's filled position (either may be planar), 0-filling up to dst_max
+static void sbuf_copy_channel(sbuf_t* sdst, int dst_ch, sbuf_t* ssrc, int src_ch, int src_copy, int dst_max) {
+    int src_step, dst_step;
+    uint8_t* src = sbuf_get_channel(ssrc, src_ch, 0, &src_step);
+    uint8_t* dst = sbuf_get_channel(sdst, dst_ch, sdst->filled, &dst_step);
+    int src_size = sfmt_get_sample_size(ssrc->fmt);
+    int dst_size = sfmt_get_sample_size(sdst->fmt);
+
+    // planar to planar
+    if (src_step == 1 && dst_step == 1 && ssrc->fmt == sdst->fmt) {
+        memcpy(dst, src, src_copy * dst_size);
+        memset(dst + src_copy * dst_size, 0, (dst_max - src_copy) * dst_size);
+        return;
+    }
+
+    // planar to any: same as a mono layer
+    if (src_step == 1) {
+        sbuf_layer(src, ssrc->fmt, 1, dst, sdst->fmt, 0, dst_step, src_copy, dst_max);
+        return;
+    }
+
+    // interleaved to planar: gather channel samples first
+    int32_t tmp[SBUF_SIMD_CHUNK]; // fits both s16 and 32-bit samples
+    int done = 0;
+    while (done < src_copy) {
+        int samples = src_copy - done;
+        if (samples > SBUF_SIMD_CHUNK)
+            samples = SBUF_SIMD_CHUNK;
+
+        if (src_size == 0x02)
+            sbuf_gather_i16(src + done * src_step * src_size, tmp, src_step, samples);
+        else
+            sbuf_gather_i32(src + done * src_step * src_size, tmp, src_step, samples);
+        sbuf_layer(tmp, ssrc->fmt, 1, dst + done * dst_step * dst_size, sdst->fmt, 0, dst_step, samples, samples);
+
+        done += samples;
+    }
+
+    if (src_copy < dst_max) {
+        sbuf_layer(tmp, ssrc->fmt, 1, dst + src_copy * dst_step * dst_size, sdst->fmt, 0, dst_step, 0, dst_max - src_copy);
+    }
+}
+
+// copies all channels when either sbuf is planar (extra dst channels are 0'd)
+static void sbuf_copy_planar(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
+    int channels = ssrc->channels;
+    if (channels > sdst->channels)
+        channels = sdst->channels;
+
+    if (ssrc->channels != sdst->channels)
+        sbuf_silence_part(sdst, sdst->filled, samples);
+
+    for (int ch = 0; ch < channels; ch++) {
+        sbuf_copy_channel(sdst, ch, ssrc, ch, samples, samples);
+    }
 }
 
 
@@ -492,9 +718,49 @@ DEFINE_SBUF_FADE(i32, int32_t, CONV_FADE_PCM);
 DEFINE_SBUF_FADE(flt, float, CONV_FADE_FLT);
 DEFINE_SBUF_FD24(o24, uint8_t, CONV_FADE_PCM);
 
-void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
-    //TODO: use interpolated fadedness to improve performance?
-    //TODO: use float fadedness?
+#ifdef SBUF_USE_SIMD
+// precalcs a chunk of per-sample fadedness (same value for all channels in a frame) and applies it vectorized
+static bool sbuf_fade_simd(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
+    int channels = sbuf->channels;
+    if (sbuf->fmt == SFMT_O24 || channels > SBUF_SIMD_CHUNK)
+        return false;
+
+    float gains[SBUF_SIMD_CHUNK];
+    int chunk_frames = SBUF_SIMD_CHUNK / channels;
+    int sample_size = sfmt_get_sample_size(sbuf->fmt);
+    uint8_t* buf = sbuf->buf;
+    buf += start * channels * sample_size;
+
+    while (to_do > 0) {
+        int frames = to_do;
+        if (frames > chunk_frames)
+            frames = chunk_frames;
+
+        int g = 0;
+        for (int s = 0; s < frames; s++) {
+            float fadedness = (float)(fade_duration - fade_pos) / fade_duration;
+            for (int ch = 0; ch < channels; ch++) {
+                gains[g++] = fadedness;
+            }
+            fade_pos++;
+        }
+
+        if (!sbuf_simd_gain(buf, sbuf->fmt, gains, g))
+            return false; // only possible on first chunk (no SIMD)
+
+        buf += g * sample_size;
+        to_do -= frames;
+    }
+
+    return true;
+}
+#endif
+
+static void sbuf_fade(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
+#ifdef SBUF_USE_SIMD
+    if (sbuf_fade_simd(sbuf, start, to_do, fade_pos, fade_duration))
+        return;
+#endif
 
     switch(sbuf->fmt) {
         case SFMT_S16:
@@ -515,6 +781,24 @@ void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_dur
             VGM_LOG("SBUF: missing fade for fmt=%i\n", sbuf->fmt);
             break;
     }
+}
+
+void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
+    //TODO: use interpolated fadedness to improve performance?
+    //TODO: use float fadedness?
+
+    if (sbuf->planes) {
+        // fade each plane as a mono buf
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            sbuf_t plane;
+            sbuf_init(&plane, sbuf->fmt, sbuf->planes[ch], sbuf->samples, 1);
+            plane.filled = sbuf->filled;
+            sbuf_fade(&plane, start, to_do, fade_pos, fade_duration);
+        }
+    }
+    else {
+        sbuf_fade(sbuf, start, to_do, fade_pos, fade_duration);
+    }
 
     /* next samples after fade end would be pad end/silence */
     int count = sbuf->filled - (start + to_do);
@@ -527,6 +811,18 @@ void sbuf_interleave(sbuf_t* sbuf, float** ibuf) {
         return;
     }
 
+    if (sbuf->planes) {
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            memcpy(sbuf->planes[ch], ibuf[ch], sbuf->filled * sizeof(float));
+        }
+        return;
+    }
+
+#ifdef SBUF_USE_SIMD
+    if (sbuf->channels == 2 && sbuf_simd_interleave2(sbuf->buf, ibuf[0], ibuf[1], sbuf->filled))
+        return;
+#endif
+
     // copy multidimensional buf (pcm[0]=[ch0,ch0,...], pcm[1]=[ch1,ch1,...])
     // to interleaved buf (buf[0]=ch0, sbuf[1]=ch1, sbuf[2]=ch0, sbuf[3]=ch1, ...)
     for (int ch = 0; ch < sbuf->channels; ch++) {
@@ -569,6 +865,20 @@ void sbuf_interleave_vorbis(sbuf_t* sbuf, float** src) {
         return;
     int channels = sbuf->channels;
 
+    if (sbuf->planes) {
+        for (int ch = 0; ch < channels; ch++) {
+            int ch_map = (channels > 8) ? ch : xiph_channel_map[channels - 1][ch];
+            memcpy(sbuf->planes[ch], src[ch_map], sbuf->filled * sizeof(float));
+        }
+        return;
+    }
+
+#ifdef SBUF_USE_SIMD
+    // 1ch/2ch have standard order
+    if (channels == 2 && sbuf_simd_interleave2(sbuf->buf, src[0], src[1], sbuf->filled))
+        return;
+#endif
+
     /* convert float PCM (multichannel float array, with pcm[0]=ch0, pcm[1]=ch1, pcm[2]=ch0, etc)
      * to 16 bit signed PCM ints (host order) and interleave + fix clipping */
     for (int ch = 0; ch < channels; ch++) {
@@ -591,3 +901,19 @@ void sbuf_interleave_vorbis(sbuf_t* sbuf, float** src) {
         }
     }
 }
+
+void sbuf_set_planes(sbuf_t* sbuf, float** ibuf) {
+    for (int ch = 0; ch < sbuf->channels; ch++) {
+        sbuf->planes[ch] = ibuf[ch];
+    }
+}
+
+// same as sbuf_interleave_vorbis but just remapping planes
+void sbuf_set_planes_vorbis(sbuf_t* sbuf, float** ibuf) {
+    int channels = sbuf->channels;
+
+    for (int ch = 0; ch < channels; ch++) {
+        int ch_map = (channels > 8) ? ch : xiph_channel_map[channels - 1][ch];
+        sbuf->planes[ch] = ibuf[ch_map];
+    }
+}
@@ -3,8 +3,8 @@
 
 #include "../streamtypes.h"
 
-/* All types are interleaved (buffer for all channels = [ch*s] = ch1 ch2 ch1 ch2 ch1 ch2 ...)
- * rather than planar (buffer per channel = [ch][s] = c1 c1 c1 c1 ...  c2 c2 c2 c2 ...) */
+/* Types are interleaved by default (buffer for all channels = [ch*s] = ch1 ch2 ch1 ch2 ch1 ch2 ...)
+ * but may be planar (buffer per channel = [ch][s] = c1 c1 c1 c1 ...  c2 c2 c2 c2 ...), see sbuf_t */
 typedef enum {
     SFMT_NONE,
     SFMT_S16,           // PCM16
@@ -22,9 +22,14 @@ typedef enum {
 /* Simple buffer info to pass around, for internal mixing. Calls may increase 'filled' samples in buf.
  * Meant to held existing sound buffer pointers rather than alloc'ing directly (some ops will swap/move its internals).
  * It's designed so that callees are allowed to swap buf/fmt/channels/etc as needed, but certain core parts may need workarounds to allow that.
+ *
+ * Planar sbufs are meant for planar decoders and the mixer, so data is only interleaved once when copied to a regular sbuf
+ * (copy/fade/silence/consume helpers handle both). Most decoders and render code write interleaved buf directly though,
+ * so buffers passed to render/decode must be interleaved. Planes array is owned by whoever sets up the sbuf (moved on consume).
  */
 typedef struct {
     void* buf;          // current sample buffer
+    void** planes;      // current buffer per channel if planar (buf is unused), NULL if interleaved
     sfmt_t fmt;         // buffer type
     int channels;       // interleaved step or planar buffers
     int samples;        // max samples
@@ -38,9 +43,11 @@ void sbuf_init_s16(sbuf_t* sbuf, int16_t* buf, int samples, int channels);
 void sbuf_init_f16(sbuf_t* sbuf, float* buf, int samples, int channels);
 void sbuf_init_flt(sbuf_t* sbuf, float* buf, int samples, int channels);
 void sbuf_init_default(sbuf_t* sbuf, int samples);
+void sbuf_init_planar(sbuf_t* sbuf, sfmt_t format, void** planes, int samples, int channels);
 
 int sfmt_get_sample_size(sfmt_t fmt);
 
+/* interleaved only */
 void* sbuf_get_filled_buf(sbuf_t* sbuf);
 
 /* move buf by samples amount to simplify some code (will lose base buf pointer) */
@@ -60,4 +67,8 @@ void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_dur
 void sbuf_interleave(sbuf_t* sbuf, float** ibuf);
 void sbuf_interleave_vorbis(sbuf_t* sbuf, float** ibuf);
 
+/* points planar sbuf's planes to ibuf (no copy, so ibuf must be valid until sbuf is consumed) */
+void sbuf_set_planes(sbuf_t* sbuf, float** ibuf);
+void sbuf_set_planes_vorbis(sbuf_t* sbuf, float** ibuf);
+
 #endif
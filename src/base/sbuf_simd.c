@@ -0,0 +1,660 @@
+#include "sbuf_simd.h"
+
+/* Kernels mirror sbuf.c's scalar conversions exactly: int>float is a regular (rounded) convert,
+ * float>int truncates like a C cast, clamps are saturating packs, and wrapping casts are done by
+ * sign-extending the low bits. Tails (count not multiple of vector size) use the same scalar ops. */
+
+#if defined(VGM_DISABLE_SIMD)
+    /* nothing */
+#elif defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86) || (defined(__i386__) && defined(__SSE2_MATH__))
+    /* 32-bit x86 only if scalar float math uses SSE too (x87 could give slightly different results) */
+    #define SIMD_X86
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define SIMD_NEON
+#endif
+
+#if defined(SIMD_X86)
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define SIMD_TARGET_SSE2
+        #define SIMD_TARGET_AVX2
+    #else
+        /* so code can be built without -mavx2 and selected at runtime */
+        #define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+        #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+
+#if defined(SIMD_X86) || defined(SIMD_NEON)
+
+typedef struct {
+    void (*i16_f32)(const int16_t* src, float* dst, int count, float scale);
+    void (*f32_i16)(const float* src, int16_t* dst, int count, float scale);
+    void (*f32_f32)(const float* src, float* dst, int count, float scale);
+    void (*i16_i32)(const int16_t* src, int32_t* dst, int count, int shift);
+    void (*i32_i16)(const int32_t* src, int16_t* dst, int count, int shift);
+    void (*i32_f32)(const int32_t* src, float* dst, int count, int shift, float scale);
+
+    void (*gain_i16)(int16_t* buf, const float* gains, int count);
+    void (*gain_i32)(int32_t* buf, const float* gains, int count);
+    void (*gain_f32)(float* buf, const float* gains, int count);
+
+    void (*interleave2)(float* dst, const float* src0, const float* src1, int count);
+} simd_ops_t;
+
+
+/* scalar tails */
+
+static inline int16_t tail_clamp16(int val) {
+    if (val > 32767) return 32767;
+    if (val < -32768) return -32768;
+    return val;
+}
+
+static void tail_i16_f32(const int16_t* src, float* dst, int i, int count, float scale) {
+    for (; i < count; i++)
+        dst[i] = src[i] * scale;
+}
+
+static void tail_f32_i16(const float* src, int16_t* dst, int i, int count, float scale) {
+    for (; i < count; i++)
+        dst[i] = tail_clamp16((int)(src[i] * scale));
+}
+
+static void tail_f32_f32(const float* src, float* dst, int i, int count, float scale) {
+    for (; i < count; i++)
+        dst[i] = src[i] * scale;
+}
+
+static void tail_i16_i32(const int16_t* src, int32_t* dst, int i, int count, int shift) {
+    for (; i < count; i++)
+        dst[i] = src[i] << shift;
+}
+
+static void tail_i32_i16(const int32_t* src, int16_t* dst, int i, int count, int shift) {
+    for (; i < count; i++)
+        dst[i] = (int16_t)(src[i] >> shift);
+}
+
+static void tail_i32_f32(const int32_t* src, float* dst, int i, int count, int shift, float scale) {
+    for (; i < count; i++)
+        dst[i] = (float)(src[i] >> shift) * scale;
+}
+
+static void tail_gain_i16(int16_t* buf, const float* gains, int i, int count) {
+    for (; i < count; i++)
+        buf[i] = (int)(buf[i] * gains[i]);
+}
+
+static void tail_gain_i32(int32_t* buf, const float* gains, int i, int count) {
+    for (; i < count; i++)
+        buf[i] = (int)(buf[i] * gains[i]);
+}
+
+static void tail_gain_f32(float* buf, const float* gains, int i, int count) {
+    for (; i < count; i++)
+        buf[i] = buf[i] * gains[i];
+}
+
+static void tail_interleave2(float* dst, const float* src0, const float* src1, int i, int count) {
+    for (; i < count; i++) {
+        dst[i * 2 + 0] = src0[i];
+        dst[i * 2 + 1] = src1[i];
+    }
+}
+
+#endif
+
+
+#if defined(SIMD_X86)
+
+/* SSE2 (x86-64 baseline) */
+
+SIMD_TARGET_SSE2 static inline __m128i sse2_sext16_lo(__m128i v) {
+    return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+
+SIMD_TARGET_SSE2 static inline __m128i sse2_sext16_hi(__m128i v) {
+    return _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+}
+
+SIMD_TARGET_SSE2 static void sse2_i16_f32(const int16_t* src, float* dst, int count, float scale) {
+    __m128 vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(sse2_sext16_lo(v)), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(sse2_sext16_hi(v)), vscale));
+    }
+    tail_i16_f32(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_SSE2 static void sse2_f32_i16(const float* src, int16_t* dst, int count, float scale) {
+    __m128 vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 0), vscale));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), vscale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    tail_f32_i16(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_SSE2 static void sse2_f32_f32(const float* src, float* dst, int count, float scale) {
+    __m128 vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_loadu_ps(src + i + 0), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_loadu_ps(src + i + 4), vscale));
+    }
+    tail_f32_f32(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_SSE2 static void sse2_i16_i32(const int16_t* src, int32_t* dst, int count, int shift) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i + 0), _mm_sll_epi32(sse2_sext16_lo(v), vshift));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_sll_epi32(sse2_sext16_hi(v), vshift));
+    }
+    tail_i16_i32(src, dst, i, count, shift);
+}
+
+SIMD_TARGET_SSE2 static void sse2_i32_i16(const int32_t* src, int16_t* dst, int count, int shift) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_sra_epi32(_mm_loadu_si128((const __m128i*)(src + i + 0)), vshift);
+        __m128i hi = _mm_sra_epi32(_mm_loadu_si128((const __m128i*)(src + i + 4)), vshift);
+        /* keep low 16 bits like a cast, so pack doesn't saturate */
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    tail_i32_i16(src, dst, i, count, shift);
+}
+
+SIMD_TARGET_SSE2 static void sse2_i32_f32(const int32_t* src, float* dst, int count, int shift, float scale) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    __m128 vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_sra_epi32(_mm_loadu_si128((const __m128i*)(src + i)), vshift);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), vscale));
+    }
+    tail_i32_f32(src, dst, i, count, shift, scale);
+}
+
+SIMD_TARGET_SSE2 static void sse2_gain_i16(int16_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(buf + i));
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sse2_sext16_lo(v)), _mm_loadu_ps(gains + i + 0)));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sse2_sext16_hi(v)), _mm_loadu_ps(gains + i + 4)));
+        _mm_storeu_si128((__m128i*)(buf + i), _mm_packs_epi32(lo, hi));
+    }
+    tail_gain_i16(buf, gains, i, count);
+}
+
+SIMD_TARGET_SSE2 static void sse2_gain_i32(int32_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(buf + i)));
+        _mm_storeu_si128((__m128i*)(buf + i), _mm_cvttps_epi32(_mm_mul_ps(v, _mm_loadu_ps(gains + i))));
+    }
+    tail_gain_i32(buf, gains, i, count);
+}
+
+SIMD_TARGET_SSE2 static void sse2_gain_f32(float* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), _mm_loadu_ps(gains + i)));
+    }
+    tail_gain_f32(buf, gains, i, count);
+}
+
+SIMD_TARGET_SSE2 static void sse2_interleave2(float* dst, const float* src0, const float* src1, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_loadu_ps(src0 + i);
+        __m128 b = _mm_loadu_ps(src1 + i);
+        _mm_storeu_ps(dst + i * 2 + 0, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(a, b));
+    }
+    tail_interleave2(dst, src0, src1, i, count);
+}
+
+static const simd_ops_t ops_sse2 = {
+    sse2_i16_f32,
+    sse2_f32_i16,
+    sse2_f32_f32,
+    sse2_i16_i32,
+    sse2_i32_i16,
+    sse2_i32_f32,
+    sse2_gain_i16,
+    sse2_gain_i32,
+    sse2_gain_f32,
+    sse2_interleave2,
+};
+
+
+/* AVX2 (most x86 CPUs since ~2013) */
+
+/* 2 x 8 int32 > 16 int16, saturated */
+SIMD_TARGET_AVX2 static inline __m256i avx2_pack32(__m256i lo, __m256i hi) {
+    /* pack works per 128-bit lane, reorder lanes after */
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+SIMD_TARGET_AVX2 static void avx2_i16_f32(const int16_t* src, float* dst, int count, float scale) {
+    __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 0)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        _mm256_storeu_ps(dst + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), vscale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), vscale));
+    }
+    tail_i16_f32(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_AVX2 static void avx2_f32_i16(const float* src, int16_t* dst, int count, float scale) {
+    __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 0), vscale));
+        __m256i hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), vscale));
+        _mm256_storeu_si256((__m256i*)(dst + i), avx2_pack32(lo, hi));
+    }
+    tail_f32_i16(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_AVX2 static void avx2_f32_f32(const float* src, float* dst, int count, float scale) {
+    __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(dst + i + 0, _mm256_mul_ps(_mm256_loadu_ps(src + i + 0), vscale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), vscale));
+    }
+    tail_f32_f32(src, dst, i, count, scale);
+}
+
+SIMD_TARGET_AVX2 static void avx2_i16_i32(const int16_t* src, int32_t* dst, int count, int shift) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 0)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        _mm256_storeu_si256((__m256i*)(dst + i + 0), _mm256_sll_epi32(lo, vshift));
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), _mm256_sll_epi32(hi, vshift));
+    }
+    tail_i16_i32(src, dst, i, count, shift);
+}
+
+SIMD_TARGET_AVX2 static void avx2_i32_i16(const int32_t* src, int16_t* dst, int count, int shift) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)(src + i + 0)), vshift);
+        __m256i hi = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)(src + i + 8)), vshift);
+        lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+        hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+        _mm256_storeu_si256((__m256i*)(dst + i), avx2_pack32(lo, hi));
+    }
+    tail_i32_i16(src, dst, i, count, shift);
+}
+
+SIMD_TARGET_AVX2 static void avx2_i32_f32(const int32_t* src, float* dst, int count, int shift, float scale) {
+    __m128i vshift = _mm_cvtsi32_si128(shift);
+    __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)(src + i)), vshift);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vscale));
+    }
+    tail_i32_f32(src, dst, i, count, shift, scale);
+}
+
+SIMD_TARGET_AVX2 static void avx2_gain_i16(int16_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(buf + i + 0)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(buf + i + 8)));
+        lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), _mm256_loadu_ps(gains + i + 0)));
+        hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), _mm256_loadu_ps(gains + i + 8)));
+        _mm256_storeu_si256((__m256i*)(buf + i), avx2_pack32(lo, hi));
+    }
+    tail_gain_i16(buf, gains, i, count);
+}
+
+SIMD_TARGET_AVX2 static void avx2_gain_i32(int32_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(buf + i)));
+        _mm256_storeu_si256((__m256i*)(buf + i), _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_loadu_ps(gains + i))));
+    }
+    tail_gain_i32(buf, gains, i, count);
+}
+
+SIMD_TARGET_AVX2 static void avx2_gain_f32(float* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(buf + i, _mm256_mul_ps(_mm256_loadu_ps(buf + i), _mm256_loadu_ps(gains + i)));
+    }
+    tail_gain_f32(buf, gains, i, count);
+}
+
+SIMD_TARGET_AVX2 static void avx2_interleave2(float* dst, const float* src0, const float* src1, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 a = _mm256_loadu_ps(src0 + i);
+        __m256 b = _mm256_loadu_ps(src1 + i);
+        __m256 lo = _mm256_unpacklo_ps(a, b); /* a0 b0 a1 b1 | a4 b4 a5 b5 */
+        __m256 hi = _mm256_unpackhi_ps(a, b); /* a2 b2 a3 b3 | a6 b6 a7 b7 */
+        _mm256_storeu_ps(dst + i * 2 + 0, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    tail_interleave2(dst, src0, src1, i, count);
+}
+
+static const simd_ops_t ops_avx2 = {
+    avx2_i16_f32,
+    avx2_f32_i16,
+    avx2_f32_f32,
+    avx2_i16_i32,
+    avx2_i32_i16,
+    avx2_i32_f32,
+    avx2_gain_i16,
+    avx2_gain_i32,
+    avx2_gain_f32,
+    avx2_interleave2,
+};
+
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static bool cpu_has_sse2(void) {
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+}
+
+static bool cpu_has_avx2(void) {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    /* CPU has AVX and OS saves YMM registers on context switches (OSXSAVE + XCR0) */
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))
+        return false;
+    if ((_xgetbv(0) & 0x06) != 0x06)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+#else
+/* also checks OS support */
+static bool cpu_has_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool cpu_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+static const simd_ops_t* detect_ops(void) {
+    if (cpu_has_avx2())
+        return &ops_avx2;
+    if (cpu_has_sse2())
+        return &ops_sse2;
+    return NULL;
+}
+
+#elif defined(SIMD_NEON)
+
+/* NEON (always available in ARM64, compile-time only in ARM32) */
+
+static void neon_i16_f32(const int16_t* src, float* dst, int count, float scale) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    tail_i16_f32(src, dst, i, count, scale);
+}
+
+static void neon_f32_i16(const float* src, int16_t* dst, int count, float scale) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 0), scale));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), scale));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    tail_f32_i16(src, dst, i, count, scale);
+}
+
+static void neon_f32_f32(const float* src, float* dst, int count, float scale) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_f32(dst + i + 0, vmulq_n_f32(vld1q_f32(src + i + 0), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vld1q_f32(src + i + 4), scale));
+    }
+    tail_f32_f32(src, dst, i, count, scale);
+}
+
+static void neon_i16_i32(const int16_t* src, int32_t* dst, int count, int shift) {
+    int32x4_t vshift = vdupq_n_s32(shift);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        vst1q_s32(dst + i + 0, vshlq_s32(vmovl_s16(vget_low_s16(v)), vshift));
+        vst1q_s32(dst + i + 4, vshlq_s32(vmovl_s16(vget_high_s16(v)), vshift));
+    }
+    tail_i16_i32(src, dst, i, count, shift);
+}
+
+static void neon_i32_i16(const int32_t* src, int16_t* dst, int count, int shift) {
+    int32x4_t vshift = vdupq_n_s32(-shift); /* negative = right shift */
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t lo = vshlq_s32(vld1q_s32(src + i + 0), vshift);
+        int32x4_t hi = vshlq_s32(vld1q_s32(src + i + 4), vshift);
+        vst1q_s16(dst + i, vcombine_s16(vmovn_s32(lo), vmovn_s32(hi))); /* non-saturating like a cast */
+    }
+    tail_i32_i16(src, dst, i, count, shift);
+}
+
+static void neon_i32_f32(const int32_t* src, float* dst, int count, int shift, float scale) {
+    int32x4_t vshift = vdupq_n_s32(-shift);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t v = vshlq_s32(vld1q_s32(src + i), vshift);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(v), scale));
+    }
+    tail_i32_f32(src, dst, i, count, shift, scale);
+}
+
+static void neon_gain_i16(int16_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(buf + i);
+        int32x4_t lo = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vld1q_f32(gains + i + 0)));
+        int32x4_t hi = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), vld1q_f32(gains + i + 4)));
+        vst1q_s16(buf + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    tail_gain_i16(buf, gains, i, count);
+}
+
+static void neon_gain_i32(int32_t* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vcvtq_f32_s32(vld1q_s32(buf + i));
+        vst1q_s32(buf + i, vcvtq_s32_f32(vmulq_f32(v, vld1q_f32(gains + i))));
+    }
+    tail_gain_i32(buf, gains, i, count);
+}
+
+static void neon_gain_f32(float* buf, const float* gains, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(buf + i, vmulq_f32(vld1q_f32(buf + i), vld1q_f32(gains + i)));
+    }
+    tail_gain_f32(buf, gains, i, count);
+}
+
+static void neon_interleave2(float* dst, const float* src0, const float* src1, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t v;
+        v.val[0] = vld1q_f32(src0 + i);
+        v.val[1] = vld1q_f32(src1 + i);
+        vst2q_f32(dst + i * 2, v);
+    }
+    tail_interleave2(dst, src0, src1, i, count);
+}
+
+static const simd_ops_t ops_neon = {
+    neon_i16_f32,
+    neon_f32_i16,
+    neon_f32_f32,
+    neon_i16_i32,
+    neon_i32_i16,
+    neon_i32_f32,
+    neon_gain_i16,
+    neon_gain_i32,
+    neon_gain_f32,
+    neon_interleave2,
+};
+
+static const simd_ops_t* detect_ops(void) {
+    return &ops_neon;
+}
+
+#endif
+
+
+#if defined(SIMD_X86) || defined(SIMD_NEON)
+
+static const simd_ops_t* get_ops(void) {
+    /* threads may detect at the same time but will set the same value (or see NULL once and use scalar code) */
+    static const simd_ops_t* volatile ops = NULL;
+    static volatile bool detected = false;
+
+    if (!detected) {
+        ops = detect_ops();
+        detected = true;
+    }
+    return ops;
+}
+
+/* scales/shifts must match sbuf.c's CONV_* */
+bool sbuf_simd_convert(const void* src, sfmt_t src_fmt, void* dst, sfmt_t dst_fmt, int count) {
+    const simd_ops_t* ops = get_ops();
+    if (!ops)
+        return false;
+
+    switch (src_fmt) {
+        case SFMT_S16:
+            switch (dst_fmt) {
+                case SFMT_F16: ops->i16_f32(src, dst, count, 1.0f); return true;
+                case SFMT_FLT: ops->i16_f32(src, dst, count, (1.0f / 32767.0f)); return true;
+                case SFMT_S24: ops->i16_i32(src, dst, count, 8); return true;
+                case SFMT_S32: ops->i16_i32(src, dst, count, 16); return true;
+                default: return false;
+            }
+        case SFMT_F16:
+            switch (dst_fmt) {
+                case SFMT_S16: ops->f32_i16(src, dst, count, 1.0f); return true;
+                case SFMT_FLT: ops->f32_f32(src, dst, count, (1.0f / 32767.0f)); return true;
+                default: return false;
+            }
+        case SFMT_FLT:
+            switch (dst_fmt) {
+                case SFMT_S16: ops->f32_i16(src, dst, count, 32767.0f); return true;
+                case SFMT_F16: ops->f32_f32(src, dst, count, 32767.0f); return true;
+                default: return false;
+            }
+        case SFMT_S24:
+            switch (dst_fmt) {
+                case SFMT_S16: ops->i32_i16(src, dst, count, 8); return true;
+                case SFMT_F16: ops->i32_f32(src, dst, count, 8, 1.0f); return true;
+                case SFMT_FLT: ops->i32_f32(src, dst, count, 0, (1.0f / 8388607.0f)); return true;
+                default: return false;
+            }
+        case SFMT_S32:
+            switch (dst_fmt) {
+                case SFMT_S16: ops->i32_i16(src, dst, count, 16); return true;
+                case SFMT_F16: ops->i32_f32(src, dst, count, 16, 1.0f); return true;
+                case SFMT_FLT: ops->i32_f32(src, dst, count, 0, (1.0f / 2147483647.0f)); return true;
+                default: return false;
+            }
+        default:
+            return false;
+    }
+}
+
+bool sbuf_simd_can_convert(sfmt_t src_fmt, sfmt_t dst_fmt) {
+    return sbuf_simd_convert(NULL, src_fmt, NULL, dst_fmt, 0); /* no-op when supported */
+}
+
+bool sbuf_simd_gain(void* buf, sfmt_t fmt, const float* gains, int count) {
+    const simd_ops_t* ops = get_ops();
+    if (!ops)
+        return false;
+
+    switch (fmt) {
+        case SFMT_S16:
+            ops->gain_i16(buf, gains, count);
+            return true;
+        case SFMT_S24:
+        case SFMT_S32:
+            ops->gain_i32(buf, gains, count);
+            return true;
+        case SFMT_F16:
+        case SFMT_FLT:
+            ops->gain_f32(buf, gains, count);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool sbuf_simd_interleave2(float* dst, const float* src0, const float* src1, int count) {
+    const simd_ops_t* ops = get_ops();
+    if (!ops)
+        return false;
+
+    ops->interleave2(dst, src0, src1, count);
+    return true;
+}
+
+#else
+
+bool sbuf_simd_can_convert(sfmt_t src_fmt, sfmt_t dst_fmt) {
+    return false;
+}
+
+bool sbuf_simd_convert(const void* src, sfmt_t src_fmt, void* dst, sfmt_t dst_fmt, int count) {
+    return false;
+}
+
+bool sbuf_simd_gain(void* buf, sfmt_t fmt, const float* gains, int count) {
+    return false;
+}
+
+bool sbuf_simd_interleave2(float* dst, const float* src0, const float* src1, int count) {
+    return false;
+}
+
+#endif
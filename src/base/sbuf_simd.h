@@ -0,0 +1,21 @@
+#ifndef _SBUF_SIMD_H_
+#define _SBUF_SIMD_H_
+
+#include "sbuf.h"
+
+/* Vectorized (SSE2/AVX2/NEON) versions of the hottest sbuf loops, picked at runtime from CPU features.
+ * Results are the same as sbuf's scalar code (same float ops and truncation). Calls return false when
+ * there is no kernel for the formats/CPU (or SIMD is disabled), so callers must fall back to scalar code. */
+
+bool sbuf_simd_can_convert(sfmt_t src_fmt, sfmt_t dst_fmt);
+
+/* converts count contiguous samples (not frames) */
+bool sbuf_simd_convert(const void* src, sfmt_t src_fmt, void* dst, sfmt_t dst_fmt, int count);
+
+/* buf[i] = buf[i] * gains[i] (truncated back for PCM formats) */
+bool sbuf_simd_gain(void* buf, sfmt_t fmt, const float* gains, int count);
+
+/* dst = src0[0], src1[0], src0[1], src1[1], ... */
+bool sbuf_simd_interleave2(float* dst, const float* src0, const float* src1, int count);
+
+#endif
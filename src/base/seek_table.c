@@ -16,14 +16,19 @@ static bool init_table(VGMSTREAM* v) {
     if (!v->seek_table) {
         v->seek_table = calloc(1, sizeof(seek_table_t));
         if (!v->seek_table) return false;
+
+        // tables may be created during decode, and must survive reset_vgmstream
+        VGMSTREAM* start_v = v->start_vgmstream;
+        if (start_v)
+            start_v->seek_table = v->seek_table;
     }
 
     return true;
 }
 
-bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, uint32_t offset) {
-    //;VGM_LOG("SEEK-TABLE: add entry sample=%i, offset=%x\n", sample, offset);
-    if (sample < 0 || offset == 0xFFFFFFFF)
+bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, offv_t offset) {
+    //;VGM_LOG("SEEK-TABLE: add entry sample=%i, offset=%x\n", sample, (uint32_t)offset);
+    if (sample < 0 || offset < 0)
         return false;
 
     if (!init_table(v))
@@ -31,6 +36,12 @@ bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, uint32_t offset) {
 
     seek_table_t* table = v->seek_table;
 
+    // lookups are binary searches
+    if (table->count > 0 && sample < table->entries[table->count - 1].sample) {
+        VGM_LOG("SEEK-TABLE: unordered seek entry, sample=%i vs last=%i\n", sample, table->entries[table->count - 1].sample);
+        return false;
+    }
+
     // grow as needed
     if (table->count >= table->capacity) {
         int new_capacity = (table->capacity == 0) ? GROWTH_BASE : table->capacity * GROWTH_FACTOR;
@@ -52,21 +63,29 @@ bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, uint32_t offset) {
     return true;
 }
 
-bool seek_table_add_entry_validate(VGMSTREAM* v, int32_t sample, int32_t max_samples, uint32_t offset, uint32_t max_offset) {
+bool seek_table_add_entry_validate(VGMSTREAM* v, int32_t sample, int32_t max_samples, offv_t offset, offv_t max_offset) {
 
     if (sample > max_samples) {
-        VGM_LOG("SEEK-TABLE: bad seek entry, packet=%i vs samples=%i (o=%x)\n", sample, max_samples, offset);
+        VGM_LOG("SEEK-TABLE: bad seek entry, packet=%i vs samples=%i (o=%x)\n", sample, max_samples, (uint32_t)offset);
         return false;
     }
 
     if (offset > max_offset) {
-        VGM_LOG("SEEK-TABLE: bad seek entry, offset=%x vs max=%x (s=%i)\n", offset, max_offset, sample);
+        VGM_LOG("SEEK-TABLE: bad seek entry, offset=%x vs max=%x (s=%i)\n", (uint32_t)offset, (uint32_t)max_offset, sample);
         return false;
     }
 
     return seek_table_add_entry(v, sample, offset);
 }
 
+int32_t seek_table_get_last_sample(VGMSTREAM* v) {
+    seek_table_t* table = v->seek_table;
+    if (!table || table->count == 0)
+        return -1;
+
+    return table->entries[table->count - 1].sample;
+}
+
 
 static int32_t seek_table_get_entry_internal(VGMSTREAM* v, int32_t target_sample, seek_entry_t* entry, bool prev) {
     //;VGM_LOG("SEEK-TABLE: find entry for sample %i\n", target_sample);
@@ -79,12 +98,16 @@ static int32_t seek_table_get_entry_internal(VGMSTREAM* v, int32_t target_sample
         return -1;
     }
 
-    int best_entry = -1;
-    for (int i = 0; i < table->count; i++) {
-        if (table->entries[i].sample > target_sample)
-            break;
-        best_entry = i;
+    // find last entry <= target (entries with the same sample resolve to the last one)
+    int lo = 0, hi = table->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (table->entries[mid].sample > target_sample)
+            hi = mid;
+        else
+            lo = mid + 1;
     }
+    int best_entry = lo - 1;
 
     // for setup samples stuff
     if (prev) {
@@ -98,7 +121,7 @@ static int32_t seek_table_get_entry_internal(VGMSTREAM* v, int32_t target_sample
     }
 
     *entry = table->entries[best_entry]; //memcpy
-    //;VGM_LOG("SEEK-TABLE: entry %i found (sample=%i, offset=%x, skip=%i)\n", best_entry, entry->sample, entry->offset, target_sample - entry->sample);
+    //;VGM_LOG("SEEK-TABLE: entry %i found (sample=%i, offset=%x, skip=%i)\n", best_entry, entry->sample, (uint32_t)entry->offset, target_sample - entry->sample);
     return target_sample - entry->sample;
 }
 
@@ -7,17 +7,21 @@ typedef struct seek_table_t seek_table_t;
 
 typedef struct {
     int32_t sample;     // sample closest to offset, preferably including pre-roll
-    uint32_t offset;    // offset within file, preferably absolute
+    offv_t offset;      // offset within file, preferably absolute
 } seek_entry_t;
 
 
 /* Add new seek entry to vgmstream for current codec.
- * Entries must be ordered, and first entry doesn't need to be 0.
+ * Entries must be ordered by sample (out of order entries are rejected), and first entry doesn't need to be 0.
  */
-bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, uint32_t offset);
-bool seek_table_add_entry_validate(VGMSTREAM* v, int32_t sample, int32_t max_samples, uint32_t offset, uint32_t max_offset);
+bool seek_table_add_entry(VGMSTREAM* v, int32_t sample, offv_t offset);
+bool seek_table_add_entry_validate(VGMSTREAM* v, int32_t sample, int32_t max_samples, offv_t offset, offv_t max_offset);
 
-/* Loads seek entry closest to sample 
+/* Returns last entry's sample, or -1 if table is empty (for decoders that add entries while decoding).
+ */
+int32_t seek_table_get_last_sample(VGMSTREAM* v);
+
+/* Loads seek entry closest to sample (binary search, last entry <= sample).
  * Returns num samples to skip after seeking, or -1 if not found (no closest entry/empty table).
  */
 int32_t seek_table_get_entry(VGMSTREAM* v, int32_t sample, seek_entry_t* entry);
@@ -15,7 +15,11 @@ typedef struct {
 static size_t api_read(API_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
     void* user_data = sf->libsf->user_data;
 
-    return sf->libsf->read(user_data, dst, offset, length);
+    int bytes = sf->libsf->read(user_data, dst, offset, length);
+    if (bytes < 0)
+        bytes = 0;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
 }
 
 static size_t api_get_size(API_STREAMFILE* sf) {
@@ -44,6 +48,8 @@ static void api_get_name(API_STREAMFILE* sf, char* name, size_t name_size) {
 }
 
 static STREAMFILE* api_open(API_STREAMFILE* sf, const char* filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+
     libstreamfile_t* libsf = sf->libsf->open(sf->libsf->user_data, filename);
     STREAMFILE* new_sf = open_api_streamfile_internal(libsf, false);
 
@@ -78,6 +84,8 @@ static STREAMFILE* open_api_streamfile_internal(libstreamfile_t* libsf, bool ext
     this_sf->vt.open = (void*)api_open;
     this_sf->vt.close = (void*)api_close;
     //this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "api";
+    this_sf->vt.stats_inner = api_libsf_get_streamfile(libsf); /* only for our own libsf */
 
     this_sf->libsf = libsf;
     this_sf->external_libsf = external_libsf;
@@ -15,7 +15,14 @@ typedef struct {
 } BUFFER_STREAMFILE;
 
 
-static size_t buffer_read(BUFFER_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+/* refills the buffer at offset */
+static void buffer_fill(BUFFER_STREAMFILE* sf, offv_t offset) {
+    sf->vt.stats.misses++;
+    sf->buf_offset = offset;
+    sf->valid_size = sf->inner_sf->read(sf->inner_sf, sf->buf, sf->buf_offset, sf->buf_size);
+}
+
+static size_t buffer_read_internal(BUFFER_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
     size_t read_total = 0;
 
     if (!dst || length <= 0 || offset < 0)
@@ -55,8 +62,7 @@ static size_t buffer_read(BUFFER_STREAMFILE* sf, uint8_t* dst, offv_t offset, si
         }
 
         /* fill the buffer (offset now is beyond buf_offset) */
-        sf->buf_offset = offset;
-        sf->valid_size = sf->inner_sf->read(sf->inner_sf, sf->buf, sf->buf_offset, sf->buf_size);
+        buffer_fill(sf, offset);
 
         /* decide how much must be read this time */
         if (length > sf->buf_size)
@@ -84,6 +90,38 @@ static size_t buffer_read(BUFFER_STREAMFILE* sf, uint8_t* dst, offv_t offset, si
     return read_total;
 }
 
+static size_t buffer_read(BUFFER_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    size_t bytes = buffer_read_internal(sf, dst, offset, length);
+
+    if (bytes > 0 && sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* buffer_get_view(BUFFER_STREAMFILE* sf, offv_t offset, size_t length) {
+    if (offset < 0 || length > sf->buf_size)
+        return NULL;
+
+    if (offset < sf->buf_offset || offset + length > sf->buf_offset + sf->valid_size) {
+        /* refill, as a read would */
+        if (offset >= sf->file_size)
+            return NULL;
+        buffer_fill(sf, offset);
+        if (offset + length > sf->buf_offset + sf->valid_size)
+            return NULL; /* EOF */
+    }
+    else {
+        sf->vt.stats.hits++;
+    }
+
+    update_streamfile_stats(&sf->vt.stats, offset, length);
+    sf->offset = offset + length;
+    return sf->buf + (offset - sf->buf_offset);
+}
+
 static size_t buffer_get_size(BUFFER_STREAMFILE* sf) {
     return sf->file_size; /* cache */
 }
@@ -97,6 +135,7 @@ static void buffer_get_name(BUFFER_STREAMFILE* sf, char* name, size_t name_size)
 }
 
 static STREAMFILE* buffer_open(BUFFER_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
     STREAMFILE* new_inner_sf = sf->inner_sf->open(sf->inner_sf,filename,buf_size);
     return open_buffer_streamfile(new_inner_sf, buf_size); /* original buffer size is preferable? */
 }
@@ -126,7 +165,10 @@ STREAMFILE* open_buffer_streamfile(STREAMFILE* sf, size_t buf_size) {
     this_sf->vt.get_name = (void*)buffer_get_name;
     this_sf->vt.open = (void*)buffer_open;
     this_sf->vt.close = (void*)buffer_close;
+    this_sf->vt.get_view = (void*)buffer_get_view;
     this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "buffer";
+    this_sf->vt.stats_inner = sf;
 
     this_sf->inner_sf = sf;
     this_sf->buf_size = buf_size;
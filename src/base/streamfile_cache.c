@@ -0,0 +1,117 @@
+#include "../streamfile.h"
+#include "../util/block_cache.h"
+
+
+typedef struct {
+    STREAMFILE vt;
+
+    STREAMFILE* inner_sf;
+    block_cache_t* cache;
+    offv_t offset;          /* last read offset (info) */
+    size_t file_size;
+
+    /* config for reopens */
+    int block_count;
+    size_t block_size;
+    block_cache_stats_t* stats;
+} CACHE_STREAMFILE;
+
+static size_t cache_inner_read(void* arg, uint8_t* dst, int64_t offset, size_t length) {
+    CACHE_STREAMFILE* sf = arg;
+    sf->vt.stats.misses++;
+    return sf->inner_sf->read(sf->inner_sf, dst, offset, length);
+}
+
+static size_t cache_read(CACHE_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    size_t bytes = block_cache_read(sf->cache, dst, offset, length);
+    sf->offset = offset + bytes;
+
+    if (bytes > 0 && sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* cache_get_view(CACHE_STREAMFILE* sf, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    const uint8_t* view = block_cache_get_view(sf->cache, offset, length);
+    if (view) {
+        sf->offset = offset + length;
+
+        if (sf->vt.stats.misses == misses)
+            sf->vt.stats.hits++;
+        update_streamfile_stats(&sf->vt.stats, offset, length);
+    }
+    return view;
+}
+
+static size_t cache_get_size(CACHE_STREAMFILE* sf) {
+    return sf->file_size; /* cache */
+}
+
+static offv_t cache_get_offset(CACHE_STREAMFILE* sf) {
+    return sf->offset; /* cache */
+}
+
+static void cache_get_name(CACHE_STREAMFILE* sf, char* name, size_t name_size) {
+    sf->inner_sf->get_name(sf->inner_sf, name, name_size); /* default */
+}
+
+static STREAMFILE* cache_open(CACHE_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+    STREAMFILE* new_inner_sf = sf->inner_sf->open(sf->inner_sf, filename, buf_size);
+    return open_cache_streamfile_f(new_inner_sf, sf->block_count, sf->block_size, sf->stats);
+}
+
+static void cache_close(CACHE_STREAMFILE* sf) {
+    sf->inner_sf->close(sf->inner_sf);
+    block_cache_free(sf->cache);
+    free(sf);
+}
+
+
+STREAMFILE* open_cache_streamfile(STREAMFILE* sf, int block_count, size_t block_size, block_cache_stats_t* stats) {
+    CACHE_STREAMFILE* this_sf = NULL;
+
+    if (!sf) goto fail;
+
+    this_sf = calloc(1, sizeof(CACHE_STREAMFILE));
+    if (!this_sf) goto fail;
+
+    /* set callbacks and internals */
+    this_sf->vt.read = (void*)cache_read;
+    this_sf->vt.get_size = (void*)cache_get_size;
+    this_sf->vt.get_offset = (void*)cache_get_offset;
+    this_sf->vt.get_name = (void*)cache_get_name;
+    this_sf->vt.open = (void*)cache_open;
+    this_sf->vt.close = (void*)cache_close;
+    this_sf->vt.get_view = (void*)cache_get_view;
+    this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "cache";
+    this_sf->vt.stats_inner = sf;
+
+    this_sf->inner_sf = sf;
+    this_sf->file_size = sf->get_size(sf);
+    this_sf->block_count = block_count;
+    this_sf->block_size = block_size;
+    this_sf->stats = stats;
+
+    this_sf->cache = block_cache_init(block_count, block_size, this_sf->file_size, cache_inner_read, this_sf, stats);
+    if (!this_sf->cache) goto fail;
+
+    return &this_sf->vt;
+
+fail:
+    free(this_sf);
+    return NULL;
+}
+
+STREAMFILE* open_cache_streamfile_f(STREAMFILE* sf, int block_count, size_t block_size, block_cache_stats_t* stats) {
+    STREAMFILE* new_sf = open_cache_streamfile(sf, block_count, block_size, stats);
+    if (!new_sf)
+        close_streamfile(sf);
+    return new_sf;
+}
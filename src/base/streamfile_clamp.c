@@ -20,7 +20,18 @@ static size_t clamp_read(CLAMP_STREAMFILE* sf, uint8_t* dst, offv_t offset, size
             clamp_length = sf->size - offset;
     }
 
-    return sf->inner_sf->read(sf->inner_sf, dst, inner_offset, clamp_length);
+    size_t bytes = sf->inner_sf->read(sf->inner_sf, dst, inner_offset, clamp_length);
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* clamp_get_view(CLAMP_STREAMFILE* sf, offv_t offset, size_t length) {
+    if (offset < 0 || offset + length > sf->size)
+        return NULL;
+    const uint8_t* view = get_streamfile_view(sf->start + offset, length, sf->inner_sf);
+    if (view)
+        update_streamfile_stats(&sf->vt.stats, offset, length);
+    return view;
 }
 
 static size_t clamp_get_size(CLAMP_STREAMFILE* sf) {
@@ -39,6 +50,7 @@ static STREAMFILE* clamp_open(CLAMP_STREAMFILE* sf, const char* const filename,
     char original_filename[PATH_LIMIT];
     STREAMFILE* new_inner_sf = NULL;
 
+    sf->vt.stats.reopens++;
     new_inner_sf = sf->inner_sf->open(sf->inner_sf,filename,buf_size);
     sf->inner_sf->get_name(sf->inner_sf, original_filename, PATH_LIMIT);
 
@@ -72,7 +84,10 @@ STREAMFILE* open_clamp_streamfile(STREAMFILE* sf, offv_t start, size_t size) {
     this_sf->vt.get_name = (void*)clamp_get_name;
     this_sf->vt.open = (void*)clamp_open;
     this_sf->vt.close = (void*)clamp_close;
+    this_sf->vt.get_view = (void*)clamp_get_view;
     this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "clamp";
+    this_sf->vt.stats_inner = sf;
 
     this_sf->inner_sf = sf;
     this_sf->start = start;
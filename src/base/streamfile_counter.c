@@ -0,0 +1,88 @@
+#include "../streamfile.h"
+
+
+typedef struct {
+    STREAMFILE vt;
+
+    STREAMFILE* inner_sf;
+    offv_t buf_offset;      /* simulated buffer start */
+    size_t buf_size;        /* simulated buffer size */
+    size_t valid_size;      /* simulated buffer data (0 until first read) */
+    size_t file_size;
+} COUNTER_STREAMFILE;
+
+static size_t counter_read(COUNTER_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    size_t bytes = sf->inner_sf->read(sf->inner_sf, dst, offset, length);
+
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+
+    /* mimic a standard buffered SF (not exact as inner SFs may have different sizes or read small files at once) */
+    if (length > 0 && (offset < sf->buf_offset || offset + length > sf->buf_offset + sf->valid_size)) {
+        sf->vt.stats.misses++;
+        if (offset >= sf->buf_offset && offset < sf->buf_offset + sf->valid_size)
+            offset = sf->buf_offset + sf->valid_size; /* partially buffered */
+        sf->buf_offset = sf->file_size <= sf->buf_size ? 0 : offset;
+        sf->valid_size = sf->buf_size;
+    }
+    else if (bytes > 0) {
+        sf->vt.stats.hits++;
+    }
+
+    return bytes;
+}
+
+static size_t counter_get_size(COUNTER_STREAMFILE* sf) {
+    return sf->inner_sf->get_size(sf->inner_sf); /* default */
+}
+
+static offv_t counter_get_offset(COUNTER_STREAMFILE* sf) {
+    return sf->inner_sf->get_offset(sf->inner_sf); /* default */
+}
+
+static void counter_get_name(COUNTER_STREAMFILE* sf, char* name, size_t name_size) {
+    sf->inner_sf->get_name(sf->inner_sf, name, name_size); /* default */
+}
+
+static STREAMFILE* counter_open(COUNTER_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+    return sf->inner_sf->open(sf->inner_sf, filename, buf_size); /* default (new SF isn't counted) */
+}
+
+static void counter_close(COUNTER_STREAMFILE* sf) {
+    sf->inner_sf->close(sf->inner_sf);
+    free(sf);
+}
+
+
+STREAMFILE* open_counter_streamfile(STREAMFILE* sf) {
+    COUNTER_STREAMFILE* this_sf = NULL;
+
+    if (!sf) return NULL;
+
+    this_sf = calloc(1, sizeof(COUNTER_STREAMFILE));
+    if (!this_sf) return NULL;
+
+    /* set callbacks and internals */
+    this_sf->vt.read = (void*)counter_read;
+    this_sf->vt.get_size = (void*)counter_get_size;
+    this_sf->vt.get_offset = (void*)counter_get_offset;
+    this_sf->vt.get_name = (void*)counter_get_name;
+    this_sf->vt.open = (void*)counter_open;
+    this_sf->vt.close = (void*)counter_close;
+    this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "counter";
+    this_sf->vt.stats_inner = sf;
+
+    this_sf->inner_sf = sf;
+    this_sf->buf_size = STREAMFILE_DEFAULT_BUFFER_SIZE;
+    this_sf->file_size = get_streamfile_size(sf);
+
+    return &this_sf->vt;
+}
+
+STREAMFILE* open_counter_streamfile_f(STREAMFILE* sf) {
+    STREAMFILE* new_sf = open_counter_streamfile(sf);
+    if (!new_sf)
+        close_streamfile(sf);
+    return new_sf;
+}
@@ -11,7 +11,16 @@ typedef struct {
 } FAKENAME_STREAMFILE;
 
 static size_t fakename_read(FAKENAME_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
-    return sf->inner_sf->read(sf->inner_sf, dst, offset, length); /* default */
+    size_t bytes = sf->inner_sf->read(sf->inner_sf, dst, offset, length); /* default */
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* fakename_get_view(FAKENAME_STREAMFILE* sf, offv_t offset, size_t length) {
+    const uint8_t* view = get_streamfile_view(offset, length, sf->inner_sf); /* default */
+    if (view)
+        update_streamfile_stats(&sf->vt.stats, offset, length);
+    return view;
 }
 
 static size_t fakename_get_size(FAKENAME_STREAMFILE* sf) {
@@ -31,6 +40,8 @@ static void fakename_get_name(FAKENAME_STREAMFILE* sf, char* name, size_t name_s
 }
 
 static STREAMFILE* fakename_open(FAKENAME_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+
     /* detect re-opening the file */
     if (strcmp(filename, sf->fakename) == 0) {
         STREAMFILE* new_inner_sf;
@@ -67,7 +78,10 @@ STREAMFILE* open_fakename_streamfile(STREAMFILE* sf, const char* fakename, const
     this_sf->vt.get_name = (void*)fakename_get_name;
     this_sf->vt.open = (void*)fakename_open;
     this_sf->vt.close = (void*)fakename_close;
+    this_sf->vt.get_view = (void*)fakename_get_view;
     this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "fakename";
+    this_sf->vt.stats_inner = sf;
 
     this_sf->inner_sf = sf;
 
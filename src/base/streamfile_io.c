@@ -14,7 +14,9 @@ typedef struct {
 } IO_STREAMFILE;
 
 static size_t io_read(IO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
-    return sf->read_callback(sf->inner_sf, dst, (off_t)offset, length, sf->data);
+    size_t bytes = sf->read_callback(sf->inner_sf, dst, (off_t)offset, length, sf->data);
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
 }
 
 static size_t io_get_size(IO_STREAMFILE* sf) {
@@ -33,6 +35,7 @@ static void io_get_name(IO_STREAMFILE* sf, char* name, size_t name_size) {
 }
 
 static STREAMFILE* io_open(IO_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
     STREAMFILE* new_inner_sf = sf->inner_sf->open(sf->inner_sf,filename,buf_size);
     return open_io_streamfile_ex(new_inner_sf, sf->data, sf->data_size, sf->read_callback, sf->size_callback, sf->init_callback, sf->close_callback);
 }
@@ -63,6 +66,8 @@ STREAMFILE* open_io_streamfile_ex(STREAMFILE* sf, void* data, size_t data_size,
     this_sf->vt.open = (void*)io_open;
     this_sf->vt.close = (void*)io_close;
     this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "io";
+    this_sf->vt.stats_inner = sf;
 
     this_sf->inner_sf = sf;
     if (data) {
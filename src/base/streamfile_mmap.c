@@ -0,0 +1,258 @@
+#include "../streamfile.h"
+#include "../util/vgmstream_limits.h"
+#include "../util/log.h"
+#include "../util/threads.h"
+
+/* Memory-mapped STREAMFILE, for local files.
+ * Reads are a bounds check + memcpy from the mapped view, and reopens of the same file (ex. per-channel
+ * SFs in vgmstream_open_stream_bf) share the same mapping, so pages are only read/cached once by the OS
+ * rather than once per FILE buffer.
+ * When mmap isn't available or fails (virtual/empty/non-regular files, or address space exhausted in
+ * 32-bit systems with giant files) it falls back to standard stdio.
+ * Files must not be truncated while mapped (reads past the new end may crash), so only for local files. */
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #define USE_MMAP_WIN32 1
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #define USE_MMAP_POSIX 1
+#endif
+
+#if defined(USE_MMAP_WIN32) || defined(USE_MMAP_POSIX)
+
+/* mapping shared between all SFs opened from the same file */
+typedef struct {
+    uint8_t* data;          /* mapped view */
+    size_t size;            /* file size (mapped size) */
+    int refs;               /* SFs using this mapping (atomic, SFs may be closed from other threads) */
+} mmap_shared_t;
+
+typedef struct {
+    STREAMFILE vt;
+
+    mmap_shared_t* shared;
+    offv_t offset;          /* last read offset (info) */
+    char name[PATH_LIMIT];
+    int name_len;
+} MMAP_STREAMFILE;
+
+static STREAMFILE* open_mmap_streamfile_shared(mmap_shared_t* shared, const char* filename);
+
+
+static size_t mmap_read(MMAP_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    size_t file_size = sf->shared->size;
+
+    if (!dst || length <= 0 || offset < 0 || offset >= file_size)
+        return 0;
+
+    if (offset + length > file_size)
+        length = file_size - offset;
+
+    memcpy(dst, sf->shared->data + offset, length);
+    sf->offset = offset + length;
+
+    sf->vt.stats.hits++; /* whole file is "buffered" (page faults aren't visible) */
+    update_streamfile_stats(&sf->vt.stats, offset, length);
+    return length;
+}
+
+static const uint8_t* mmap_get_view(MMAP_STREAMFILE* sf, offv_t offset, size_t length) {
+    if (offset < 0 || offset + length > sf->shared->size)
+        return NULL;
+
+    sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, length);
+    sf->offset = offset + length;
+    return sf->shared->data + offset;
+}
+
+static size_t mmap_get_size(MMAP_STREAMFILE* sf) {
+    return sf->shared->size;
+}
+
+static offv_t mmap_get_offset(MMAP_STREAMFILE* sf) {
+    return sf->offset;
+}
+
+static void mmap_get_name(MMAP_STREAMFILE* sf, char* name, size_t name_size) {
+    int copy_size = sf->name_len + 1;
+    if (copy_size > name_size)
+        copy_size = name_size;
+
+    memcpy(name, sf->name, copy_size);
+    name[copy_size - 1] = '\0';
+}
+
+static STREAMFILE* mmap_open(MMAP_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    if (!filename)
+        return NULL;
+    sf->vt.stats.reopens++;
+
+    /* same file: reuse mapping (buf_size is irrelevant here) */
+    if (strcmp(sf->name, filename) == 0) {
+        STREAMFILE* new_sf = open_mmap_streamfile_shared(sf->shared, filename);
+        if (new_sf)
+            return new_sf;
+    }
+
+    return open_mmap_streamfile(filename);
+}
+
+static void mmap_unmap(mmap_shared_t* shared) {
+#if defined(USE_MMAP_WIN32)
+    UnmapViewOfFile(shared->data);
+#else
+    munmap(shared->data, shared->size);
+#endif
+    free(shared);
+}
+
+static void mmap_close(MMAP_STREAMFILE* sf) {
+    if (vgm_atomic_add(&sf->shared->refs, -1) <= 0)
+        mmap_unmap(sf->shared);
+    free(sf);
+}
+
+
+static STREAMFILE* open_mmap_streamfile_shared(mmap_shared_t* shared, const char* filename) {
+    MMAP_STREAMFILE* this_sf = calloc(1, sizeof(MMAP_STREAMFILE));
+    if (!this_sf) return NULL;
+
+    this_sf->vt.read = (void*)mmap_read;
+    this_sf->vt.get_size = (void*)mmap_get_size;
+    this_sf->vt.get_offset = (void*)mmap_get_offset;
+    this_sf->vt.get_name = (void*)mmap_get_name;
+    this_sf->vt.open = (void*)mmap_open;
+    this_sf->vt.close = (void*)mmap_close;
+    this_sf->vt.get_view = (void*)mmap_get_view;
+    this_sf->vt.stats.type = "mmap";
+
+    this_sf->name_len = strlen(filename);
+    if (this_sf->name_len >= sizeof(this_sf->name)) {
+        free(this_sf);
+        return NULL;
+    }
+    memcpy(this_sf->name, filename, this_sf->name_len);
+    this_sf->name[this_sf->name_len] = '\0';
+
+    this_sf->shared = shared;
+    vgm_atomic_add(&shared->refs, 1);
+
+    return &this_sf->vt;
+}
+
+#if defined(USE_MMAP_WIN32)
+static mmap_shared_t* mmap_map_file(const char* filename) {
+    mmap_shared_t* shared = NULL;
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+    LARGE_INTEGER file_size;
+    void* data = NULL;
+
+#ifdef VGM_STDIO_UNICODE
+    wchar_t wpath[PATH_LIMIT];
+    if (MultiByteToWideChar(CP_UTF8, 0, filename, -1, wpath, PATH_LIMIT) <= 0)
+        goto fail;
+    file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#else
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#endif
+    if (file == INVALID_HANDLE_VALUE)
+        goto fail;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0 || (uint64_t)file_size.QuadPart > SIZE_MAX)
+        goto fail;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+        goto fail;
+
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+        goto fail;
+
+    /* the view keeps its own references */
+    CloseHandle(mapping);
+    CloseHandle(file);
+
+    shared = calloc(1, sizeof(mmap_shared_t));
+    if (!shared) {
+        UnmapViewOfFile(data);
+        return NULL;
+    }
+    shared->data = data;
+    shared->size = (size_t)file_size.QuadPart;
+    return shared;
+
+fail:
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    return NULL;
+}
+#else
+static mmap_shared_t* mmap_map_file(const char* filename) {
+    mmap_shared_t* shared = NULL;
+    struct stat st;
+    void* data;
+    int fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    /* only regular files can be mapped (pipes/devices and such go to stdio) */
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* mapping keeps its own reference */
+    if (data == MAP_FAILED)
+        return NULL;
+
+    shared = calloc(1, sizeof(mmap_shared_t));
+    if (!shared) {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    shared->data = data;
+    shared->size = (size_t)st.st_size;
+    return shared;
+}
+#endif
+
+STREAMFILE* open_mmap_streamfile(const char* filename) {
+    mmap_shared_t* shared = NULL;
+    STREAMFILE* sf = NULL;
+
+    if (!filename)
+        return NULL;
+
+    shared = mmap_map_file(filename);
+    if (!shared) {
+        /* handles virtual/empty/special files too */
+        return open_stdio_streamfile(filename);
+    }
+
+    sf = open_mmap_streamfile_shared(shared, filename);
+    if (!sf) {
+        mmap_unmap(shared);
+        return NULL;
+    }
+
+    return sf;
+}
+
+#else
+
+STREAMFILE* open_mmap_streamfile(const char* filename) {
+    return open_stdio_streamfile(filename);
+}
+
+#endif
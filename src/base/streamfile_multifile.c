@@ -46,6 +46,7 @@ static size_t multifile_read(MULTIFILE_STREAMFILE* sf, uint8_t* dst, offv_t offs
     }
 
     sf->offset = offset + done;
+    update_streamfile_stats(&sf->vt.stats, offset, done);
     return done;
 }
 
@@ -67,6 +68,7 @@ static STREAMFILE* multifile_open(MULTIFILE_STREAMFILE* sf, const char* const fi
     STREAMFILE** new_inner_sfs = NULL;
     int i;
 
+    sf->vt.stats.reopens++;
     sf->inner_sfs[0]->get_name(sf->inner_sfs[0], original_filename, PATH_LIMIT);
 
     /* detect re-opening the file */
@@ -133,6 +135,8 @@ STREAMFILE* open_multifile_streamfile(STREAMFILE** sfs, size_t sfs_size) {
     this_sf->vt.open = (void*)multifile_open;
     this_sf->vt.close = (void*)multifile_close;
     this_sf->vt.stream_index = sfs[0]->stream_index;
+    this_sf->vt.stats.type = "multifile";
+    this_sf->vt.stats_inner = sfs[0]; /* only the first segment's stats */
 
     this_sf->inner_sfs_size = sfs_size;
     this_sf->inner_sfs = calloc(sfs_size, sizeof(STREAMFILE*));
@@ -0,0 +1,182 @@
+#include "../streamfile.h"
+
+
+/* A STREAMFILE that keeps the first and last N bytes in memory, loaded once on first access. Meant for
+ * format detection, where many parsers read small header/footer values and would otherwise make the
+ * underlying SF refill its buffer back and forth (each a fseek+fread, slow-ish on network filesystems). */
+
+typedef struct {
+    offv_t offset;
+    size_t size;
+    uint8_t* data;
+    bool loaded;
+} prefetch_window_t;
+
+typedef struct {
+    STREAMFILE vt;
+
+    STREAMFILE* inner_sf;
+    prefetch_window_t head;
+    prefetch_window_t tail;
+    size_t file_size;
+} PREFETCH_STREAMFILE;
+
+
+static const uint8_t* get_window(PREFETCH_STREAMFILE* sf, prefetch_window_t* window, offv_t offset, size_t length) {
+    if (window->size == 0 || offset < window->offset || offset + length > window->offset + window->size)
+        return NULL;
+
+    if (!window->loaded) {
+        sf->vt.stats.misses++;
+        size_t bytes = sf->inner_sf->read(sf->inner_sf, window->data, window->offset, window->size);
+        if (bytes != window->size) {
+            window->size = 0; /* shouldn't happen, disable */
+            return NULL;
+        }
+        window->loaded = true;
+    }
+
+    return window->data + (offset - window->offset);
+}
+
+static bool read_window(PREFETCH_STREAMFILE* sf, prefetch_window_t* window, uint8_t* dst, offv_t offset, size_t length) {
+    const uint8_t* data = get_window(sf, window, offset, length);
+    if (!data)
+        return false;
+
+    memcpy(dst, data, length);
+    return true;
+}
+
+static size_t prefetch_read_internal(PREFETCH_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    if (!dst || length <= 0 || offset < 0)
+        return 0;
+
+    /* partial reads at EOF, same as other SFs */
+    if (offset >= sf->file_size)
+        return 0;
+    if (offset + length > sf->file_size)
+        length = sf->file_size - offset;
+
+    if (read_window(sf, &sf->head, dst, offset, length))
+        return length;
+    if (read_window(sf, &sf->tail, dst, offset, length))
+        return length;
+
+    /* middle or between windows */
+    sf->vt.stats.misses++;
+    return sf->inner_sf->read(sf->inner_sf, dst, offset, length);
+}
+
+static size_t prefetch_read(PREFETCH_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    size_t bytes = prefetch_read_internal(sf, dst, offset, length);
+
+    if (bytes > 0 && sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* prefetch_get_view(PREFETCH_STREAMFILE* sf, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+    const uint8_t* view;
+
+    if (offset < 0 || offset + length > sf->file_size)
+        return NULL;
+
+    view = get_window(sf, &sf->head, offset, length);
+    if (!view)
+        view = get_window(sf, &sf->tail, offset, length);
+    if (!view) {
+        sf->vt.stats.misses++;
+        view = get_streamfile_view(offset, length, sf->inner_sf);
+    }
+
+    if (view) {
+        if (sf->vt.stats.misses == misses)
+            sf->vt.stats.hits++;
+        update_streamfile_stats(&sf->vt.stats, offset, length);
+    }
+    return view;
+}
+
+static size_t prefetch_get_size(PREFETCH_STREAMFILE* sf) {
+    return sf->file_size; /* cache */
+}
+
+static offv_t prefetch_get_offset(PREFETCH_STREAMFILE* sf) {
+    return sf->inner_sf->get_offset(sf->inner_sf); /* default */
+}
+
+static void prefetch_get_name(PREFETCH_STREAMFILE* sf, char* name, size_t name_size) {
+    sf->inner_sf->get_name(sf->inner_sf, name, name_size); /* default */
+}
+
+static STREAMFILE* prefetch_open(PREFETCH_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+    return sf->inner_sf->open(sf->inner_sf, filename, buf_size); /* default (new SFs are meant for decoding) */
+}
+
+static void prefetch_close(PREFETCH_STREAMFILE* sf) {
+    sf->inner_sf->close(sf->inner_sf);
+    free(sf->head.data);
+    free(sf);
+}
+
+
+STREAMFILE* open_prefetch_streamfile(STREAMFILE* sf, size_t window_size) {
+    PREFETCH_STREAMFILE* this_sf = NULL;
+
+    if (!sf) goto fail;
+
+    if (window_size == 0)
+        window_size = STREAMFILE_DEFAULT_BUFFER_SIZE;
+
+    this_sf = calloc(1, sizeof(PREFETCH_STREAMFILE));
+    if (!this_sf) goto fail;
+
+    /* set callbacks and internals */
+    this_sf->vt.read = (void*)prefetch_read;
+    this_sf->vt.get_size = (void*)prefetch_get_size;
+    this_sf->vt.get_offset = (void*)prefetch_get_offset;
+    this_sf->vt.get_name = (void*)prefetch_get_name;
+    this_sf->vt.open = (void*)prefetch_open;
+    this_sf->vt.close = (void*)prefetch_close;
+    this_sf->vt.get_view = (void*)prefetch_get_view;
+    this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "prefetch";
+    this_sf->vt.stats_inner = sf;
+
+    this_sf->inner_sf = sf;
+    this_sf->file_size = sf->get_size(sf);
+
+    /* windows don't overlap (small files only use head) */
+    this_sf->head.offset = 0;
+    this_sf->head.size = this_sf->file_size < window_size ? this_sf->file_size : window_size;
+
+    this_sf->tail.size = this_sf->file_size - this_sf->head.size;
+    if (this_sf->tail.size > window_size)
+        this_sf->tail.size = window_size;
+    this_sf->tail.offset = this_sf->file_size - this_sf->tail.size;
+
+    if (this_sf->head.size + this_sf->tail.size > 0) {
+        this_sf->head.data = malloc(this_sf->head.size + this_sf->tail.size);
+        if (!this_sf->head.data) goto fail;
+        this_sf->tail.data = this_sf->head.data + this_sf->head.size;
+    }
+
+    return &this_sf->vt;
+
+fail:
+    free(this_sf);
+    return NULL;
+}
+
+STREAMFILE* open_prefetch_streamfile_f(STREAMFILE* sf, size_t window_size) {
+    STREAMFILE* new_sf = open_prefetch_streamfile(sf, window_size);
+    if (!new_sf)
+        close_streamfile(sf);
+    return new_sf;
+}
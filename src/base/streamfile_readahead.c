@@ -0,0 +1,286 @@
+#include "../streamfile.h"
+#include "../util/threads.h"
+#include "../util/log.h"
+
+/* Buffered STREAMFILE that reads the next buffer in a background thread once refills look predictable
+ * (double buffering), so decoding doesn't have to wait for slow IO on every refill.
+ * Besides plain sequential reads, per-channel SFs of interleaved data jump over other channels' blocks,
+ * so refill offsets are predicted from the refill before the last one (handles strides like +buf, +skip, +buf...).
+ * The inner SF is only used by one thread at a time (main thread waits for any pending read-ahead
+ * before reading itself), so it doesn't need to be thread-safe. */
+
+#define READAHEAD_MIN_PREDICTED 2 /* predicted refills in a row before reading ahead (ignores header parsing) */
+
+typedef struct {
+    STREAMFILE vt;
+
+    STREAMFILE* inner_sf;
+    offv_t offset;          /* last read offset (info) */
+    size_t file_size;
+
+    offv_t buf_offset;      /* current buffer data start */
+    uint8_t* buf;           /* current buffer */
+    size_t buf_size;        /* max buffer size (both buffers) */
+    size_t valid_size;      /* current buffer size */
+
+    /* refill pattern */
+    offv_t last_fill;       /* previous refill offset */
+    offv_t deltas[2];       /* last refill jumps ([0] = most recent) */
+    int predicted;          /* refills in a row that matched the pattern */
+
+    /* read-ahead (next_* are owned by the thread while pending) */
+    uint8_t* next_buf;
+    offv_t next_offset;
+    size_t next_size;
+    bool pending;
+    bool thread_failed;
+    bool thread_exit;
+
+    vgm_thread_t* thread;
+    vgm_sem_t* sem_request;
+    vgm_sem_t* sem_done;
+} READAHEAD_STREAMFILE;
+
+
+static void readahead_worker(void* arg) {
+    READAHEAD_STREAMFILE* sf = arg;
+
+    while (true) {
+        vgm_sem_wait(sf->sem_request);
+        if (sf->thread_exit)
+            break;
+
+        sf->next_size = sf->inner_sf->read(sf->inner_sf, sf->next_buf, sf->next_offset, sf->buf_size);
+        vgm_sem_post(sf->sem_done);
+    }
+}
+
+static bool readahead_start_thread(READAHEAD_STREAMFILE* sf) {
+    if (sf->thread)
+        return true;
+    if (sf->thread_failed)
+        return false;
+
+    sf->next_buf = malloc(sf->buf_size);
+    sf->sem_request = vgm_sem_init(0);
+    sf->sem_done = vgm_sem_init(0);
+    if (sf->next_buf && sf->sem_request && sf->sem_done) {
+        sf->thread = vgm_thread_create(readahead_worker, sf);
+    }
+
+    if (!sf->thread) {
+        /* no threads: keep working as a regular buffered SF */
+        sf->thread_failed = true;
+        free(sf->next_buf);
+        vgm_sem_free(sf->sem_request);
+        vgm_sem_free(sf->sem_done);
+        sf->next_buf = NULL;
+        sf->sem_request = NULL;
+        sf->sem_done = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/* waits for the read-ahead thread to finish, so the inner SF can be used (next_* are kept) */
+static void readahead_wait(READAHEAD_STREAMFILE* sf) {
+    if (sf->pending) {
+        vgm_sem_wait(sf->sem_done);
+        sf->pending = false;
+    }
+}
+
+/* loads buffer at offset, from the read-ahead buffer if possible */
+static void readahead_fill(READAHEAD_STREAMFILE* sf, offv_t offset) {
+    offv_t delta = offset - sf->last_fill;
+
+    readahead_wait(sf);
+
+    if (sf->next_buf && sf->next_size > 0 && offset == sf->next_offset) {
+        uint8_t* tmp = sf->buf;
+        sf->buf = sf->next_buf;
+        sf->next_buf = tmp;
+        sf->valid_size = sf->next_size; /* not a miss, refill was done in advance */
+    }
+    else {
+        sf->vt.stats.misses++;
+        sf->valid_size = sf->inner_sf->read(sf->inner_sf, sf->buf, offset, sf->buf_size);
+    }
+    sf->buf_offset = offset;
+    sf->next_size = 0;
+
+    /* matches the jump of two refills ago (also true for sequential reads where all jumps are the same) */
+    sf->predicted = (delta > 0 && delta == sf->deltas[1]) ? sf->predicted + 1 : 0;
+    sf->deltas[1] = sf->deltas[0];
+    sf->deltas[0] = delta;
+    sf->last_fill = offset;
+    if (sf->predicted < READAHEAD_MIN_PREDICTED)
+        return;
+
+    /* request next buffer */
+    offv_t next_offset = offset + sf->deltas[1];
+    if (sf->valid_size < sf->buf_size || next_offset >= sf->file_size)
+        return;
+    if (!readahead_start_thread(sf))
+        return;
+
+    sf->next_offset = next_offset;
+    sf->pending = true;
+    vgm_sem_post(sf->sem_request);
+}
+
+static size_t readahead_read_internal(READAHEAD_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    size_t read_total = 0;
+
+    if (!dst || length <= 0 || offset < 0)
+        return 0;
+
+    while (length > 0) {
+        /* is the part of the requested length in the buffer? */
+        if (offset >= sf->buf_offset && offset < sf->buf_offset + sf->valid_size) {
+            size_t buf_limit;
+            int buf_into = (int)(offset - sf->buf_offset);
+
+            buf_limit = sf->valid_size - buf_into;
+            if (buf_limit > length)
+                buf_limit = length;
+
+            memcpy(dst, sf->buf + buf_into, buf_limit);
+            read_total += buf_limit;
+            length -= buf_limit;
+            offset += buf_limit;
+            dst += buf_limit;
+            continue;
+        }
+
+        /* ignore requests at EOF */
+        if (offset >= sf->file_size) {
+            VGM_ASSERT_ONCE(offset > sf->file_size, "readahead: reading over file_size 0x%x @ 0x%x + 0x%x\n", sf->file_size, (uint32_t)offset, length);
+            break;
+        }
+
+        readahead_fill(sf, offset);
+
+        /* give up on failed reads (EOF) */
+        if (sf->valid_size == 0)
+            break;
+    }
+
+    sf->offset = offset; /* last read offset */
+    return read_total;
+}
+
+static size_t readahead_read(READAHEAD_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    size_t bytes = readahead_read_internal(sf, dst, offset, length);
+
+    if (bytes > 0 && sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* readahead_get_view(READAHEAD_STREAMFILE* sf, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    if (offset < 0 || length > sf->buf_size)
+        return NULL;
+
+    if (offset < sf->buf_offset || offset + length > sf->buf_offset + sf->valid_size) {
+        if (offset >= sf->file_size)
+            return NULL;
+        readahead_fill(sf, offset);
+        if (offset + length > sf->buf_offset + sf->valid_size)
+            return NULL; /* EOF */
+    }
+
+    if (sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, length);
+    sf->offset = offset + length;
+    return sf->buf + (offset - sf->buf_offset);
+}
+
+static size_t readahead_get_size(READAHEAD_STREAMFILE* sf) {
+    return sf->file_size; /* cache */
+}
+
+static offv_t readahead_get_offset(READAHEAD_STREAMFILE* sf) {
+    return sf->offset; /* cache */
+}
+
+static void readahead_get_name(READAHEAD_STREAMFILE* sf, char* name, size_t name_size) {
+    readahead_wait(sf);
+    sf->inner_sf->get_name(sf->inner_sf, name, name_size); /* default */
+}
+
+static STREAMFILE* readahead_open(READAHEAD_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
+    readahead_wait(sf);
+    STREAMFILE* new_inner_sf = sf->inner_sf->open(sf->inner_sf, filename, buf_size);
+    return open_readahead_streamfile_f(new_inner_sf, sf->buf_size);
+}
+
+static void readahead_close(READAHEAD_STREAMFILE* sf) {
+    if (sf->thread) {
+        readahead_wait(sf);
+        sf->thread_exit = true;
+        vgm_sem_post(sf->sem_request);
+        vgm_thread_join(sf->thread);
+    }
+    vgm_sem_free(sf->sem_request);
+    vgm_sem_free(sf->sem_done);
+
+    sf->inner_sf->close(sf->inner_sf);
+    free(sf->buf);
+    free(sf->next_buf);
+    free(sf);
+}
+
+
+STREAMFILE* open_readahead_streamfile(STREAMFILE* sf, size_t buf_size) {
+    READAHEAD_STREAMFILE* this_sf = NULL;
+
+    if (!sf) goto fail;
+
+    if (buf_size == 0)
+        buf_size = STREAMFILE_DEFAULT_BUFFER_SIZE;
+
+    this_sf = calloc(1, sizeof(READAHEAD_STREAMFILE));
+    if (!this_sf) goto fail;
+
+    /* set callbacks and internals */
+    this_sf->vt.read = (void*)readahead_read;
+    this_sf->vt.get_size = (void*)readahead_get_size;
+    this_sf->vt.get_offset = (void*)readahead_get_offset;
+    this_sf->vt.get_name = (void*)readahead_get_name;
+    this_sf->vt.open = (void*)readahead_open;
+    this_sf->vt.close = (void*)readahead_close;
+    this_sf->vt.get_view = (void*)readahead_get_view;
+    this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "readahead";
+    this_sf->vt.stats_inner = sf;
+
+    this_sf->inner_sf = sf;
+    this_sf->buf_size = buf_size;
+    this_sf->buf = malloc(buf_size);
+    if (!this_sf->buf) goto fail;
+
+    this_sf->file_size = sf->get_size(sf);
+
+    return &this_sf->vt;
+
+fail:
+    if (this_sf) free(this_sf->buf);
+    free(this_sf);
+    return NULL;
+}
+
+STREAMFILE* open_readahead_streamfile_f(STREAMFILE* sf, size_t buf_size) {
+    STREAMFILE* new_sf = open_readahead_streamfile(sf, buf_size);
+    if (!new_sf)
+        close_streamfile(sf);
+    return new_sf;
+}
@@ -2,17 +2,27 @@
 #include "../util/vgmstream_limits.h"
 #include "../util/log.h"
 #include "../util/sf_utils.h"
+#include "../util/threads.h"
 #include "../vgmstream.h"
 
 
-/* for dup/fdopen in some systems */
+/* for dup/fdopen/pread in some systems */
 #ifndef _MSC_VER
     #include <unistd.h>
+    #include <errno.h>
 #endif
 
 // for testing purposes; generally slower since reads often aren't optimized for unbuffered IO
 //#define DISABLE_BUFFER
 
+/* Reopens of the same file share a single FILE/descriptor, and reads use positional IO (pread) so each SF
+ * only keeps its own buffer. Avoids opening one descriptor per channel (or dup'ing it), and since pread doesn't
+ * touch the shared file position SFs can be read from different threads. Shared refs are atomic, so SFs of the
+ * same file may also be opened/closed from different threads (but a single SF must not be used by two at once). */
+#if defined(__unix__) || defined(__APPLE__)
+    #define USE_STDIO_PREAD 1
+#endif
+
 /* Enables a minor optimization when reopening file descriptors.
  * Some systems/compilers have issues though, and dupe'd FILEs may fread garbage data in rare cases,
  * possibly due to underlying buffers that get shared/thrashed by dup(). Seen for example in some .HPS and Ubi
@@ -20,7 +30,7 @@
  *
  * Keep it for other systems since this is (probably) kinda useful, though a more sensible approach would be
  * redoing SF/FILE/buffer handling to avoid re-opening as much. */
-#if !defined (_MSC_VER) && !defined (__ANDROID__) && !defined (__APPLE__)
+#if !defined (USE_STDIO_PREAD) && !defined (_MSC_VER) && !defined (__ANDROID__) && !defined (__APPLE__)
     #define USE_STDIO_FDUP 1
 #endif
  
@@ -89,6 +99,9 @@ typedef struct {
     STREAMFILE vt;          /* callbacks */
 
     FILE* infile;           /* actual FILE */
+#ifdef USE_STDIO_PREAD
+    int* infile_refs;       /* SFs sharing infile */
+#endif
     char name[PATH_LIMIT];  /* FILE filename */
     int name_len;           /* cache */
     offv_t offset;          /* last read offset (info) */
@@ -102,7 +115,50 @@ typedef struct {
 static STREAMFILE* open_stdio_streamfile_buffer(const char* const filename, size_t buf_size);
 static STREAMFILE* open_stdio_streamfile_buffer_by_file(FILE *infile, const char* const filename, size_t buf_size);
 
-static size_t stdio_read(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+#ifdef USE_STDIO_PREAD
+/* pread may return less than requested (signals and such), so retry until done or EOF */
+static size_t stdio_pread(FILE* infile, uint8_t* dst, size_t length, offv_t offset) {
+    int fd = fileno(infile);
+    size_t read_total = 0;
+
+    while (read_total < length) {
+        ssize_t bytes = pread(fd, dst + read_total, length - read_total, offset + read_total);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+            break;
+        read_total += bytes;
+    }
+
+    return read_total;
+}
+#endif
+
+/* refills the buffer at offset (must have infile) */
+static bool stdio_fill(STDIO_STREAMFILE* sf, offv_t offset) {
+    sf->vt.stats.misses++;
+#ifdef USE_STDIO_PREAD
+    sf->buf_offset = offset;
+    sf->valid_size = stdio_pread(sf->infile, sf->buf, sf->buf_size, offset);
+#else
+    /* position to new offset */
+    if (fseek_v(sf->infile, offset, SEEK_SET)) {
+        return false; /* this shouldn't happen in our code */
+    }
+
+#if 0
+    /* old workaround for USE_STDIO_FDUP bug, keep it here for a while as a reminder just in case */
+    //fseek_v(sf->infile, ftell_v(sf->infile), SEEK_SET);
+#endif
+
+    sf->buf_offset = offset;
+    sf->valid_size = fread(sf->buf, sizeof(uint8_t), sf->buf_size, sf->infile);
+#endif
+    //;VGM_LOG("stdio: read buf %lx + %x\n", sf->buf_offset, sf->valid_size);
+    return true;
+}
+
+static size_t stdio_read_internal(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
     size_t read_total = 0;
 
     if (/*!sf->infile ||*/ !dst || length <= 0 || offset < 0)
@@ -112,6 +168,7 @@ static size_t stdio_read(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size
     if (offset != sf->offset) {
         fseek_v(sf->infile, offset, SEEK_SET);
     }
+    sf->vt.stats.misses++;
     read_total = fread(dst, sizeof(uint8_t), length, sf->infile);
 
     sf->offset = offset + read_total;
@@ -160,20 +217,9 @@ static size_t stdio_read(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size
             break;
         }
 
-        /* position to new offset */
-        if (fseek_v(sf->infile, offset, SEEK_SET)) {
-            break; /* this shouldn't happen in our code */
-        }
-
-#if 0
-        /* old workaround for USE_STDIO_FDUP bug, keep it here for a while as a reminder just in case */
-        //fseek_v(sf->infile, ftell_v(sf->infile), SEEK_SET);
-#endif
-
         /* fill the buffer (offset now is beyond buf_offset) */
-        sf->buf_offset = offset;
-        sf->valid_size = fread(sf->buf, sizeof(uint8_t), sf->buf_size, sf->infile);
-        //;VGM_LOG("stdio: read buf %lx + %x\n", sf->buf_offset, sf->valid_size);
+        if (!stdio_fill(sf, offset))
+            break;
 
         /* decide how much must be read this time */
         if (length > sf->buf_size)
@@ -202,6 +248,43 @@ static size_t stdio_read(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size
 #endif
 }
 
+static size_t stdio_read(STDIO_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
+    int64_t misses = sf->vt.stats.misses;
+
+    size_t bytes = stdio_read_internal(sf, dst, offset, length);
+
+    if (bytes > 0 && sf->vt.stats.misses == misses)
+        sf->vt.stats.hits++;
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+
+static const uint8_t* stdio_get_view(STDIO_STREAMFILE* sf, offv_t offset, size_t length) {
+#ifdef DISABLE_BUFFER
+    return NULL;
+#else
+    if (offset < 0 || length > sf->buf_size)
+        return NULL;
+
+    if (offset < sf->buf_offset || offset + length > sf->buf_offset + sf->valid_size) {
+        /* refill, as a read would */
+        if (!sf->infile || offset >= sf->file_size)
+            return NULL;
+        if (!stdio_fill(sf, offset))
+            return NULL;
+        if (offset + length > sf->buf_offset + sf->valid_size)
+            return NULL; /* EOF */
+    }
+    else {
+        sf->vt.stats.hits++;
+    }
+
+    update_streamfile_stats(&sf->vt.stats, offset, length);
+    sf->offset = offset + length;
+    return sf->buf + (offset - sf->buf_offset);
+#endif
+}
+
 static size_t stdio_get_size(STDIO_STREAMFILE* sf) {
     return sf->file_size;
 }
@@ -222,8 +305,22 @@ static void stdio_get_name(STDIO_STREAMFILE* sf, char* name, size_t name_size) {
 static STREAMFILE* stdio_open(STDIO_STREAMFILE* sf, const char* const filename, size_t buf_size) {
     if (!filename)
         return NULL;
-
-#ifdef USE_STDIO_FDUP
+    sf->vt.stats.reopens++;
+
+#if defined(USE_STDIO_PREAD)
+    /* if same name, share the FILE we already have open (new SF only gets its own buffer) */
+    if (sf->infile && sf->infile_refs && !strcmp(sf->name, filename)) {
+        STDIO_STREAMFILE* new_sf = (STDIO_STREAMFILE*)open_stdio_streamfile_buffer_by_file(NULL, filename, buf_size);
+        if (new_sf) {
+            new_sf->infile = sf->infile;
+            new_sf->infile_refs = sf->infile_refs;
+            new_sf->file_size = sf->file_size;
+            vgm_atomic_add(new_sf->infile_refs, 1);
+            return &new_sf->vt;
+        }
+        /* on failure try the default path */
+    }
+#elif defined(USE_STDIO_FDUP)
     /* minor optimization when reopening files, see comment in #define above */
 
     /* if same name, duplicate the file descriptor we already have open */
@@ -247,9 +344,27 @@ static STREAMFILE* stdio_open(STDIO_STREAMFILE* sf, const char* const filename,
     return open_stdio_streamfile_buffer(filename, buf_size);
 }
 
+static void stdio_close_file(STDIO_STREAMFILE* sf) {
+    if (!sf->infile)
+        return;
+
+#ifdef USE_STDIO_PREAD
+    if (sf->infile_refs) {
+        if (vgm_atomic_add(sf->infile_refs, -1) > 0) {
+            sf->infile = NULL; /* still used by other SFs */
+            return;
+        }
+        free(sf->infile_refs);
+        sf->infile_refs = NULL;
+    }
+#endif
+
+    fclose(sf->infile);
+    sf->infile = NULL;
+}
+
 static void stdio_close(STDIO_STREAMFILE* sf) {
-    if (sf->infile)
-        fclose(sf->infile);
+    stdio_close_file(sf);
     free(sf->buf);
     free(sf);
 }
@@ -274,6 +389,8 @@ static STREAMFILE* open_stdio_streamfile_buffer_by_file(FILE* infile, const char
     this_sf->vt.get_name = (void*)stdio_get_name;
     this_sf->vt.open = (void*)stdio_open;
     this_sf->vt.close = (void*)stdio_close;
+    this_sf->vt.get_view = (void*)stdio_get_view;
+    this_sf->vt.stats.type = "stdio";
 
     this_sf->infile = infile;
     this_sf->buf_size = buf_size;
@@ -285,6 +402,14 @@ static STREAMFILE* open_stdio_streamfile_buffer_by_file(FILE* infile, const char
     memcpy(this_sf->name, filename, this_sf->name_len);
     this_sf->name[this_sf->name_len] = '\0';
 
+#ifdef USE_STDIO_PREAD
+    if (infile) {
+        this_sf->infile_refs = malloc(sizeof(int));
+        if (!this_sf->infile_refs) goto fail;
+        *this_sf->infile_refs = 1;
+    }
+#endif
+
     /* cache file_size */
     if (infile) {
         fseek_v(this_sf->infile, 0x00, SEEK_END);
@@ -313,15 +438,18 @@ static STREAMFILE* open_stdio_streamfile_buffer_by_file(FILE* infile, const char
 
         this_sf->buf_offset = 0;
         this_sf->valid_size = fread(this_sf->buf, sizeof(uint8_t), this_sf->file_size, this_sf->infile);
+        this_sf->vt.stats.misses++;
 
-        fclose(this_sf->infile);
-        this_sf->infile = NULL;
+        stdio_close_file(this_sf);
     }
 
     return &this_sf->vt;
 
 fail:
     free(buf);
+#ifdef USE_STDIO_PREAD
+    if (this_sf) free(this_sf->infile_refs);
+#endif
     free(this_sf);
     return NULL;
 }
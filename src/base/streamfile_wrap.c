@@ -11,7 +11,15 @@ typedef struct {
 } WRAP_STREAMFILE;
 
 static size_t wrap_read(WRAP_STREAMFILE* sf, uint8_t* dst, offv_t offset, size_t length) {
-    return sf->inner_sf->read(sf->inner_sf, dst, offset, length); /* default */
+    size_t bytes = sf->inner_sf->read(sf->inner_sf, dst, offset, length); /* default */
+    update_streamfile_stats(&sf->vt.stats, offset, bytes);
+    return bytes;
+}
+static const uint8_t* wrap_get_view(WRAP_STREAMFILE* sf, offv_t offset, size_t length) {
+    const uint8_t* view = get_streamfile_view(offset, length, sf->inner_sf); /* default */
+    if (view)
+        update_streamfile_stats(&sf->vt.stats, offset, length);
+    return view;
 }
 static size_t wrap_get_size(WRAP_STREAMFILE* sf) {
     return sf->inner_sf->get_size(sf->inner_sf); /* default */
@@ -24,6 +32,7 @@ static void wrap_get_name(WRAP_STREAMFILE* sf, char* name, size_t name_size) {
 }
 
 static STREAMFILE* wrap_open(WRAP_STREAMFILE* sf, const char* const filename, size_t buf_size) {
+    sf->vt.stats.reopens++;
     return sf->inner_sf->open(sf->inner_sf, filename, buf_size); /* default (don't call open_wrap_streamfile) */
 }
 
@@ -47,7 +56,10 @@ STREAMFILE* open_wrap_streamfile(STREAMFILE* sf) {
     this_sf->vt.get_name = (void*)wrap_get_name;
     this_sf->vt.open = (void*)wrap_open;
     this_sf->vt.close = (void*)wrap_close;
+    this_sf->vt.get_view = (void*)wrap_get_view;
     this_sf->vt.stream_index = sf->stream_index;
+    this_sf->vt.stats.type = "wrap";
+    this_sf->vt.stats_inner = sf;
 
     this_sf->inner_sf = sf;
 
@@ -2,7 +2,8 @@
 #include "../util.h"
 
 void decode_adx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int32_t frame_size, coding_t coding_type, uint32_t codec_config) {
-    uint8_t frame[0x12] = {0};
+    uint8_t frame_buf[0x12] = {0};
+    const uint8_t* frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -20,7 +21,7 @@ void decode_adx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing,
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
 
 
     scale = get_s16be(frame+0x00);
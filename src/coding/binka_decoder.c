@@ -1,12 +1,16 @@
 #include "coding.h"
 #include "../base/decode_state.h"
 #include "../base/codec_info.h"
+#include "../base/seek_table.h"
 #include "libs/binka_dec.h"
 
 // observed max is ~0x1200 in 8ch for BCF1 and ~0x900 in 2ch files for UEBA (higher encoding quality modes?)
 // (there is 32 bit field in each format for this)
 #define MAX_FRAME_SIZE_CHANNEL 0x800
 
+// min distance between seek entries added during decode (~0.3s at 48000hz; an entry per packet is overkill for long files)
+#define SEEK_ENTRY_SAMPLES 16384
+
 
 typedef struct {
     uint8_t* buf;
@@ -21,6 +25,9 @@ typedef struct {
 
     packet_t pkt;
     void* handle;
+
+    int frame_samples;
+    int32_t current_sample; // start of next packet
 } binka_codec_data;
 
 
@@ -47,6 +54,7 @@ static void* init_binka(int sample_rate, int channels, binka_mode_t mode) {
 
     frame_samples = binka_get_frame_samples(data->handle);
     if (frame_samples <= 0) goto fail;
+    data->frame_samples = frame_samples;
 
     data->pkt.buf_size = MAX_FRAME_SIZE_CHANNEL * channels;
     data->pkt.buf = calloc(data->pkt.buf_size, sizeof(uint8_t));
@@ -126,10 +134,23 @@ static bool read_frame(VGMSTREAM* v, packet_t* pkt) {
     return true;
 }
 
+// Packets have variable size and no index (UEBA's seek table isn't always present), so packet starts
+// are saved on first decode. Loops can then jump near the loop start rather than decoding from the beginning.
+static void add_seek_entry(VGMSTREAM* v) {
+    binka_codec_data* data = v->codec_data;
+
+    int32_t last_sample = seek_table_get_last_sample(v);
+    if (last_sample >= 0 && data->current_sample < last_sample + SEEK_ENTRY_SAMPLES)
+        return;
+    seek_table_add_entry(v, data->current_sample, v->ch[0].offset);
+}
+
 static bool decode_frame_binka(VGMSTREAM* v) {
     binka_codec_data* data = v->codec_data;
     decode_state_t* ds = v->decode_state;
 
+    add_seek_entry(v);
+
     bool ok = read_frame(v, &data->pkt);
     if (!ok)
         return false;
@@ -149,6 +170,7 @@ static bool decode_frame_binka(VGMSTREAM* v) {
 
     sbuf_init_f16(&ds->sbuf, data->fbuf, samples, v->channels);
     ds->sbuf.filled = samples;
+    data->current_sample += samples;
 
     return true;
 }
@@ -158,6 +180,7 @@ static void reset_binka(void* priv_data) {
     if (!data || !data->handle) return;
     
     binka_reset(data->handle);
+    data->current_sample = 0;
 }
 
 static void seek_binka(VGMSTREAM* v, int32_t num_sample) {
@@ -167,10 +190,21 @@ static void seek_binka(VGMSTREAM* v, int32_t num_sample) {
 
     reset_binka(data);
 
-    //TODO use seek table (and/or read N packets samples until target)
-    ds->discard = num_sample;
-    if (v->loop_ch) {
-        v->loop_ch[0].offset = v->loop_ch[0].channel_start_offset;
+    // after a reset the first packet has no overlap, so start at least one packet before the target
+    seek_entry_t seek = {0};
+    int32_t skip_samples = seek_table_get_entry(v, num_sample - data->frame_samples, &seek);
+    if (skip_samples >= 0) {
+        data->current_sample = seek.sample;
+        ds->discard = num_sample - seek.sample;
+        v->ch[0].offset = seek.offset;
+        if (v->loop_ch)
+            v->loop_ch[0].offset = seek.offset;
+    }
+    else {
+        ds->discard = num_sample;
+        if (v->loop_ch) {
+            v->loop_ch[0].offset = v->loop_ch[0].channel_start_offset;
+        }
     }
 }
 
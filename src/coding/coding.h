@@ -96,6 +96,8 @@ void decode_pcm8_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspac
 void decode_pcm8_unsigned(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
 void decode_pcm8_unsigned_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
 void decode_pcm8_sb(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
+bool pcm_is_frame_interleaved(VGMSTREAM* v);
+void decode_pcm_frame_interleaved(VGMSTREAM* v, sample_t* outbuf, int32_t first_sample, int32_t samples_to_do);
 void decode_pcm4(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel);
 void decode_pcm4_unsigned(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel);
 int32_t pcm_bytes_to_samples(size_t bytes, int channels, int bits_per_sample);
@@ -352,6 +354,8 @@ typedef struct {
 } hca_keytest_t;
 
 void test_hca_key(hca_codec_data* data, hca_keytest_t* hk);
+/* same as test_hca_key over each key in order (stops on a perfect score), but multithreaded */
+void test_hca_key_list(hca_codec_data* data, hca_keytest_t* hk, const uint64_t* keys, int keys_count);
 void hca_set_encryption_key(hca_codec_data* data, uint64_t keycode, uint64_t subkey);
 
 STREAMFILE* hca_get_streamfile(hca_codec_data* data);
@@ -536,6 +540,10 @@ void reset_g7221(g7221_codec_data* data);
 void free_g7221(g7221_codec_data* data);
 void set_key_g7221(g7221_codec_data* data, const uint8_t* key);
 int test_key_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf);
+#define S14_KEY_SIZE 24 /* 192-bit */
+/* Tests keys (S14_KEY_SIZE each) in threads, as if calling test_key_g7221 in order, stopping at the first perfect
+ * score. Returns index of a key better than p_best_score (updated), or -1 if none. Key must be set again after this. */
+int test_key_list_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf, const uint8_t* keys, int keys_count, int* p_best_score);
 #endif
 
 
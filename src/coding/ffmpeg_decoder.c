@@ -56,6 +56,7 @@ struct ffmpeg_codec_data {
     sfmt_t fmt;
     void* sbuf;
     int sbuf_samples;
+    void* planes[32];           // frame's planes in output order, when passed as-is
 };
 
 
@@ -827,6 +828,48 @@ static bool prepare_sbuf(ffmpeg_codec_data* data, int samples, int channels) {
     return true;
 }
 
+// planar frames that don't need conversion can be passed as-is (interleaved once when copied to the render buf)
+static bool is_passthrough_planar(ffmpeg_codec_data* data, int max_channels) {
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(59, 24, 100)
+    int channels = data->codecCtx->channels;
+#else
+    int channels = data->codecCtx->ch_layout.nb_channels;
+#endif
+    if (channels != max_channels || channels <= 1 || channels > 32)
+        return false;
+
+    switch (data->codecCtx->sample_fmt) {
+        case AV_SAMPLE_FMT_S16P:
+            return data->fmt == SFMT_S16;
+        case AV_SAMPLE_FMT_S32P:
+            return data->fmt == SFMT_S32;
+        case AV_SAMPLE_FMT_FLTP:
+            return data->fmt == SFMT_FLT && !data->invert_floats_set;
+        default:
+            return false;
+    }
+}
+
+// same swaps as remap_audio_flt, but moving whole planes
+static void set_planes(ffmpeg_codec_data* data, int channels) {
+    for (int ch = 0; ch < channels; ch++) {
+        data->planes[ch] = data->frame->extended_data[ch];
+    }
+
+    if (!data->channel_remap_set)
+        return;
+
+    for (int ch_from = 0; ch_from < channels; ch_from++) {
+        int ch_to = data->channel_remap[ch_from];
+        if (ch_to < 1 || ch_to >= 32 || ch_to > channels-1 || ch_from == ch_to)
+            continue;
+
+        void* temp = data->planes[ch_from];
+        data->planes[ch_from] = data->planes[ch_to];
+        data->planes[ch_to] = temp;
+    }
+}
+
 static bool decode_frame_ffmpeg(VGMSTREAM* v) {
     decode_state_t* ds = v->decode_state;
     ffmpeg_codec_data* data = v->codec_data;
@@ -835,14 +878,21 @@ static bool decode_frame_ffmpeg(VGMSTREAM* v) {
     if (samples < 0)
         return false;
 
-    if (!prepare_sbuf(data, samples, v->channels))
-        return false;
-    copy_samples(data, data->sbuf, samples, v->channels);
+    if (samples > 0 && is_passthrough_planar(data, v->channels)) {
+        set_planes(data, v->channels);
+        sbuf_init_planar(&ds->sbuf, data->fmt, data->planes, samples, v->channels);
+        ds->sbuf.filled = samples;
+    }
+    else {
+        if (!prepare_sbuf(data, samples, v->channels))
+            return false;
+        copy_samples(data, data->sbuf, samples, v->channels);
 
-    sbuf_init(&ds->sbuf, data->fmt, data->sbuf, samples, v->channels);
-    ds->sbuf.filled = samples;
+        sbuf_init(&ds->sbuf, data->fmt, data->sbuf, samples, v->channels);
+        ds->sbuf.filled = samples;
 
-    remap_audio(data, &ds->sbuf);
+        remap_audio(data, &ds->sbuf);
+    }
 
     if (data->samples_discard) {
         ds->discard = data->samples_discard;
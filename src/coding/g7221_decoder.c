@@ -1,4 +1,6 @@
 #include "coding.h"
+#include "../util/thread_pool.h"
+#include "../util/threads.h"
 
 #ifdef VGM_USE_G7221
 #include "libs/g7221_lib.h"
@@ -111,45 +113,47 @@ void set_key_g7221(g7221_codec_data* data, const uint8_t* key) {
 #define S14_KEY_MIN_TEST_FRAMES  3
 #define S14_KEY_MAX_TEST_FRAMES  5
 
+/* Reads test frames once, for multiple keys. Returns number of frames that can be tested (reading
+ * past those is an error, like a failed read). */
+static int read_key_frames(g7221_codec_data* data, off_t start, STREAMFILE* sf, uint8_t* frames) {
+    int max_frames = (get_streamfile_size(sf) - start) / data->frame_size;
+    if (max_frames <= 0)
+        return -1;
+
+    size_t bytes = read_streamfile(frames, start, S14_KEY_MAX_TEST_FRAMES * data->frame_size, sf);
+    return bytes / data->frame_size;
+}
+
 /* Test a number of frames to check if current key decrypts correctly.
  * Returns score: <0: error/wrong, 0: unknown/silent, >0: good (closer to 1 is better). */
-int test_key_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf) {
-    size_t test_frames = 0, current_frame = 0;
+static int test_key_score(g7221_handle* handle, const uint8_t* frames, int frame_count, int frame_size) {
+    size_t test_frames = 0;
     int total_score = 0;
-    int max_frames = (get_streamfile_size(sf) - start) / data->frame_size;
-    int cur_ch = 0;
 
-    /* assumes key was set before this call */
+    if (frame_count < 0) /* no frames */
+        return 0;
 
-    while (test_frames < S14_KEY_MAX_TEST_FRAMES && current_frame < max_frames) {
+    while (test_frames < S14_KEY_MAX_TEST_FRAMES) {
         int score, res;
-        size_t bytes;
-        uint8_t buf[G7221_MAX_FRAME_SIZE];
-
 
-        bytes = read_streamfile(buf, start, data->frame_size, sf);
-        if (bytes != data->frame_size) {
+        if (test_frames >= frame_count) {
             total_score = -1;
             break;
         }
 
-        res = g7221_decode_frame(data->ch[cur_ch].handle, buf, data->ch[cur_ch].buffer);
+        /* decoder state doesn't affect this, so one channel is enough */
+        res = g7221_test_frame(handle, frames + test_frames * frame_size);
         if (res < 0) {
             total_score = -1;
             break;
         }
 
-        /* alternate channels (decode may affect scores otherwise) */
-        cur_ch = (cur_ch + 1) % data->channels;
-
         /* good key if it decodes without error, encryption is easily detectable */
         score = 1;
 
         test_frames++;
 
         total_score += score;
-
-        start += data->frame_size;
     }
 
     /* signal best possible score (many perfect frames and few blank frames) */
@@ -157,10 +161,141 @@ int test_key_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf) {
         total_score = 1;
     }
 
-    /* clean up decoders */
-    reset_g7221(data);
-
     return total_score;
 }
 
+int test_key_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf) {
+    uint8_t frames[S14_KEY_MAX_TEST_FRAMES * G7221_MAX_FRAME_SIZE];
+
+    /* assumes key was set before this call */
+    int frame_count = read_key_frames(data, start, sf, frames);
+    return test_key_score(data->ch[0].handle, frames, frame_count, data->frame_size);
+}
+
+
+/* Key lists are tested in parallel: each job takes a range of keys with its own decoder, over test frames
+ * read once. Results are applied in list order so the chosen key is the same as testing one by one.
+ * Decoders have costly AES tables, so there are only a few jobs per thread. */
+#define S14_KEYLIST_MIN_KEYS    64
+#define S14_KEYLIST_JOBS        4 /* per thread */
+#define S14_KEYLIST_UNTESTED    -2
+
+typedef struct {
+    int frame_size;
+    const uint8_t* frames;
+    int frame_count;
+    const uint8_t* keys;
+    int keys_count;
+    int job_keys;
+    int* scores;
+
+    vgm_mutex_t* mutex;
+    int stop_index;             /* first key with a perfect score (under mutex) */
+} g7221_keylist_t;
+
+/* tests one key, returns true if next keys must stop */
+static bool keylist_test_key(g7221_keylist_t* kl, g7221_handle* handle, int index) {
+    /* expands the key once for all channels */
+    g7221_set_key(handle, kl->keys + index * S14_KEY_SIZE);
+    int score = test_key_score(handle, kl->frames, kl->frame_count, kl->frame_size);
+    kl->scores[index] = score;
+
+    if (score == 1) {
+        vgm_mutex_lock(kl->mutex);
+        if (index < kl->stop_index)
+            kl->stop_index = index;
+        vgm_mutex_unlock(kl->mutex);
+        return true;
+    }
+
+    return false;
+}
+
+static void keylist_job(void* arg, int job) {
+    g7221_keylist_t* kl = arg;
+
+    int first = job * kl->job_keys;
+    int last = first + kl->job_keys;
+    if (last > kl->keys_count)
+        last = kl->keys_count;
+
+    g7221_handle* handle = g7221_init(kl->frame_size);
+    if (!handle)
+        return; /* keys stay untested (see keylist_test_untested) */
+
+    for (int i = first; i < last; i++) {
+        vgm_mutex_lock(kl->mutex);
+        bool stop = i > kl->stop_index;
+        vgm_mutex_unlock(kl->mutex);
+        if (stop)
+            break;
+
+        if (keylist_test_key(kl, handle, i))
+            break;
+    }
+
+    g7221_free(handle);
+}
+
+/* Keys before stop_index are only left untested if their job couldn't create its decoder,
+ * so test them in order with the codec's own decoder (jobs are done at this point). */
+static void keylist_test_untested(g7221_keylist_t* kl, g7221_handle* handle) {
+    for (int i = 0; i < kl->keys_count && i <= kl->stop_index; i++) {
+        if (kl->scores[i] != S14_KEYLIST_UNTESTED)
+            continue;
+        if (keylist_test_key(kl, handle, i))
+            break;
+    }
+}
+
+int test_key_list_g7221(g7221_codec_data* data, off_t start, STREAMFILE* sf, const uint8_t* keys, int keys_count, int* p_best_score) {
+    uint8_t frames[S14_KEY_MAX_TEST_FRAMES * G7221_MAX_FRAME_SIZE];
+    g7221_keylist_t kl = {0};
+    thread_pool_t* pool = NULL;
+    int best_index = -1;
+
+    if (keys_count <= 0)
+        return -1;
+
+    kl.frame_size = data->frame_size;
+    kl.frames = frames;
+    kl.frame_count = read_key_frames(data, start, sf, frames);
+    kl.keys = keys;
+    kl.keys_count = keys_count;
+    kl.stop_index = keys_count;
+    kl.scores = malloc(keys_count * sizeof(int));
+    kl.mutex = vgm_mutex_init();
+    if (!kl.scores || !kl.mutex)
+        goto done;
+
+    for (int i = 0; i < keys_count; i++) {
+        kl.scores[i] = S14_KEYLIST_UNTESTED;
+    }
+
+    if (keys_count >= S14_KEYLIST_MIN_KEYS)
+        pool = thread_pool_get_shared();
+
+    int jobs = pool ? thread_pool_get_threads(pool) * S14_KEYLIST_JOBS : 1;
+    kl.job_keys = (keys_count + jobs - 1) / jobs;
+    jobs = (keys_count + kl.job_keys - 1) / kl.job_keys;
+    thread_pool_run(pool, keylist_job, &kl, jobs);
+    keylist_test_untested(&kl, data->ch[0].handle);
+
+    for (int i = 0; i < keys_count && i <= kl.stop_index; i++) {
+        int score = kl.scores[i];
+        if (score < 0)
+            continue;
+
+        if (*p_best_score <= 0 || (score < *p_best_score && score > 0)) {
+            *p_best_score = score;
+            best_index = i;
+        }
+    }
+
+done:
+    vgm_mutex_free(kl.mutex);
+    free(kl.scores);
+    return best_index;
+}
+
 #endif
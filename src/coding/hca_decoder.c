@@ -2,6 +2,8 @@
 #include "../base/decode_state.h"
 #include "libs/clhca.h"
 #include "../base/codec_info.h"
+#include "../util/thread_pool.h"
+#include "../util/threads.h"
 
 
 struct hca_codec_data {
@@ -9,7 +11,7 @@ struct hca_codec_data {
     clHCA_stInfo info;
 
     void* buf;
-    float* fbuf;
+    float** planes;             // decoded samples per channel (point to handle's buffers)
     int current_delay;
     unsigned int current_block;
 
@@ -32,7 +34,7 @@ void free_hca(void* priv) {
     clHCA_done(data->handle);
     free(data->handle);
     free(data->buf);
-    free(data->fbuf);
+    free(data->planes);
     free(data);
 }
 
@@ -74,8 +76,8 @@ hca_codec_data* init_hca(STREAMFILE* sf) {
     data->buf = malloc(data->info.blockSize);
     if (!data->buf) goto fail;
 
-    data->fbuf = malloc(sizeof(float) * data->info.channelCount * data->info.samplesPerBlock);
-    if (!data->fbuf) goto fail;
+    data->planes = calloc(data->info.channelCount, sizeof(float*));
+    if (!data->planes) goto fail;
 
     /* load streamfile for reads */
     data->sf = reopen_streamfile(sf, 0);
@@ -130,10 +132,11 @@ static bool decode_frame_hca(VGMSTREAM* v) {
         return false;
     }
 
-    clHCA_ReadSamples(data->handle, data->fbuf);
+    /* planar output, interleaved once when copied to the render buf */
+    clHCA_GetSamplesPlanar(data->handle, data->planes);
 
     int samples = data->info.samplesPerBlock;
-    sbuf_init_flt(&ds->sbuf, data->fbuf, samples, v->channels);
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, (void**)data->planes, samples, data->info.channelCount);
     ds->sbuf.filled = samples;
 
     if (data->current_delay) {
@@ -197,9 +200,24 @@ STREAMFILE* hca_get_streamfile(hca_codec_data* data) {
 #define HCA_KEY_MAX_FRAME_SCORE  600
 #define HCA_KEY_MAX_TOTAL_SCORE  (HCA_KEY_MAX_TEST_FRAMES * 50 * HCA_KEY_SCORE_SCALE)
 
+static void set_encryption_key(void* handle, uint64_t keycode, uint64_t subkey) {
+    if (subkey) {
+        keycode = keycode * ( ((uint64_t)subkey << 16u) | ((uint16_t)~subkey + 2u) );
+    }
+    clHCA_SetKey(handle, (unsigned long long)keycode);
+}
+
+/* frames to test a key, preloaded in memory for multiple keys (buf is modified when testing) */
+typedef struct {
+    void* handle;
+    uint8_t* buf;
+    const uint8_t* frames;  /* from first tested frame, NULL = read from sf */
+    int frame_count;
+} hca_keytest_frames_t;
+
 /* Test a number of frames if key decrypts correctly.
  * Returns score: <0: error/wrong, 0: unknown/silent file, >0: good (the closest to 1 the better). */
-static int test_hca_score(hca_codec_data* data, hca_keytest_t* hk) {
+static int test_hca_score(hca_codec_data* data, hca_keytest_frames_t* tf, hca_keytest_t* hk) {
     size_t test_frames = 0, current_frame = 0, blank_frames = 0;
     int total_score = 0;
     const unsigned int block_size = data->info.blockSize;
@@ -212,7 +230,14 @@ static int test_hca_score(hca_codec_data* data, hca_keytest_t* hk) {
      * Buffered IO seems fast enough (not very different reading a large block once vs frame by frame).
      * clHCA_TestBlock could be optimized a bit more. */
 
-    hca_set_encryption_key(data, hk->key, hk->subkey);
+    set_encryption_key(tf->handle, hk->key, hk->subkey);
+
+    /* first non-blank frame is known after the first key, and most wrong keys fail there: discard them
+     * with a partial test to avoid the full frame checks (gives the same result) */
+    if (hk->start_offset && tf->frames && tf->frame_count > 0) {
+        if (clHCA_TestBlockQuick(tf->handle, tf->frames, block_size) < 0)
+            return -1;
+    }
 
     /* Test up to N non-blank frames or until total frames. */
     /* A final score of 0 (=silent) is only possible for short files with all blank frames */
@@ -222,14 +247,23 @@ static int test_hca_score(hca_codec_data* data, hca_keytest_t* hk) {
         size_t bytes;
 
         /* read and test frame */
-        bytes = read_streamfile(data->buf, offset, block_size, data->sf);
+        if (tf->frames) {
+            bytes = 0;
+            if (current_frame < tf->frame_count) {
+                memcpy(tf->buf, tf->frames + current_frame * block_size, block_size);
+                bytes = block_size;
+            }
+        }
+        else {
+            bytes = read_streamfile(tf->buf, offset, block_size, data->sf);
+        }
         if (bytes != block_size) {
             /* normally this shouldn't happen, but pre-fetch ACB stop with frames in half, so just keep score */
             //total_score = -1; 
             break;
         }
 
-        score = clHCA_TestBlock(data->handle, data->buf, block_size);
+        score = clHCA_TestBlock(tf->handle, tf->buf, block_size);
 
         /* get first non-blank frame */
         if (!hk->start_offset && score != 0) {
@@ -273,15 +307,11 @@ static int test_hca_score(hca_codec_data* data, hca_keytest_t* hk) {
         total_score = 1;
     }
 
-    clHCA_DecodeReset(data->handle);
+    clHCA_DecodeReset(tf->handle);
     return total_score;
 }
 
-void test_hca_key(hca_codec_data* data, hca_keytest_t* hk) {
-    int score;
-
-    score = test_hca_score(data, hk);
-
+static void update_hca_key(hca_keytest_t* hk, int score) {
     //;VGM_LOG("HCA: test key=%08x%08x, subkey=%04x, score=%i\n",
     //        (uint32_t)((hk->key >> 32) & 0xFFFFFFFF), (uint32_t)(hk->key & 0xFFFFFFFF), hk->subkey, score);
 
@@ -296,11 +326,191 @@ void test_hca_key(hca_codec_data* data, hca_keytest_t* hk) {
     }
 }
 
-void hca_set_encryption_key(hca_codec_data* data, uint64_t keycode, uint64_t subkey) {
-    if (subkey) {
-        keycode = keycode * ( ((uint64_t)subkey << 16u) | ((uint16_t)~subkey + 2u) );
+void test_hca_key(hca_codec_data* data, hca_keytest_t* hk) {
+    hca_keytest_frames_t tf = {
+        .handle = data->handle,
+        .buf = data->buf,
+    };
+
+    int score = test_hca_score(data, &tf, hk);
+    update_hca_key(hk, score);
+}
+
+
+/* Key lists are tested in parallel: each job takes a range of keys with its own copy of the (POD) clHCA handle,
+ * over test frames read once. Results are applied in list order so the chosen key is the same as testing one
+ * by one: keys after a perfect one are skipped, and since the first key that finds a non-blank frame changes
+ * where next keys start testing, keys after it are tested again from there. */
+#define HCA_KEYLIST_MIN_KEYS    64
+#define HCA_KEYLIST_JOB_KEYS    16
+#define HCA_KEYLIST_MAX_FRAMES  0x1000000 /* for huge blocks (not normally used) */
+#define HCA_KEYLIST_UNTESTED    -2
+
+typedef struct {
+    hca_codec_data* data;
+    hca_keytest_t hk;           /* base config */
+    const uint64_t* keys;
+    int keys_count;
+    int* scores;
+    uint32_t* start_offsets;
+    const uint8_t* frames;
+    int frame_count;
+
+    vgm_mutex_t* mutex;
+    int stop_index;             /* first key with a perfect score or new start_offset (under mutex) */
+} hca_keylist_t;
+
+static bool keylist_is_stopped(hca_keylist_t* kl, int index) {
+    vgm_mutex_lock(kl->mutex);
+    bool stop = index > kl->stop_index;
+    vgm_mutex_unlock(kl->mutex);
+    return stop;
+}
+
+/* tests one key, returns true if next keys must stop */
+static bool keylist_test_key(hca_keylist_t* kl, hca_keytest_frames_t* tf, int index) {
+    hca_keytest_t hk = kl->hk;
+    hk.key = kl->keys[index];
+    int score = test_hca_score(kl->data, tf, &hk);
+    kl->scores[index] = score;
+    kl->start_offsets[index] = hk.start_offset;
+
+    if (score == 1 || hk.start_offset != kl->hk.start_offset) {
+        vgm_mutex_lock(kl->mutex);
+        if (index < kl->stop_index)
+            kl->stop_index = index;
+        vgm_mutex_unlock(kl->mutex);
+        return true;
+    }
+
+    return false;
+}
+
+static void keylist_job(void* arg, int job) {
+    hca_keylist_t* kl = arg;
+    hca_codec_data* data = kl->data;
+
+    int first = job * HCA_KEYLIST_JOB_KEYS;
+    int last = first + HCA_KEYLIST_JOB_KEYS;
+    if (last > kl->keys_count)
+        last = kl->keys_count;
+
+    hca_keytest_frames_t tf = {
+        .frames = kl->frames,
+        .frame_count = kl->frame_count,
+    };
+    tf.handle = malloc(clHCA_sizeof());
+    tf.buf = malloc(data->info.blockSize);
+    if (!tf.handle || !tf.buf)
+        goto done; /* keys stay untested (see keylist_test_untested) */
+    memcpy(tf.handle, data->handle, clHCA_sizeof());
+
+    for (int i = first; i < last; i++) {
+        if (keylist_is_stopped(kl, i))
+            break;
+        if (keylist_test_key(kl, &tf, i))
+            break;
+    }
+
+done:
+    free(tf.handle);
+    free(tf.buf);
+}
+
+/* Keys before stop_index are only left untested if their job couldn't allocate its handle copy,
+ * so test them in order on the shared handle (jobs are done at this point). */
+static void keylist_test_untested(hca_keylist_t* kl) {
+    hca_keytest_frames_t tf = {
+        .handle = kl->data->handle,
+        .buf = kl->data->buf,
+        .frames = kl->frames,
+        .frame_count = kl->frame_count,
+    };
+
+    for (int i = 0; i < kl->keys_count && i <= kl->stop_index; i++) {
+        if (kl->scores[i] != HCA_KEYLIST_UNTESTED)
+            continue;
+        if (keylist_test_key(kl, &tf, i))
+            break;
+    }
+}
+
+void test_hca_key_list(hca_codec_data* data, hca_keytest_t* hk, const uint64_t* keys, int keys_count) {
+    hca_keylist_t kl = {0};
+    uint8_t* frames = NULL;
+    thread_pool_t* pool = NULL;
+    int pos = 0;
+
+    if (keys_count < HCA_KEYLIST_MIN_KEYS)
+        goto fallback;
+
+    /* max frames a test may read */
+    const unsigned int block_size = data->info.blockSize;
+    int frame_count = HCA_KEY_MAX_SKIP_BLANKS + HCA_KEY_MAX_TEST_FRAMES;
+    if (frame_count > data->info.blockCount)
+        frame_count = data->info.blockCount;
+    if (frame_count * block_size > HCA_KEYLIST_MAX_FRAMES)
+        goto fallback;
+
+    frames = malloc(frame_count * block_size);
+    kl.scores = malloc(keys_count * sizeof(int));
+    kl.start_offsets = malloc(keys_count * sizeof(uint32_t));
+    kl.mutex = vgm_mutex_init();
+    if (!frames || !kl.scores || !kl.start_offsets || !kl.mutex)
+        goto fallback;
+
+    pool = thread_pool_get_shared();
+
+    while (pos < keys_count) {
+        uint32_t offset = hk->start_offset ? hk->start_offset : data->info.headerSize;
+        size_t bytes = read_streamfile(frames, offset, frame_count * block_size, data->sf);
+
+        kl.data = data;
+        kl.hk = *hk;
+        kl.keys = keys + pos;
+        kl.keys_count = keys_count - pos;
+        kl.frames = frames;
+        kl.frame_count = bytes / block_size;
+        kl.stop_index = kl.keys_count;
+        for (int i = 0; i < kl.keys_count; i++) {
+            kl.scores[i] = HCA_KEYLIST_UNTESTED;
+            kl.start_offsets[i] = hk->start_offset;
+        }
+
+        int jobs = (kl.keys_count + HCA_KEYLIST_JOB_KEYS - 1) / HCA_KEYLIST_JOB_KEYS;
+        thread_pool_run(pool, keylist_job, &kl, jobs);
+        keylist_test_untested(&kl);
+
+        for (int i = 0; i < kl.keys_count && i <= kl.stop_index; i++) {
+            hk->key = kl.keys[i];
+            update_hca_key(hk, kl.scores[i]);
+        }
+
+        if (kl.stop_index >= kl.keys_count)
+            break;
+        hk->start_offset = kl.start_offsets[kl.stop_index];
+        if (hk->best_score == 1)
+            break;
+        pos += kl.stop_index + 1;
+    }
+    goto done;
+
+fallback:
+    for (; pos < keys_count; pos++) {
+        hk->key = keys[pos];
+        test_hca_key(data, hk);
+        if (hk->best_score == 1)
+            break;
     }
-    clHCA_SetKey(data->handle, (unsigned long long)keycode);
+done:
+    vgm_mutex_free(kl.mutex);
+    free(kl.scores);
+    free(kl.start_offsets);
+    free(frames);
+}
+
+void hca_set_encryption_key(hca_codec_data* data, uint64_t keycode, uint64_t subkey) {
+    set_encryption_key(data->handle, keycode, subkey);
 }
 
 const codec_info_t hca_decoder = {
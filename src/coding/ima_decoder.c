@@ -23,21 +23,26 @@ static inline int _clamp_s32(int value, int min, int max) {
 }
 
 
+/* step sizes, as an X-macro so the expand tables below can be derived from them */
+#define IMA_STEP_SIZES(X) \
+    X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) \
+    X(16) X(17) X(19) X(21) X(23) X(25) X(28) X(31) \
+    X(34) X(37) X(41) X(45) X(50) X(55) X(60) X(66) \
+    X(73) X(80) X(88) X(97) X(107) X(118) X(130) X(143) \
+    X(157) X(173) X(190) X(209) X(230) X(253) X(279) X(307) \
+    X(337) X(371) X(408) X(449) X(494) X(544) X(598) X(658) \
+    X(724) X(796) X(876) X(963) X(1060) X(1166) X(1282) X(1411) \
+    X(1552) X(1707) X(1878) X(2066) X(2272) X(2499) X(2749) X(3024) \
+    X(3327) X(3660) X(4026) X(4428) X(4871) X(5358) X(5894) X(6484) \
+    X(7132) X(7845) X(8630) X(9493) X(10442) X(11487) X(12635) X(13899) \
+    X(15289) X(16818) X(18500) X(20350) X(22385) X(24623) X(27086) X(29794) \
+    X(32767) \
+    X(0) /* garbage value for Ubisoft IMA (see blocked_ubi_sce.c) */
+
+#define IMA_STEP(step) step,
+
 static const int16_t ima_step_size_table[89+1] = {
-    7, 8, 9, 10, 11, 12, 13, 14,
-    16, 17, 19, 21, 23, 25, 28, 31,
-    34, 37, 41, 45, 50, 55, 60, 66,
-    73, 80, 88, 97, 107, 118, 130, 143,
-    157, 173, 190, 209, 230, 253, 279, 307,
-    337, 371, 408, 449, 494, 544, 598, 658,
-    724, 796, 876, 963, 1060, 1166, 1282, 1411,
-    1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
-    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
-    7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
-    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
-    32767,
-
-    0 /* garbage value for Ubisoft IMA (see blocked_ubi_sce.c) */
+    IMA_STEP_SIZES(IMA_STEP)
 };
 
 static const int8_t ima_index_table[16] = {
@@ -45,27 +50,108 @@ static const int8_t ima_index_table[16] = {
     -1, -1, -1, -1, 2, 4, 6, 8 
 };
 
+/* Pre-calculated deltas per step index and code, so expanding a nibble is just a table lookup
+ * (the bit tests of the original expansion are mostly unpredictable branches). */
 
-/* Original IMA expansion, using shift+ADDs to avoid MULs (slow back then) */
-static void std_ima_expand_nibble_data(uint8_t byte, int shift, int32_t* hist1, int32_t* index) {
-    int code, sample, step, delta;
+/* Original IMA expansion, using shift+ADDs to avoid MULs (slow back then).
+ * simplified through math from:
+ *  - diff = (code + 1/2) * (step / 4)
+ *   > diff = ((step * nibble) + (step / 2)) / 4
+ *    > diff = (step * nibble / 4) + (step / 8)
+ * final diff = [signed] (step / 8) + (step / 4) + (step / 2) + (step) [when code = 4+2+1] */
+#define IMA_DELTA(s, c) \
+    ((((s) >> 3) + ((c) & 1 ? (s) >> 2 : 0) + ((c) & 2 ? (s) >> 1 : 0) + ((c) & 4 ? (s) : 0)) * ((c) & 8 ? -1 : 1))
 
-    /* simplified through math from:
-     *  - diff = (code + 1/2) * (step / 4)
-     *   > diff = ((step * nibble) + (step / 2)) / 4
-     *    > diff = (step * nibble / 4) + (step / 8)
-     * final diff = [signed] (step / 8) + (step / 4) + (step / 2) + (step) [when code = 4+2+1] */
+/* Original IMA expansion, but using MULs rather than shift+ADDs (faster for newer processors).
+ * There is minor rounding difference between ADD and MUL expansions, noticeable/propagated in non-headered IMAs.
+ * simplified through math from:
+ *  - diff = (code + 1/2) * (step / 4)
+ *   > diff = (code + 1/2) * step) / 4) * (2 / 2)
+ *    > diff = (code + 1/2) * 2 * step / 8
+ * final diff = [signed] ((code * 2 + 1) * step) / 8 */
+#define IMA_DELTA_MUL(s, c) \
+    (((((c) & 7) * 2 + 1) * (s) >> 3) * ((c) & 8 ? -1 : 1))
+
+#define IMA_DELTA_ROW(step) { \
+    IMA_DELTA(step, 0),  IMA_DELTA(step, 1),  IMA_DELTA(step, 2),  IMA_DELTA(step, 3), \
+    IMA_DELTA(step, 4),  IMA_DELTA(step, 5),  IMA_DELTA(step, 6),  IMA_DELTA(step, 7), \
+    IMA_DELTA(step, 8),  IMA_DELTA(step, 9),  IMA_DELTA(step, 10), IMA_DELTA(step, 11), \
+    IMA_DELTA(step, 12), IMA_DELTA(step, 13), IMA_DELTA(step, 14), IMA_DELTA(step, 15) },
+
+#define IMA_DELTA_MUL_ROW(step) { \
+    IMA_DELTA_MUL(step, 0),  IMA_DELTA_MUL(step, 1),  IMA_DELTA_MUL(step, 2),  IMA_DELTA_MUL(step, 3), \
+    IMA_DELTA_MUL(step, 4),  IMA_DELTA_MUL(step, 5),  IMA_DELTA_MUL(step, 6),  IMA_DELTA_MUL(step, 7), \
+    IMA_DELTA_MUL(step, 8),  IMA_DELTA_MUL(step, 9),  IMA_DELTA_MUL(step, 10), IMA_DELTA_MUL(step, 11), \
+    IMA_DELTA_MUL(step, 12), IMA_DELTA_MUL(step, 13), IMA_DELTA_MUL(step, 14), IMA_DELTA_MUL(step, 15) },
+
+static const int32_t ima_delta_table[89+1][16] = {
+    IMA_STEP_SIZES(IMA_DELTA_ROW)
+};
 
-    code = (byte >> shift) & 0xf;
-    sample = *hist1; /* predictor value */
-    step = ima_step_size_table[*index]; /* current step */
+static const int32_t ima_delta_mul_table[89+1][16] = {
+    IMA_STEP_SIZES(IMA_DELTA_MUL_ROW)
+};
 
-    delta = step >> 3;
-    if (code & 1) delta += step >> 2;
-    if (code & 2) delta += step >> 1;
-    if (code & 4) delta += step;
-    if (code & 8) delta = -delta;
-    sample += delta;
+
+/* Most IMAs read nibbles all over a frame (or several), so data is read in bulk and nibbles are
+ * taken from memory, rather than doing a streamfile read per nibble. Callers set the end of the data
+ * they'll need (reads don't go past it), and bytes that can't be read (EOF) are 0xFF like read_u8. */
+#define IMA_BUF_SIZE 0x800
+
+typedef struct {
+    STREAMFILE* sf;
+    off_t end;
+    off_t offset;           /* current data start */
+    size_t size;            /* current data size */
+    const uint8_t* data;    /* streamfile's view or buf */
+    uint8_t buf[IMA_BUF_SIZE];
+} ima_reader_t;
+
+static void ima_reader_init(ima_reader_t* r, STREAMFILE* sf, off_t end) {
+    r->sf = sf;
+    r->end = end;
+    r->offset = 0;
+    r->size = 0;
+    r->data = r->buf;
+}
+
+static void ima_reader_fill(ima_reader_t* r, off_t offset) {
+    size_t size = IMA_BUF_SIZE;
+    if (offset < r->end && r->end - offset < size)
+        size = r->end - offset;
+
+    const uint8_t* view = get_streamfile_view(offset, size, r->sf);
+    if (view) {
+        r->data = view;
+    }
+    else {
+        size_t bytes = read_streamfile(r->buf, offset, size, r->sf);
+        if (bytes < size)
+            memset(r->buf + bytes, 0xFF, size - bytes);
+        r->data = r->buf;
+    }
+
+    r->offset = offset;
+    r->size = size;
+}
+
+static inline uint8_t ima_reader_get(ima_reader_t* r, off_t offset) {
+    if ((uint64_t)(offset - r->offset) >= r->size)
+        ima_reader_fill(r, offset);
+    return r->data[offset - r->offset];
+}
+
+
+/* end of data needed for nibbles up to end_sample (stereo: one byte per sample, mono: two nibbles per byte) */
+static inline off_t ima_nibbles_end(off_t offset, int32_t end_sample, bool is_stereo) {
+    return offset + (is_stereo ? end_sample : (end_sample + 1) / 2);
+}
+
+
+/* Original IMA expansion (see IMA_DELTA), shared by most variants */
+static inline void std_ima_expand_nibble(uint8_t byte, int shift, int32_t* hist1, int32_t* index) {
+    int code = (byte >> shift) & 0xf;
+    int sample = *hist1 + ima_delta_table[*index][code];
 
     *hist1 = clamp16(sample);
     *index += ima_index_table[code];
@@ -73,63 +159,88 @@ static void std_ima_expand_nibble_data(uint8_t byte, int shift, int32_t* hist1,
     if (*index > 88) *index = 88;
 }
 
-static void std_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
-    uint8_t byte = read_u8(byte_offset,stream->streamfile);
-    std_ima_expand_nibble_data(byte, nibble_shift, hist1, step_index);
+/* Original IMA expansion with MULs (see IMA_DELTA_MUL) */
+static inline void std_ima_expand_nibble_mul(uint8_t byte, int shift, int32_t* hist1, int32_t* index) {
+    int code = (byte >> shift) & 0xf;
+    int sample = *hist1 + ima_delta_mul_table[*index][code];
+
+    *hist1 = clamp16(sample);
+    *index += ima_index_table[code];
+    if (*index < 0) *index = 0;
+    if (*index > 88) *index = 88;
 }
 
-/* Apple's IMA variation. Exactly the same except it uses 16b history (probably more sensitive to overflow/sign extend?) */
-static void std_ima_expand_nibble_16(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int16_t * hist1, int32_t * step_index) {
-    int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
-    sample_decoded = *hist1;
-    step = ima_step_size_table[*step_index];
-
-    delta = step >> 3;
-    if (sample_nibble & 1) delta += step >> 2;
-    if (sample_nibble & 2) delta += step >> 1;
-    if (sample_nibble & 4) delta += step;
-    if (sample_nibble & 8) delta = -delta;
-    sample_decoded += delta;
+/* Nibble layout of one channel's data, enough to describe most standard IMA variants:
+ * nibbles come in groups of N (2 per byte), and each group starts 'stride' bytes after the previous one
+ * (ex. MS-IMA: groups of 8 nibbles every 4*channels bytes). Groups of 1 are one nibble per byte,
+ * for stereo modes where each byte holds a nibble of both channels. */
+typedef struct {
+    off_t offset;       /* first data byte */
+    int group_nibbles;
+    int group_stride;
+    int shift_even;     /* shift for even/odd nibbles in a group (high or low nibble first) */
+    int shift_odd;
+    bool mul;           /* expand with IMA_DELTA_MUL */
+} ima_layout_t;
+
+static inline ima_layout_t ima_layout(off_t offset, int group_nibbles, int group_stride, bool high_first) {
+    ima_layout_t l = {0};
+    l.offset = offset;
+    l.group_nibbles = group_nibbles;
+    l.group_stride = group_stride;
+    l.shift_even = high_first ? 4 : 0;
+    l.shift_odd  = high_first ? 0 : 4;
+    return l;
+}
 
-    *hist1 = clamp16(sample_decoded); /* no need for this, actually */
-    *step_index += ima_index_table[sample_nibble];
-    if (*step_index < 0) *step_index=0;
-    if (*step_index > 88) *step_index=88;
+/* one nibble per byte, fixed shift */
+static inline ima_layout_t ima_layout_stereo(off_t offset, int shift) {
+    ima_layout_t l = ima_layout(offset, 1, 1, false);
+    l.shift_even = shift;
+    l.shift_odd = shift;
+    return l;
 }
 
-/* Original IMA expansion, but using MULs rather than shift+ADDs (faster for newer processors).
- * There is minor rounding difference between ADD and MUL expansions, noticeable/propagated in non-headered IMAs. */
-static void std_ima_expand_nibble_mul(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
-    int sample_nibble, sample_decoded, step, delta;
+/* Shared kernel for standard IMA: expands nibbles [start, end) of the layout, writing samples from
+ * out_start on (earlier nibbles only advance hist/step). Returns samples written. */
+static inline int ima_decode_nibbles(ima_reader_t* r, const ima_layout_t* l, int32_t start, int32_t end, int32_t out_start,
+        sample_t* outbuf, int channelspacing, int32_t* hist1, int32_t* step_index) {
+    int samples_done = 0;
 
-    /* simplified through math from:
-     *  - diff = (code + 1/2) * (step / 4)
-     *   > diff = (code + 1/2) * step) / 4) * (2 / 2)
-     *    > diff = (code + 1/2) * 2 * step / 8
-     * final diff = [signed] ((code * 2 + 1) * step) / 8 */
+    for (int32_t n = start; n < end; n++) {
+        off_t byte_offset = l->offset + (n / l->group_nibbles) * l->group_stride + (n % l->group_nibbles) / 2;
+        int nibble_shift = (n & 1) ? l->shift_odd : l->shift_even;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
-    sample_decoded = *hist1;
-    step = ima_step_size_table[*step_index];
+        if (l->mul)
+            std_ima_expand_nibble_mul(ima_reader_get(r, byte_offset), nibble_shift, hist1, step_index);
+        else
+            std_ima_expand_nibble(ima_reader_get(r, byte_offset), nibble_shift, hist1, step_index);
 
-    delta = (sample_nibble & 0x7);
-    delta = ((delta * 2 + 1) * step) >> 3;
-    if (sample_nibble & 8) delta = -delta;
-    sample_decoded += delta;
+        if (n >= out_start) {
+            outbuf[samples_done * channelspacing] = (short)(*hist1);
+            samples_done++;
+        }
+    }
 
-    *hist1 = clamp16(sample_decoded);
-    *step_index += ima_index_table[sample_nibble];
-    if (*step_index < 0) *step_index=0;
-    if (*step_index > 88) *step_index=88;
+    return samples_done;
+}
+
+/* XBOX-IMA style frames: sample 0 is the header sample, so sample N is nibble N-1 (last nibble is skipped) */
+static inline void ima_decode_xbox_nibbles(ima_reader_t* r, const ima_layout_t* l, int block_samples, int32_t first_sample, int32_t samples_to_do,
+        sample_t* outbuf, int channelspacing, int32_t* hist1, int32_t* step_index) {
+    int32_t end = first_sample + samples_to_do;
+    if (end > block_samples)
+        end = block_samples;
+
+    ima_decode_nibbles(r, l, first_sample - 1, end - 1, first_sample - 1, outbuf, channelspacing, hist1, step_index);
 }
 
 /* Camelot IMA (Mario Golf, Mario Tennis; maybe other Camelot games) */
-static void camelot_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void camelot_ima_expand_nibble(uint8_t byte, int shift, int32_t* hist1, int32_t* step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -149,10 +260,10 @@ static void camelot_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offs
 /* The Incredibles PC, updates step_index before doing current sample, reverse engineered from the .exe
  * (has no apparent name, files are raw data with .WAV extension but are inside a 'SNDS' folder).
  * A few voices show slight drifting but tables and algo look fine, encoder issue? */
-static void snds_ima_expand_nibble(VGMSTREAMCHANNEL* stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void snds_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample, step, delta;
 
-    uint8_t code = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    uint8_t code = (byte >> shift) & 0xf;
     sample = *hist1;
 
     int code_pos = code & 7;
@@ -170,10 +281,10 @@ static void snds_ima_expand_nibble(VGMSTREAMCHANNEL* stream, off_t byte_offset,
 }
 
 /* Omikron: The Nomad Soul, algorithm from the .exe */
-static void otns_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void otns_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -192,10 +303,10 @@ static void otns_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset,
 }
 
 /* Fairly OddParents (PC) .WV6: minor variation, reverse engineered from the .exe */
-static void wv6_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void wv6_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -211,10 +322,10 @@ static void wv6_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset,
 }
 
 /* High Voltage variation, reverse engineered from .exes [Lego Racers (PC), NBA Hangtime (PC)] */
-static void hv_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void hv_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -230,10 +341,10 @@ static void hv_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, i
 }
 
 /* FFTA2 IMA, different hist and sample rounding, reverse engineered from the ROM */
-static void ffta2_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index, int16_t *out_sample) {
+static void ffta2_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index, int16_t *out_sample) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf; /* ADPCM code */
+    sample_nibble = (byte >> shift) & 0xf; /* ADPCM code */
     sample_decoded = *hist1; /* predictor value */
     step = ima_step_size_table[*step_index] * 0x100; /* current step (table in ROM is pre-multiplied though) */
 
@@ -259,10 +370,10 @@ static void ffta2_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset
 }
 
 /* Yet another IMA expansion, from the exe */
-static void blitz_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void blitz_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift)&0xf; /* ADPCM code */
+    sample_nibble = (byte >> shift) & 0xf; /* ADPCM code */
     sample_decoded = *hist1; /* predictor value */
     step = ima_step_size_table[*step_index]; /* current step */
 
@@ -289,10 +400,10 @@ static const int CIMAADPCM_INDEX_TABLE[16] = {8,  6,  4,  2,  -1, -1, -1, -1,
                                              -1, -1, -1, -1, 2,  4,  6,  8};
 
 /* Capcom's MT Framework modified IMA, reverse engineered from the exe */
-static void mtf_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void mtf_ima_expand_nibble(uint8_t byte, int shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_u8(byte_offset,stream->streamfile) >> nibble_shift) & 0xf;
+    sample_nibble = (byte >> shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -367,7 +478,6 @@ static void cd_ima_expand_nibble(uint8_t byte, int shift, int32_t* hist1, int32_
  * Configurable: stereo or mono/interleave nibbles, and high or low nibble first.
  * For vgmstream, low nibble is called "IMA ADPCM" and high nibble is "DVI IMA ADPCM" (same thing though). */
 void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, int is_stereo, int is_high_first) {
-    int i, sample_count = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -377,18 +487,17 @@ void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
     if (step_index < 0) step_index=0;
     if (step_index > 88) step_index=88;
 
-    /* decode nibbles (layout: varies) */
-    for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
-        off_t byte_offset = is_stereo ?
-                stream->offset + i :    /* stereo: one nibble per channel */
-                stream->offset + i/2;   /* mono: consecutive nibbles */
-        int nibble_shift = is_high_first ?
-                is_stereo ? (!(channel&1) ? 4:0) : (!(i&1) ? 4:0) : /* even = high, odd = low */
-                is_stereo ? (!(channel&1) ? 0:4) : (!(i&1) ? 0:4);  /* even = low, odd = high */
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, is_stereo));
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    /* decode nibbles (layout: varies) */
+    int stereo_shift = is_high_first ?
+            (!(channel&1) ? 4:0) :  /* even = high, odd = low */
+            (!(channel&1) ? 0:4);   /* even = low, odd = high */
+    ima_layout_t l = is_stereo ?
+            ima_layout_stereo(stream->offset, stereo_shift) :   /* stereo: one nibble per channel */
+            ima_layout(stream->offset, 2, 1, is_high_first);    /* mono: consecutive nibbles */
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -405,6 +514,9 @@ void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
     if (step_index < 0) step_index=0;
     if (step_index > 88) step_index=88;
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, is_stereo));
+
     /* decode nibbles (layout: varies) */
     for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         off_t byte_offset = is_stereo ?
@@ -414,7 +526,7 @@ void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
                 ((channel&1) ? 0:4) :
                 ((i&1) ? 0:4);
 
-        mtf_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        mtf_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = clamp16(hist1 >> 4);
     }
 
@@ -431,11 +543,14 @@ void decode_camelot_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, false));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?4:0); //low nibble order
 
-        camelot_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        camelot_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -449,27 +564,25 @@ void decode_camelot_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
  * Sample 0 of each block is the predictor emitted verbatim; later samples expand one nibble
  * each (low nibble first), using the standard IMA tables. */
 void decode_cf_df_ima(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
     //external interleave (blocked)
 
     //per-block header read externally; sample 0 of the block is the predictor
+    if (first_sample == 0) {
+        outbuf[0] = (short)hist1; /* predictor verbatim */
+        outbuf += channelspacing;
+        first_sample++;
+        samples_to_do--;
+    }
 
-    for (i = first_sample, sample_count = 0; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
-        if (i == 0) {
-            outbuf[sample_count] = (short)hist1; /* predictor verbatim */
-            continue;
-        }
-
-        int nibble_idx = i - 1;
-        off_t byte_offset = stream->offset + nibble_idx / 2;
-        int nibble_shift = (nibble_idx & 1 ? 4 : 0); //low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do - 1, false));
 
-        std_ima_expand_nibble(stream, byte_offset, nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)hist1;
-    }
+    //nibble N is sample N+1, low nibble first
+    ima_layout_t l = ima_layout(stream->offset, 2, 1, false);
+    ima_decode_nibbles(&r, &l, first_sample - 1, first_sample + samples_to_do - 1, first_sample - 1, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -485,6 +598,9 @@ void decode_snds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, is_stereo));
+
     int sample_count = 0;
     for (int i = first_sample; i < first_sample + samples_to_do; i++) {
         off_t byte_offset = is_stereo ?
@@ -494,7 +610,7 @@ void decode_snds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
                 ((channel&1) ? 4:0) : //high nibble first
                 ((i&1) ? 4:0);
 
-        snds_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        snds_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
         sample_count += channelspacing;
     }
@@ -512,13 +628,16 @@ void decode_otns_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, vgmstream->channels > 1));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + (vgmstream->channels==1 ? i/2 : i); //one nibble per channel if stereo
         int nibble_shift = (vgmstream->channels==1) ? //todo simplify
                     (i&1?0:4) : //high nibble first(?)
                     (channel==0?4:0); //low=ch0, high=ch1 (this is correct compared to vids)
 
-        otns_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        otns_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -536,11 +655,14 @@ void decode_wv6_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, false));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        wv6_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        wv6_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -558,11 +680,14 @@ void decode_hv_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspac
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, false));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        hv_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        hv_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -581,11 +706,14 @@ void decode_sqex_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, false));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        ffta2_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index, &out_sample);
+        ffta2_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index, &out_sample);
         outbuf[sample_count] = out_sample;
     }
 
@@ -603,11 +731,14 @@ void decode_blitz_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channels
 
     //no header
 
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, false));
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        blitz_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        blitz_ima_expand_nibble(ima_reader_get(&r, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)clamp16(hist1);
     }
 
@@ -623,7 +754,7 @@ void decode_blitz_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channels
  * so to simplify calcs this decodes full frames, thus hist doesn't need to be mantained.
  * Officially defined in "Microsoft Multimedia Standards Update" doc (RIFFNEW.pdf). */
 void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
-    int i, samples_read = 0, samples_done = 0, max_samples;
+    int samples_read = 0, samples_done = 0, skip_samples, max_samples;
     int32_t hist1;// = stream->adpcm_history1_32;
     int step_index;// = stream->adpcm_step_index;
     int frame_channels = vgmstream->codec_config ? 1 : vgmstream->channels; /* mono or mch modes */
@@ -650,23 +781,19 @@ void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* out
         samples_read++;
     }
 
+    /* nibbles before first_sample are decoded but not written */
+    skip_samples = first_sample > samples_read ? first_sample - samples_read : 0;
     max_samples = (block_samples - samples_read);
-    if (max_samples > samples_to_do + first_sample - samples_done)
-        max_samples = samples_to_do + first_sample - samples_done; /* for smaller last block */
-
-    /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel) */
-    for (i = 0; i < max_samples; i++) {
-        off_t byte_offset = stream->offset + 0x04*frame_channels + 0x04*frame_channel + 0x04*frame_channels*(i/8) + (i%8)/2;
-        int nibble_shift = (i&1?4:0); /* low nibble first */
+    if (max_samples > skip_samples + samples_to_do - samples_done)
+        max_samples = skip_samples + samples_to_do - samples_done; /* for smaller last block */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index); /* original expand */
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + vgmstream->frame_size);
 
-        if (samples_read >= first_sample && samples_done < samples_to_do) {
-            outbuf[samples_done * channelspacing] = (short)(hist1);
-            samples_done++;
-        }
-        samples_read++;
-    }
+    /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel) */
+    ima_layout_t l = ima_layout(stream->offset + 0x04*frame_channels + 0x04*frame_channel, 8, 0x04*frame_channels, false);
+    samples_done += ima_decode_nibbles(&r, &l, 0, max_samples, skip_samples,
+            outbuf + samples_done * channelspacing, channelspacing, &hist1, &step_index);
 
     /* internal interleave: increment offset on complete frame */
     if (first_sample + samples_done == block_samples)  {
@@ -679,7 +806,7 @@ void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* out
 
 /* Reflection's MS-IMA with custom nibble layout (some info from XA2WAV by Deniz Oezmen) */
 void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
-    int i, samples_read = 0, samples_done = 0, max_samples;
+    int samples_read = 0, samples_done = 0, skip_samples, max_samples;
     int32_t hist1;// = stream->adpcm_history1_32;
     int step_index;// = stream->adpcm_step_index;
 
@@ -705,23 +832,19 @@ void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
         samples_read++;
     }
 
+    /* nibbles before first_sample are decoded but not written */
+    skip_samples = first_sample > samples_read ? first_sample - samples_read : 0;
     max_samples = (block_samples - samples_read);
-    if (max_samples > samples_to_do + first_sample - samples_done)
-        max_samples = samples_to_do + first_sample - samples_done; /* for smaller last block */
+    if (max_samples > skip_samples + samples_to_do - samples_done)
+        max_samples = skip_samples + samples_to_do - samples_done; /* for smaller last block */
 
-    /* decode nibbles (layout: all nibbles from one channel, then other channels) */
-    for (i = 0; i < max_samples; i++) {
-        off_t byte_offset = stream->offset + 0x04*vgmstream->channels + block_channel_size*channel + i/2;
-        int nibble_shift = (i&1?4:0); /* low nibble first */
-
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + vgmstream->interleave_block_size);
 
-        if (samples_read >= first_sample && samples_done < samples_to_do) {
-            outbuf[samples_done * channelspacing] = (short)(hist1);
-            samples_done++;
-        }
-        samples_read++;
-    }
+    /* decode nibbles (layout: all nibbles from one channel, then other channels) */
+    ima_layout_t l = ima_layout(stream->offset + 0x04*vgmstream->channels + block_channel_size*channel, 2, 1, false);
+    samples_done += ima_decode_nibbles(&r, &l, 0, max_samples, skip_samples,
+            outbuf + samples_done * channelspacing, channelspacing, &hist1, &step_index);
 
     /* internal interleave: increment offset on complete frame */
     if (first_sample + samples_done == block_samples)  {
@@ -736,8 +859,6 @@ void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
 /* XBOX-IMA                             */
 /* ************************************ */
 
-//TODO: unify variations
-
 /* MS-IMA with fixed frame size, and outputs an even number of samples per frame (skips last nibble).
  * Defined in Xbox's SDK. Usable in mono or stereo modes (both suitable for interleaved multichannel). 
  * Like MS-IMA, it writes the first sample in the frame header, but unlike MS-IMA must skip the last nibble.
@@ -773,19 +894,14 @@ void decode_xbox_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
         samples_to_do -= 1;
     }
 
-    /* decode nibbles (layout: straight in mono or 4 bytes per channel in stereo) */
-    for (int i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = is_stereo ?
-                frame_offset + 0x04*2 + 0x04 * (channel % 2) + 0x04 * 2 * ((i-1) / 8) + ((i-1) % 8) / 2 :
-                frame_offset + 0x04   + (i-1) / 2;
-        int nibble_shift = (!((i-1) & 1) ? 0 : 4);  // low nibble first
-
-        if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-            outbuf[sample_pos] = (short)(hist1);
-            sample_pos += channelspacing;
-        }
-    }
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, frame_offset + frame_size);
+
+    /* decode nibbles (layout: straight in mono or 4 bytes per channel in stereo), low nibble first */
+    ima_layout_t l = is_stereo ?
+            ima_layout(frame_offset + 0x04*2 + 0x04 * (channel % 2), 8, 0x04*2, false) :
+            ima_layout(frame_offset + 0x04, 2, 1, false);
+    ima_decode_xbox_nibbles(&r, &l, block_samples, first_sample, samples_to_do, outbuf + sample_pos, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -817,18 +933,13 @@ void decode_xbox_ima_mch(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
         samples_to_do -= 1;
     }
 
-    /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel) */
-    off_t base_offset = stream->offset + 0x24 * channelspacing * num_frame + 0x04 * channelspacing + 0x04 * channel;
-    for (int i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = base_offset + 0x04 * channelspacing * ((i-1) / 8) + ((i-1) % 8) / 2;
-        int nibble_shift = ((i-1) & 1 ? 4 : 0); // low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + 0x24 * channelspacing * (num_frame + 1));
 
-        if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-            outbuf[sample_count] = (short)(hist1);
-            sample_count += channelspacing;
-        }
-    }
+    /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel), low nibble first */
+    off_t base_offset = stream->offset + 0x24 * channelspacing * num_frame + 0x04 * channelspacing + 0x04 * channel;
+    ima_layout_t l = ima_layout(base_offset, 8, 0x04 * channelspacing, false);
+    ima_decode_xbox_nibbles(&r, &l, block_samples, first_sample, samples_to_do, outbuf + sample_count, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -862,18 +973,13 @@ void decode_xbox_ima_saber(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int chann
         samples_to_do -= 1;
     }
 
-    /* decode nibbles (layout: alternates 2 bytes per channel) */
-    off_t base_offset = stream->offset + 0x24 * channelspacing * num_frame + 0x04 * channelspacing + 0x02 * channel;
-    for (int i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = base_offset + ((i-1) / 4) * 8 + ((i-1) % 4) / 2;
-        int nibble_shift = ((i-1) & 1 ? 4 : 0); // low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + 0x24 * channelspacing * (num_frame + 1));
 
-        if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-            outbuf[sample_count] = (short)(hist1);
-            sample_count += channelspacing;
-        }
-    }
+    /* decode nibbles (layout: alternates 2 bytes per channel), low nibble first */
+    off_t base_offset = stream->offset + 0x24 * channelspacing * num_frame + 0x04 * channelspacing + 0x02 * channel;
+    ima_layout_t l = ima_layout(base_offset, 4, 0x08, false);
+    ima_decode_xbox_nibbles(&r, &l, block_samples, first_sample, samples_to_do, outbuf + sample_count, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -883,7 +989,6 @@ void decode_xbox_ima_saber(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int chann
  * Apparently clamps to -32767 unlike standard's -32768 (probably not noticeable).
  * Info here: http://problemkaputt.de/gbatek.htm#dssoundnotes */
 void decode_nds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -899,22 +1004,19 @@ void decode_nds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         if (step_index > 88) step_index=88;
     }
 
-    /* decode nibbles (layout: all nibbles from the channel) */
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = stream->offset + 0x04 + i/2;
-        int nibble_shift = (i&1?4:0); /* low nibble first */
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset + 0x04, first_sample + samples_to_do, false));
 
-        //todo waveform has minor deviations using known expands
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    /* decode nibbles (layout: all nibbles from the channel), low nibble first */
+    //todo waveform has minor deviations using known expands
+    ima_layout_t l = ima_layout(stream->offset + 0x04, 2, 1, false);
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
 }
 
 void decode_dat4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_16;//todo unneeded 16?
     int step_index = stream->adpcm_step_index;
 
@@ -929,20 +1031,17 @@ void decode_dat4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
         step_index = _clamp_s32(step_index, 0, 88); /* probably pre-adjusted */
     }
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = stream->offset + 4 + i/2;
-        int nibble_shift = (i&1?0:4); //high nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset + 0x04, first_sample + samples_to_do, false));
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    ima_layout_t l = ima_layout(stream->offset + 4, 2, 1, true); //high nibble first
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_16 = hist1;
     stream->adpcm_step_index = step_index;
 }
 
 void decode_rad_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do,int channel) {
-    int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -960,23 +1059,21 @@ void decode_rad_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample_t *
         if (step_index > 88) step_index=88;
     }
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = stream->offset + 4*vgmstream->channels + channel + i/2*vgmstream->channels;
-        int nibble_shift = (i&1?4:0); //low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + vgmstream->interleave_block_size);
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    //layout: 1 byte per channel, low nibble first
+    ima_layout_t l = ima_layout(stream->offset + 4*vgmstream->channels + channel, 2, vgmstream->channels, false);
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     //internal interleave: increment offset on complete frame
-    if (i == block_samples) stream->offset += vgmstream->interleave_block_size;
+    if (first_sample + samples_to_do == block_samples) stream->offset += vgmstream->interleave_block_size;
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
 }
 
 void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -994,13 +1091,11 @@ void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
         if (step_index > 88) step_index=88;
     }
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = stream->offset + 4 + i/2;
-        int nibble_shift = (i&1?4:0); //low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset + 0x04, first_sample + samples_to_do, false));
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    ima_layout_t l = ima_layout(stream->offset + 4, 2, 1, false); //low nibble first
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1008,8 +1103,8 @@ void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
 
 /* Apple's IMA4, a.k.a QuickTime IMA. 2 byte header and header sample is not written (setup only). */
 void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count, num_frame;
-    int16_t hist1 = stream->adpcm_history1_16;//todo unneeded 16?
+    int num_frame;
+    int32_t hist1 = stream->adpcm_history1_16; /* Apple uses 16b hist, same as clamped 32b */
     int step_index = stream->adpcm_step_index;
 
     //external interleave
@@ -1027,13 +1122,11 @@ void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channel
         if (step_index > 88) step_index=88;
     }
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = (stream->offset + 0x22*num_frame + 0x2) + i/2;
-        int nibble_shift = (i&1?4:0); //low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + 0x22 * (num_frame + 1));
 
-        std_ima_expand_nibble_16(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    ima_layout_t l = ima_layout(stream->offset + 0x22*num_frame + 0x2, 2, 1, false); //low nibble first
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_16 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1041,7 +1134,7 @@ void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channel
 
 /* XBOX-IMA with modified data layout */
 void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do,int channel) {
-    int i, sample_count = 0;
+    int sample_count = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -1066,21 +1159,16 @@ void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
         samples_to_do -= 1;
     }
 
-    /* decode nibbles (layout: 2 bytes/2*2 nibbles per channel) */
-    for (i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = stream->offset + 0x04*vgmstream->channels + 0x02*channel + (i-1)/4*2*vgmstream->channels + ((i-1)%4)/2;
-        int nibble_shift = ((i-1)&1?4:0); /* low nibble first */
-
-        /* must skip last nibble per official decoder, probably not needed though */
-        if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-            outbuf[sample_count] = (short)(hist1);
-            sample_count += channelspacing;
-        }
-    }
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + 0x24 * vgmstream->channels);
+
+    /* decode nibbles (layout: 2 bytes/2*2 nibbles per channel), low nibble first */
+    /* must skip last nibble per official decoder, probably not needed though */
+    ima_layout_t l = ima_layout(stream->offset + 0x04*vgmstream->channels + 0x02*channel, 4, 0x02*vgmstream->channels, false);
+    ima_decode_xbox_nibbles(&r, &l, block_samples, first_sample, samples_to_do, outbuf + sample_count, channelspacing, &hist1, &step_index);
 
     /* internal interleave: increment offset on complete frame */
-    if (i == block_samples) {
+    if (first_sample + samples_to_do == block_samples) {
         stream->offset += 0x24*vgmstream->channels;
     }
 
@@ -1090,7 +1178,7 @@ void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
 
 /* mono XBOX-IMA with header endianness and alt nibble expand (verified vs AK test demos) */
 void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count = 0, num_frame;
+    int sample_count = 0, num_frame;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
 
@@ -1116,18 +1204,14 @@ void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t*
         samples_to_do -= 1;
     }
 
-    /* decode nibbles (layout: all nibbles from one channel) */
-    for (i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = (stream->offset + 0x24*num_frame + 0x4) + (i-1)/2;
-        int nibble_shift = ((i-1)&1?4:0); /* low nibble first */
-
-        /* must skip last nibble like other XBOX-IMAs, often needed (ex. Bayonetta 2 sfx) */
-        if (i < block_samples) {
-            std_ima_expand_nibble_mul(stream, byte_offset,nibble_shift, &hist1, &step_index);
-            outbuf[sample_count] = (short)(hist1);
-            sample_count += channelspacing;
-        }
-    }
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, stream->offset + 0x24 * (num_frame + 1));
+
+    /* decode nibbles (layout: all nibbles from one channel), low nibble first */
+    /* must skip last nibble like other XBOX-IMAs, often needed (ex. Bayonetta 2 sfx) */
+    ima_layout_t l = ima_layout(stream->offset + 0x24*num_frame + 0x4, 2, 1, false);
+    l.mul = true;
+    ima_decode_xbox_nibbles(&r, &l, block_samples, first_sample, samples_to_do, outbuf + sample_count, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1135,7 +1219,6 @@ void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t*
 
 /* MS-IMA with possibly the XBOX-IMA model of even number of samples per block (more tests are needed) */
 void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i, sample_count;
 
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -1154,16 +1237,14 @@ void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         if (step_index > 88) step_index=88;
     }
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = stream->offset + 4 + i/2;
-        int nibble_shift = (i&1?4:0); //low nibble first
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset + 0x04, first_sample + samples_to_do, false));
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1);
-    }
+    ima_layout_t l = ima_layout(stream->offset + 4, 2, 1, false); //low nibble first
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample, outbuf, channelspacing, &hist1, &step_index);
 
     //internal interleave: increment offset on complete frame
-    if (i == block_samples) stream->offset += 0x800;
+    if (first_sample + samples_to_do == block_samples) stream->offset += 0x800;
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1172,7 +1253,7 @@ void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
 /* DVI stereo/mono with some mini header and sample output */
 void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
-    int i, sample_count = 0;
+    int sample_count = 0;
     STREAMFILE* sf = stream->streamfile;
 
     int32_t hist1 = stream->adpcm_history1_32;
@@ -1254,17 +1335,15 @@ void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
     if (step_index < 0) step_index = 0;
     if (step_index > 88) step_index = 88;
 
-    for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
-        off_t byte_offset = channelspacing == 1 ?
-                stream->offset + i/2 :  /* mono mode */
-                stream->offset + i;     /* stereo mode */
-        int nibble_shift = channelspacing == 1 ?
-                (!(i%2) ? 4:0) :        /* mono mode (high first) */
-                (channel==0 ? 4:0);     /* stereo mode (high=L,low=R) */
-
-        std_ima_expand_nibble_mul(stream, byte_offset, nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1); /* all samples are written */
-    }
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, channelspacing > 1));
+
+    ima_layout_t l = channelspacing == 1 ?
+            ima_layout(stream->offset, 2, 1, true) :                    /* mono mode (high first) */
+            ima_layout_stereo(stream->offset, channel == 0 ? 4:0);      /* stereo mode (high=L,low=R) */
+    l.mul = true;
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample,
+            outbuf + sample_count, channelspacing, &hist1, &step_index); /* all samples are written */
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1272,7 +1351,6 @@ void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
 /* standard IMA but with a tweak for Ubi's encoder bug with step index (see blocked_ubi_sce.c) */
 void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
-    int i, sample_count = 0;
 
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -1282,17 +1360,14 @@ void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
     if (step_index < 0) step_index = 0;
     if (step_index > 89) step_index = 89;
 
-    for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
-        off_t byte_offset = channelspacing == 1 ?
-                stream->offset + i/2 :  /* mono mode */
-                stream->offset + i;     /* stereo mode */
-        int nibble_shift = channelspacing == 1 ?
-                (!(i%2) ? 4:0) :        /* mono mode (high first) */
-                (channel==0 ? 4:0);     /* stereo mode (high=L,low=R) */
-
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
-        outbuf[sample_count] = (short)(hist1); /* all samples are written */
-    }
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset, first_sample + samples_to_do, channelspacing > 1));
+
+    ima_layout_t l = channelspacing == 1 ?
+            ima_layout(stream->offset, 2, 1, true) :                    /* mono mode (high first) */
+            ima_layout_stereo(stream->offset, channel == 0 ? 4:0);      /* stereo mode (high=L,low=R) */
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample,
+            outbuf, channelspacing, &hist1, &step_index); /* all samples are written */
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1303,7 +1378,7 @@ void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
  * tables mapping all standard IMA combinations (to optimize calculations), but decodes the same.
  * Based on HCS's and Nisto's reverse engineering in h4m_audio_decode. */
 void decode_hvqm4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, uint16_t frame_format) {
-    int i, samples_done = 0;
+    int samples_done = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
     size_t header_size;
@@ -1353,20 +1428,15 @@ void decode_hvqm4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channels
         default: header_size = 0; break;
     }
 
-    /* decode block nibbles */
-    for (i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = is_stereo ?
-                stream->offset + header_size + i :      /* stereo: one nibble per channel */
-                stream->offset + header_size + i/2;     /* mono: consecutive nibbles */
-        int nibble_shift = is_stereo ?
-                (!(channel&1) ? 0:4) :                  /* stereo: L=low, R=high */
-                (!(i&1) ? 0:4);                         /* mono: low first */
-
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+    ima_reader_t r;
+    ima_reader_init(&r, stream->streamfile, ima_nibbles_end(stream->offset + header_size, first_sample + samples_to_do, is_stereo));
 
-        outbuf[samples_done * channelspacing] = (short)(hist1);
-        samples_done++;
-    }
+    /* decode block nibbles */
+    ima_layout_t l = is_stereo ?
+            ima_layout_stereo(stream->offset + header_size, !(channel&1) ? 0:4) :   /* stereo: one nibble per channel, L=low, R=high */
+            ima_layout(stream->offset + header_size, 2, 1, false);                  /* mono: consecutive nibbles, low first */
+    ima_decode_nibbles(&r, &l, first_sample, first_sample + samples_to_do, first_sample,
+            outbuf + samples_done * channelspacing, channelspacing, &hist1, &step_index);
 
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_step_index = step_index;
@@ -1447,7 +1517,7 @@ void decode_crankcase_ima(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channe
         int pos = 0x03 + (i/2);
         int shift = (i & 1 ? 4:0); /* low first */
 
-        std_ima_expand_nibble_data(frame[pos], shift, &hist1, &step_index);
+        std_ima_expand_nibble(frame[pos], shift, &hist1, &step_index);
         outbuf[sample_pos] = (short)(hist1); /* internally output to float using "sample / 32767.0" */
         sample_pos += channelspacing;
     }
@@ -182,6 +182,17 @@ typedef struct {
     short pbuf[PCM_BUF_SIZE];
 
     bool overread;
+
+    /* state at loop start, since seeking needs to decode from the beginning */
+    struct {
+        bool saved;
+        int current_block;
+        int16_t adpcm_history[MAX_CHANNELS];
+        uint8_t adpcm_step_index[MAX_CHANNELS];
+        short pbuf[PCM_BUF_SIZE];
+        bool overread;
+        decode_state_t ds;
+    } loop;
 } imuse_codec_data;
 
 
@@ -199,6 +210,7 @@ static void reset_imuse(void* priv_data) {
 
     data->current_block = 0;
     data->overread = false;
+    data->loop.saved = false;
 }
 
 static imuse_codec_data* init_imuse_internal(int channels, int blocks) {
@@ -801,10 +813,42 @@ static void seek_imuse(VGMSTREAM* v, int32_t num_sample) {
     ds->discard = num_sample;
 }
 
+static bool snapshot_imuse(VGMSTREAM* v) {
+    imuse_codec_data* data = v->codec_data;
+    decode_state_t* ds = v->decode_state;
+    if (!data) return false;
+
+    /* pending samples in ds point to pbuf */
+    data->loop.current_block = data->current_block;
+    memcpy(data->loop.adpcm_history, data->adpcm_history, sizeof(data->adpcm_history));
+    memcpy(data->loop.adpcm_step_index, data->adpcm_step_index, sizeof(data->adpcm_step_index));
+    memcpy(data->loop.pbuf, data->pbuf, sizeof(data->pbuf));
+    data->loop.overread = data->overread;
+    data->loop.ds = *ds;
+    data->loop.saved = true;
+    return true;
+}
+
+static bool restore_imuse(VGMSTREAM* v) {
+    imuse_codec_data* data = v->codec_data;
+    decode_state_t* ds = v->decode_state;
+    if (!data || !data->loop.saved) return false;
+
+    data->current_block = data->loop.current_block;
+    memcpy(data->adpcm_history, data->loop.adpcm_history, sizeof(data->adpcm_history));
+    memcpy(data->adpcm_step_index, data->loop.adpcm_step_index, sizeof(data->adpcm_step_index));
+    memcpy(data->pbuf, data->loop.pbuf, sizeof(data->pbuf));
+    data->overread = data->loop.overread;
+    *ds = data->loop.ds;
+    return true;
+}
+
 const codec_info_t imuse_decoder = {
     .sample_type = SFMT_S16,
     .decode_frame = decode_frame_imuse,
     .free = free_imuse,
     .reset = reset_imuse,
     .seek = seek_imuse,
+    .snapshot = snapshot_imuse,
+    .restore = restore_imuse,
 };
@@ -357,6 +357,13 @@ void clHCA_ReadSamples(clHCA* hca, float* samples) {
     }
 }
 
+void clHCA_GetSamplesPlanar(clHCA* hca, float** planes) {
+    /* subframes are consecutive, so each channel's output is a straight buffer */
+    for (int k = 0; k < hca->channels; k++) {
+        planes[k] = &hca->channel[k].wave[0][0];
+    }
+}
+
 
 //--------------------------------------------------
 // Allocation and creation
@@ -1212,6 +1219,36 @@ static int clHCA_DecodeBlock_unpack(clHCA* hca, void* data, unsigned int size) {
     return br.bit; /* numbers of read bits for validations */
 }
 
+/* Bad keys mostly fail at the first scalefactors, which only need a few bytes (max ~0xB2 for 128 escaped
+ * values), so this decrypts a copy of those alone and skips the full frame's checksum/decryption/unpack. */
+#define HCA_QUICK_TEST_SIZE 0x100
+
+int clHCA_TestBlockQuick(clHCA* hca, const void* data, unsigned int size) {
+    unsigned char buf[HCA_QUICK_TEST_SIZE];
+    unsigned int buf_size;
+    clData br;
+
+    if (!data || !hca || !hca->is_valid)
+        return HCA_ERROR_PARAMS;
+    if (size < hca->frame_size)
+        return HCA_ERROR_PARAMS;
+
+    buf_size = hca->frame_size < sizeof(buf) ? hca->frame_size : sizeof(buf);
+    memcpy(buf, data, buf_size);
+
+    bitreader_init(&br, buf, buf_size);
+
+    if (bitreader_read(&br, 16) != 0xFFFF)
+        return HCA_ERROR_SYNC;
+
+    cipher_decrypt(hca->cipher_table, buf, buf_size);
+
+    bitreader_skip(&br, 9 + 7); /* noise level and evaluation boundary */
+
+    /* same as unpack (if frame is smaller than buf all reads are inside) */
+    return unpack_scalefactors(&hca->channel[0], &br, hca->hfr_group_count, hca->version);
+}
+
 static void clHCA_DecodeBlock_transform(clHCA* hca) {
     unsigned int subframe, ch;
 
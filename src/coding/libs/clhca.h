@@ -65,6 +65,8 @@ int clHCA_DecodeBlock(clHCA* hca, void* data, unsigned int size);
  * next decode. Buffer must be at least (samplesPerBlock*channels) long. */
 void clHCA_ReadSamples16(clHCA* hca, short* samples);
 void clHCA_ReadSamples(clHCA* hca, float* samples);
+/* Same as clHCA_ReadSamples but pointing planes[ch] to each channel's samples (not interleaved, no copy). */
+void clHCA_GetSamplesPlanar(clHCA* hca, float** planes);
 
 
 /* Sets a 64 bit encryption key, to properly decode blocks. This may be called
@@ -79,6 +81,10 @@ void clHCA_SetKey(clHCA* hca, unsigned long long keycode);
  * and select the key with scores closer to 1. */
 int clHCA_TestBlock(clHCA* hca, void* data, unsigned int size);
 
+/* Partially tests a non-silent block (without modifying it), to quickly discard wrong keys before
+ * calling clHCA_TestBlock. Returns <0 on incorrect block, 0 if block may be correct. */
+int clHCA_TestBlockQuick(clHCA* hca, const void* data, unsigned int size);
+
 /* Resets the internal decode state, used when restarting to decode the file from the beginning.
  * Without it there are minor differences, mainly useful when testing a new key. */
 void clHCA_DecodeReset(clHCA* hca);
@@ -62,14 +62,9 @@ static void aes_key_expand(s14aes_handle* ctx, const uint8_t* key, uint32_t* rk)
 }
 
 static void aes_init_key(s14aes_handle* ctx, const uint8_t* key) {
-    const uint8_t invcols[4][4] = {
-        {0x0E,0x0B,0x0D,0x09},
-        {0x09,0x0E,0x0B,0x0D},
-        {0x0D,0x09,0x0E,0x0B}, 
-        {0x0B,0x0D,0x09,0x0E}
-    };
     unsigned int roundkey[52];
-    int i, j, row, col, b;
+    const uint32_t* tds = ctx->tds;
+    int i;
 
     aes_key_expand(ctx, key, roundkey);
 
@@ -80,32 +75,14 @@ static void aes_init_key(s14aes_handle* ctx, const uint8_t* key) {
                      ((roundkey[i] >> 24) & 0x000000FF);
     }
 
-    for (i = 4; i < 48; i += 4) {
-        for (j = i; j < i + 4; j++) {
-            uint32_t val = 0;
-
-            for (row = 0; row < 4; row++) {
-                uint8_t xv = 0;
-
-                for (col = 0; col < 4; col++) {
-                    uint16_t rv1 = 0;
-                    uint16_t rv2 = (roundkey[j] >> (col * 8)) & 0xFF;
-                    uint8_t ic = invcols[row][col];
-
-                    for (b = 0; b < 8; b++) {
-                        if (ic & (1 << b))
-                            rv1 ^= rv2;
-                        rv2 *= 2;
-                    }
-
-                    xv ^= rv1 ^ ctx->xors[rv1 >> 8];
-                }
-
-                val = (val << 8) | xv;
-            }
-
-            ctx->rk[j] = val;
-        }
+    /* middle roundkeys get InvMixColumns, that Namco's code calculates per bit with these columns:
+     *   {0x0E,0x0B,0x0D,0x09}, {0x09,0x0E,0x0B,0x0D}, {0x0D,0x09,0x0E,0x0B}, {0x0B,0x0D,0x09,0x0E}
+     * but tds already has those multiplications per byte (same result, much faster when testing keys) */
+    for (i = 4; i < 48; i++) {
+        ctx->rk[i] = tds[4 * GET_B0(roundkey[i]) + 0] ^
+                     tds[4 * GET_B1(roundkey[i]) + 1] ^
+                     tds[4 * GET_B2(roundkey[i]) + 2] ^
+                     tds[4 * GET_B3(roundkey[i]) + 3];
     }
 
     for (i = 48; i < 52; i++) {
@@ -173,24 +150,22 @@ static void aes_init_state(s14aes_handle* ctx) {
         }
     }
 
-    box[0] = 0;
-    for (i = 1; i < 256; i++) {
-        for (j = 1; j < 256; j++) {
-            uint16_t bv1 = 0;
-            uint16_t bv2 = j;
-            for (k = 0; k < 8; k++) {
-                if (i & (1 << k))
-                    bv1 ^= bv2;
-                bv2 *= 2;
-            }
+    /* multiplicative inverses, that Namco's code finds testing all values (slow for multiple handles),
+     * using log/exp tables of generator 0x03 instead */
+    {
+        uint8_t exp[256], log[256];
+        uint8_t x = 1;
 
-            if (((uint8_t)bv1 ^ ctx->xors[bv1 >> 8]) == 1)
-                break;
+        for (i = 0; i < 255; i++) {
+            exp[i] = x;
+            log[x] = i;
+            x ^= (x << 1) ^ ((x & 0x80) ? 0x1B : 0x00); /* x * 3 */
         }
-        box[i] = j;
 
-        if (j == 256) /* ??? */
-            return;
+        box[0] = 0;
+        for (i = 1; i < 256; i++) {
+            box[i] = exp[(255 - log[i]) % 255];
+        }
     }
 
     for (i = 0; i < 256; i += 16) {
@@ -1158,6 +1158,25 @@ int g7221_decode_frame(g7221_handle* handle, uint8_t* data, int16_t* out_samples
     return 0;
 }
 
+int g7221_test_frame(g7221_handle* handle, const uint8_t* data) {
+    uint8_t buf[0x78]; /* max frame size */
+    int16_t mlt_coefs[MAX_DCT_LENGTH];
+    uint32_t random_value = handle->random_value;
+    int mag_shift;
+
+    if (handle->frame_size > sizeof(buf))
+        return -1;
+
+    /* errors are only detected when unpacking (rmlt can't fail), and unpack doesn't depend on decoder state,
+     * so use copies and skip rmlt for faster key tests */
+    memcpy(buf, data, handle->frame_size);
+    if (handle->aes != NULL) {
+        s14aes_decrypt(handle->aes, buf);
+    }
+
+    return unpack_frame(handle->bit_rate, buf, handle->frame_size, &mag_shift, mlt_coefs, &random_value, handle->test_errors);
+}
+
 #if 0
 int g7221_decode_empty(g7221_handle* handle, int16_t* out_samples) {
     static const uint8_t empty_frame[0x3c] = {
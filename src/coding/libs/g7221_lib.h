@@ -15,6 +15,9 @@ g7221_handle* g7221_init(int bytes_per_frame);
 /* decode a frame, at code_words, into 16-bit PCM in sample_buffer. returns <0 on error */
 int g7221_decode_frame(g7221_handle* handle, uint8_t* data, int16_t* out_samples);
 
+/* test if a frame unpacks correctly with the current key, without modifying data or decoder state. returns <0 on error */
+int g7221_test_frame(g7221_handle* handle, const uint8_t* data);
+
 #if 0
 /* decodes an empty frame after no more data is found (may be used to "drain" window samples */
 int g7221_decode_empty(g7221_handle* handle, int16_t* out_samples);
@@ -391,6 +391,21 @@ void relic_reset(relic_handle_t* handle) {
     memset(handle->wave_prv, 0, RELIC_MAX_CHANNELS * RELIC_MAX_SIZE * sizeof(float));
 }
 
+relic_handle_t* relic_clone(relic_handle_t* handle) {
+    if (!handle) return NULL;
+
+    relic_handle_t* clone = malloc(sizeof(relic_handle_t));
+    if (!clone) return NULL;
+
+    *clone = *handle; /* no pointers inside */
+    return clone;
+}
+
+void relic_copy(relic_handle_t* dst, relic_handle_t* src) {
+    if (!dst || !src) return;
+    *dst = *src;
+}
+
 int relic_get_frame_size(relic_handle_t* handle) {
     if (!handle) return 0;
     return handle->frame_size;
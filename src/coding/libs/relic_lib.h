@@ -15,6 +15,10 @@ void relic_free(relic_handle_t* handle);
 
 void relic_reset(relic_handle_t* handle);
 
+/* copies of current decoder state (for loops) */
+relic_handle_t* relic_clone(relic_handle_t* handle);
+void relic_copy(relic_handle_t* dst, relic_handle_t* src);
+
 int relic_get_frame_size(relic_handle_t* handle);
 
 int relic_decode_frame(relic_handle_t* handle, uint8_t* buf, int channel);
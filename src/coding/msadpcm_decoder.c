@@ -82,7 +82,7 @@ static int16_t msadpcm_adpcm_expand_nibble_div(VGMSTREAMCHANNEL* stream, uint8_t
     return predicted;
 }
 
-static int get_index(uint8_t* frame, int num_coefs) {
+static int get_index(const uint8_t* frame, int num_coefs) {
     int index = get_u8(frame);
 
     if (index >= num_coefs) {
@@ -96,7 +96,8 @@ static int get_index(uint8_t* frame, int num_coefs) {
 void decode_msadpcm_stereo(VGMSTREAM* vgmstream, sample_t* outbuf, int32_t first_sample, int32_t samples_to_do) {
     VGMSTREAMCHANNEL* stream1 = &vgmstream->ch[0];
     VGMSTREAMCHANNEL* stream2 = &vgmstream->ch[1];
-    uint8_t frame[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    uint8_t frame_buf[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    const uint8_t* frame;
     const int num_coefs = MSADPCM_MAX_COEFFICIENTS;
 
     /* external interleave (variable size), stereo */
@@ -106,7 +107,7 @@ void decode_msadpcm_stereo(VGMSTREAM* vgmstream, sample_t* outbuf, int32_t first
     first_sample = first_sample % samples_per_frame;
 
     off_t frame_offset = stream1->offset + frames_in * bytes_per_frame;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream1->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream1->streamfile); /* ignore EOF errors */
 
     // predictor >= nNumCoef > return 0
 
@@ -153,7 +154,8 @@ void decode_msadpcm_stereo(VGMSTREAM* vgmstream, sample_t* outbuf, int32_t first
 
 void decode_msadpcm_mono(VGMSTREAM* vgmstream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, int config) {
     VGMSTREAMCHANNEL* stream = &vgmstream->ch[channel];
-    uint8_t frame[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    uint8_t frame_buf[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    const uint8_t* frame;
     const int num_coefs = MSADPCM_MAX_COEFFICIENTS;
     bool is_shr = (config == 0);
 
@@ -164,7 +166,7 @@ void decode_msadpcm_mono(VGMSTREAM* vgmstream, sample_t* outbuf, int channelspac
     first_sample = first_sample % samples_per_frame;
 
     off_t frame_offset = stream->offset + frames_in * bytes_per_frame;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
 
     /* parse frame header */
     if (first_sample == 0) {
@@ -206,7 +208,8 @@ void decode_msadpcm_mono(VGMSTREAM* vgmstream, sample_t* outbuf, int channelspac
  * (their tools may convert to float/others but internally it's all PCM16). */
 void decode_msadpcm_ck(VGMSTREAM* vgmstream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
     VGMSTREAMCHANNEL* stream = &vgmstream->ch[channel];
-    uint8_t frame[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    uint8_t frame_buf[MSADPCM_MAX_BLOCK_SIZE] = {0};
+    const uint8_t* frame;
     const int num_coefs = MSADPCM_MAX_COEFFICIENTS;
 
     /* external interleave (variable size), mono */
@@ -216,7 +219,7 @@ void decode_msadpcm_ck(VGMSTREAM* vgmstream, sample_t* outbuf, int channelspacin
     first_sample = first_sample % samples_per_frame;
 
     off_t frame_offset = stream->offset + frames_in * bytes_per_frame;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
 
     /* parse frame header */
     if (first_sample == 0) {
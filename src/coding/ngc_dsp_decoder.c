@@ -2,25 +2,16 @@
 #include "../util.h"
 
 
-void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    uint8_t frame[0x08] = {0};
-    off_t frame_offset;
-    int i, frames_in, sample_count = 0;
-    size_t bytes_per_frame, samples_per_frame;
-    int coef_index, scale, coef1, coef2;
-    int32_t hist1 = stream->adpcm_history1_16;
-    int32_t hist2 = stream->adpcm_history2_16;
-
+/* max frames read at once (callers may ask for many consecutive frames when the layout allows it) */
+#define DSP_BATCH_FRAMES 0x80
 
-    /* external interleave (fixed size), mono */
-    bytes_per_frame = 0x08;
-    samples_per_frame = (bytes_per_frame - 0x01) * 2; /* always 14 */
-    frames_in = first_sample / samples_per_frame;
-    first_sample = first_sample % samples_per_frame;
+static void decode_ngc_dsp_frame(VGMSTREAMCHANNEL* stream, const uint8_t* frame, off_t frame_offset, sample_t* outbuf, int channelspacing, int first_sample, int samples_to_do, int32_t* p_hist1, int32_t* p_hist2) {
+    int i, sample_count = 0;
+    int coef_index, scale, coef1, coef2;
+    int32_t hist1 = *p_hist1;
+    int32_t hist2 = *p_hist2;
 
     /* parse frame header */
-    frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
     scale = 1 << ((frame[0] >> 0) & 0xf);
     coef_index  = (frame[0] >> 4) & 0xf;
 
@@ -51,6 +42,56 @@ void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         hist1 = sample;
     }
 
+    *p_hist1 = hist1;
+    *p_hist2 = hist2;
+}
+
+/* Decodes samples_to_do from first_sample, that may span multiple consecutive frames (read in bulk) */
+void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    uint8_t frames_buf[0x08 * DSP_BATCH_FRAMES];
+    const uint8_t* data;
+    off_t frame_offset;
+    int frames_in;
+    size_t bytes_per_frame, samples_per_frame;
+    int32_t hist1 = stream->adpcm_history1_16;
+    int32_t hist2 = stream->adpcm_history2_16;
+
+
+    /* external interleave (fixed size), mono */
+    bytes_per_frame = 0x08;
+    samples_per_frame = (bytes_per_frame - 0x01) * 2; /* always 14 */
+    frames_in = first_sample / samples_per_frame;
+    first_sample = first_sample % samples_per_frame;
+
+    frame_offset = stream->offset + bytes_per_frame * frames_in;
+    while (samples_to_do > 0) {
+        int frames = (first_sample + samples_to_do + samples_per_frame - 1) / samples_per_frame;
+        if (frames > DSP_BATCH_FRAMES)
+            frames = DSP_BATCH_FRAMES;
+        size_t frames_size = frames * bytes_per_frame;
+
+        data = get_streamfile_view(frame_offset, frames_size, stream->streamfile);
+        if (!data) {
+            size_t bytes = read_streamfile(frames_buf, frame_offset, frames_size, stream->streamfile); /* ignore EOF errors */
+            memset(frames_buf + bytes, 0, frames_size - bytes);
+            data = frames_buf;
+        }
+
+        for (int f = 0; f < frames && samples_to_do > 0; f++) {
+            int samples = samples_per_frame - first_sample;
+            if (samples > samples_to_do)
+                samples = samples_to_do;
+
+            decode_ngc_dsp_frame(stream, data + f * bytes_per_frame, frame_offset + f * bytes_per_frame, outbuf, channelspacing, first_sample, samples, &hist1, &hist2);
+
+            outbuf += samples * channelspacing;
+            samples_to_do -= samples;
+            first_sample = 0;
+        }
+
+        frame_offset += frames_size;
+    }
+
     stream->adpcm_history1_16 = hist1;
     stream->adpcm_history2_16 = hist2;
 }
@@ -27,7 +27,7 @@ struct ogg_vorbis_codec_data {
     int comment_number;
     vorbis_info* info;
 
-    float* fbuf;
+    void** planes;              // current libvorbis buffers per channel (not owned)
 };
 
 
@@ -45,7 +45,7 @@ static void free_ogg_vorbis(void* priv_data) {
     }
 
     close_streamfile(data->io.streamfile);
-    free(data->fbuf);
+    free(data->planes);
     free(data);
 }
 
@@ -216,9 +216,9 @@ static bool decode_frame_ogg_vorbis(VGMSTREAM* v) {
     float** pcm_channels;
 
     //TODO: helper? maybe should init in init_vorbis_custom but right now not all vorbises pass channels
-    if (data->fbuf == NULL) {
-        data->fbuf = malloc(VORBIS_CALL_SAMPLES * sizeof(float) * v->channels);
-        if (!data->fbuf) return -1;
+    if (data->planes == NULL) {
+        data->planes = calloc(v->channels, sizeof(void*));
+        if (!data->planes) return false;
     }
 
     // Ogg frame samples vary per frame, and API allows to ask for arbitrary max (may return less).
@@ -240,13 +240,14 @@ static bool decode_frame_ogg_vorbis(VGMSTREAM* v) {
     //    rc = 0;
     //}
 
-    sbuf_init_flt(&ds->sbuf, data->fbuf, rc, v->channels);
+    // use libvorbis's planar buffers directly (valid until next call), interleaved later when copied out
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, data->planes, rc, v->channels);
     ds->sbuf.filled = rc;
 
     if (data->disable_reordering)
-        sbuf_interleave(&ds->sbuf, pcm_channels);
+        sbuf_set_planes(&ds->sbuf, pcm_channels);
     else
-        sbuf_interleave_vorbis(&ds->sbuf, pcm_channels);
+        sbuf_set_planes_vorbis(&ds->sbuf, pcm_channels);
 
     if (data->discard) {
         ds->discard = data->discard;
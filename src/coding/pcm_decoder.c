@@ -5,90 +5,185 @@
 #include "../base/codec_info.h"
 #include "../util/endianness.h"
 
-void decode_pcm16le(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
+/* PCM is read in chunks rather than per sample, as going through the streamfile for every
+ * sample (even when it's buffered) is most of the decode time */
+#define PCM_CHUNK_SIZE 0x1000
+
+/* native LE PCM16 can be copied as-is */
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || \
+        (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || defined(_M_ARM) || defined(_M_ARM64)))
+    #define PCM_NATIVE_LE 1
+#else
+    #define PCM_NATIVE_LE 0
+#endif
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        outbuf[sample_count]=read_16bitLE(stream->offset+i*2,stream->streamfile);
+typedef enum { PCM16_LE, PCM16_BE, PCM16_LE_U, PCM8_S, PCM8_U, PCM8_SB } pcm_format_t;
+
+/* Returns size bytes at offset, from the SF's buffer if possible. On failed reads (EOF) missing
+ * samples are set to -1 (0xFF), same as per-sample readers would return. */
+static const uint8_t* read_pcm_chunk(uint8_t* buf, off_t offset, size_t size, int sample_size, STREAMFILE* sf) {
+    const uint8_t* view = get_streamfile_view(offset, size, sf);
+    if (view)
+        return view;
+
+    size_t bytes = read_streamfile(buf, offset, size, sf);
+    if (bytes < size) {
+        bytes -= bytes % sample_size;
+        memset(buf + bytes, 0xFF, size - bytes);
     }
+    return buf;
 }
 
-void decode_pcm16le_unsigned(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
-
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int32_t v=(uint16_t)read_16bitLE(stream->offset+i*2,stream->streamfile);
-        outbuf[sample_count]=v-0x8000;
+/* converts samples every src_step bytes to every dst_step samples */
+static void convert_pcm(sample_t* outbuf, int dst_step, const uint8_t* src, int src_step, int samples, pcm_format_t format) {
+    switch (format) {
+        case PCM16_LE:
+#if PCM_NATIVE_LE
+            if (dst_step == 1 && src_step == 0x02) {
+                memcpy(outbuf, src, samples * sizeof(sample_t));
+                break;
+            }
+#endif
+            for (int i = 0; i < samples; i++) {
+                outbuf[i * dst_step] = get_s16le(src + i * src_step);
+            }
+            break;
+
+        case PCM16_BE:
+            for (int i = 0; i < samples; i++) {
+                outbuf[i * dst_step] = get_s16be(src + i * src_step);
+            }
+            break;
+
+        case PCM16_LE_U:
+            for (int i = 0; i < samples; i++) {
+                outbuf[i * dst_step] = (int32_t)get_u16le(src + i * src_step) - 0x8000;
+            }
+            break;
+
+        case PCM8_S:
+            for (int i = 0; i < samples; i++) {
+                outbuf[i * dst_step] = (int8_t)src[i * src_step] * 0x100;
+            }
+            break;
+
+        case PCM8_U:
+            for (int i = 0; i < samples; i++) {
+                outbuf[i * dst_step] = src[i * src_step] * 0x100 - 0x8000;
+            }
+            break;
+
+        case PCM8_SB:
+            for (int i = 0; i < samples; i++) {
+                int16_t v = src[i * src_step];
+                if (v & 0x80) v = 0 - (v & 0x7f);
+                outbuf[i * dst_step] = v * 0x100;
+            }
+            break;
     }
 }
 
-void decode_pcm16be(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
+static void decode_pcm_chunked(STREAMFILE* sf, off_t offset, int src_step, sample_t* outbuf, int dst_step, int samples_to_do, pcm_format_t format) {
+    uint8_t buf[PCM_CHUNK_SIZE];
+    int sample_size = (format == PCM8_S || format == PCM8_U || format == PCM8_SB) ? 0x01 : 0x02;
+    int chunk_samples = PCM_CHUNK_SIZE / src_step;
+    if (chunk_samples < 1) /* huge channel counts */
+        chunk_samples = 1;
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        outbuf[sample_count]=read_16bitBE(stream->offset+i*2,stream->streamfile);
+    while (samples_to_do > 0) {
+        int samples = samples_to_do < chunk_samples ? samples_to_do : chunk_samples;
+        size_t size = (samples - 1) * src_step + sample_size;
+
+        const uint8_t* src = read_pcm_chunk(buf, offset, size, sample_size, sf);
+        convert_pcm(outbuf, dst_step, src, src_step, samples, format);
+
+        offset += samples * src_step;
+        outbuf += samples * dst_step;
+        samples_to_do -= samples;
     }
 }
 
-void decode_pcm16_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int big_endian) {
-    int i, sample_count;
-    int16_t (*read_16bit)(off_t,STREAMFILE*) = big_endian ? read_16bitBE : read_16bitLE;
+void decode_pcm16le(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * 0x02, 0x02, outbuf, channelspacing, samples_to_do, PCM16_LE);
+}
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        outbuf[sample_count]=read_16bit(stream->offset+i*2*channelspacing,stream->streamfile);
-    }
+void decode_pcm16le_unsigned(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * 0x02, 0x02, outbuf, channelspacing, samples_to_do, PCM16_LE_U);
 }
 
-void decode_pcm8(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
+void decode_pcm16be(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * 0x02, 0x02, outbuf, channelspacing, samples_to_do, PCM16_BE);
+}
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        outbuf[sample_count]=read_8bit(stream->offset+i,stream->streamfile)*0x100;
-    }
+void decode_pcm16_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int big_endian) {
+    int step = 0x02 * channelspacing;
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * step, step, outbuf, channelspacing, samples_to_do, big_endian ? PCM16_BE : PCM16_LE);
 }
 
-void decode_pcm8_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
+void decode_pcm8(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample, 0x01, outbuf, channelspacing, samples_to_do, PCM8_S);
+}
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        outbuf[sample_count]=read_8bit(stream->offset+i*channelspacing,stream->streamfile)*0x100;
-    }
+void decode_pcm8_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * channelspacing, channelspacing, outbuf, channelspacing, samples_to_do, PCM8_S);
 }
 
 void decode_pcm8_unsigned(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
-
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int16_t v = (uint8_t)read_8bit(stream->offset+i,stream->streamfile);
-        outbuf[sample_count] = v*0x100 - 0x8000;
-    }
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample, 0x01, outbuf, channelspacing, samples_to_do, PCM8_U);
 }
 
 void decode_pcm8_unsigned_int(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
-
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int16_t v = (uint8_t)read_8bit(stream->offset+i*channelspacing,stream->streamfile);
-        outbuf[sample_count] = v*0x100 - 0x8000;
-    }
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample * channelspacing, channelspacing, outbuf, channelspacing, samples_to_do, PCM8_U);
 }
 
 void decode_pcm8_sb(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    int i;
-    int32_t sample_count;
+    decode_pcm_chunked(stream->streamfile, stream->offset + first_sample, 0x01, outbuf, channelspacing, samples_to_do, PCM8_SB);
+}
 
-    for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        int16_t v = (uint8_t)read_8bit(stream->offset+i,stream->streamfile);
-        if (v&0x80) v = 0-(v&0x7f);
-        outbuf[sample_count] = v*0x100;
+static bool get_pcm_format(VGMSTREAM* v, pcm_format_t* p_format, int* p_sample_size) {
+    switch (v->coding_type) {
+        case coding_PCM16LE:    *p_format = PCM16_LE; *p_sample_size = 0x02; return true;
+        case coding_PCM16BE:    *p_format = PCM16_BE; *p_sample_size = 0x02; return true;
+        case coding_PCM16LE_U:  *p_format = PCM16_LE_U; *p_sample_size = 0x02; return true;
+        case coding_PCM8:       *p_format = PCM8_S; *p_sample_size = 0x01; return true;
+        case coding_PCM8_U:     *p_format = PCM8_U; *p_sample_size = 0x01; return true;
+        case coding_PCM8_SB:    *p_format = PCM8_SB; *p_sample_size = 0x01; return true;
+        default:
+            return false;
+    }
+}
+
+/* Multichannel PCM interleaved every sample (most common layout, like RIFF) is handled by the interleave layout
+ * as one "block" per sample, so it's better treated as a single stream of frames, decoded for all channels at once. */
+bool pcm_is_frame_interleaved(VGMSTREAM* v) {
+    pcm_format_t format;
+    int sample_size;
+
+    if (!get_pcm_format(v, &format, &sample_size))
+        return false;
+    if (v->layout_type != layout_interleave || v->channels < 2 || v->codec_internal_updates)
+        return false;
+    if (v->interleave_block_size != sample_size || v->interleave_first_block_size || v->interleave_last_block_size)
+        return false;
+
+    for (int ch = 1; ch < v->channels; ch++) {
+        if (v->ch[ch].streamfile != v->ch[0].streamfile || v->ch[ch].offset != v->ch[0].offset + ch * sample_size)
+            return false;
     }
+
+    return true;
+}
+
+/* decodes all channels of frame interleaved PCM (see above), first_sample being relative to ch[0].offset */
+void decode_pcm_frame_interleaved(VGMSTREAM* v, sample_t* outbuf, int32_t first_sample, int32_t samples_to_do) {
+    pcm_format_t format;
+    int sample_size;
+
+    if (!get_pcm_format(v, &format, &sample_size))
+        return;
+
+    off_t offset = v->ch[0].offset + first_sample * sample_size * v->channels;
+    decode_pcm_chunked(v->ch[0].streamfile, offset, sample_size, outbuf, 1, samples_to_do * v->channels, format);
 }
 
 void decode_pcm4(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
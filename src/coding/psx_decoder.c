@@ -54,27 +54,16 @@ static const int ps_adpcm_coefs_i[5][2] = {
  * depend on platform, PS3 games use floats, etc). There are rounding diffs between implementations.
  */
 
-/* standard PS-ADPCM (float math version) */
-void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int is_badflags, int config) {
-    uint8_t frame[0x10] = {0};
-    off_t frame_offset;
-    int i, frames_in, sample_count = 0;
-    size_t bytes_per_frame, samples_per_frame;
-    uint8_t coef_index, shift_factor, flag;
-    int32_t hist1 = stream->adpcm_history1_32;
-    int32_t hist2 = stream->adpcm_history2_32;
-    int extended_mode = (config == 1);
-
+/* max frames read at once (callers may ask for many consecutive frames when the layout allows it) */
+#define PSX_BATCH_FRAMES 0x40
 
-    /* external interleave (fixed size), mono */
-    bytes_per_frame = 0x10;
-    samples_per_frame = (bytes_per_frame - 0x02) * 2; /* always 28 */
-    frames_in = first_sample / samples_per_frame;
-    first_sample = first_sample % samples_per_frame;
+static void decode_psx_frame(const uint8_t* frame, off_t frame_offset, sample_t* outbuf, int channelspacing, int first_sample, int samples_to_do, int is_badflags, int extended_mode, int32_t* p_hist1, int32_t* p_hist2) {
+    int i, sample_count = 0;
+    uint8_t coef_index, shift_factor, flag;
+    int32_t hist1 = *p_hist1;
+    int32_t hist2 = *p_hist2;
 
     /* parse frame header */
-    frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
     flag = frame[1]; /* only lower nibble needed */
@@ -115,6 +104,57 @@ void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing,
         hist1 = sample;
     }
 
+    *p_hist1 = hist1;
+    *p_hist2 = hist2;
+}
+
+/* standard PS-ADPCM (float math version), samples_to_do from first_sample may span multiple consecutive frames (read in bulk) */
+void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int is_badflags, int config) {
+    uint8_t frames_buf[0x10 * PSX_BATCH_FRAMES];
+    const uint8_t* data;
+    off_t frame_offset;
+    int frames_in;
+    size_t bytes_per_frame, samples_per_frame;
+    int32_t hist1 = stream->adpcm_history1_32;
+    int32_t hist2 = stream->adpcm_history2_32;
+    int extended_mode = (config == 1);
+
+
+    /* external interleave (fixed size), mono */
+    bytes_per_frame = 0x10;
+    samples_per_frame = (bytes_per_frame - 0x02) * 2; /* always 28 */
+    frames_in = first_sample / samples_per_frame;
+    first_sample = first_sample % samples_per_frame;
+
+    frame_offset = stream->offset + bytes_per_frame * frames_in;
+    while (samples_to_do > 0) {
+        int frames = (first_sample + samples_to_do + samples_per_frame - 1) / samples_per_frame;
+        if (frames > PSX_BATCH_FRAMES)
+            frames = PSX_BATCH_FRAMES;
+        size_t frames_size = frames * bytes_per_frame;
+
+        data = get_streamfile_view(frame_offset, frames_size, stream->streamfile);
+        if (!data) {
+            size_t bytes = read_streamfile(frames_buf, frame_offset, frames_size, stream->streamfile); /* ignore EOF errors */
+            memset(frames_buf + bytes, 0, frames_size - bytes);
+            data = frames_buf;
+        }
+
+        for (int f = 0; f < frames && samples_to_do > 0; f++) {
+            int samples = samples_per_frame - first_sample;
+            if (samples > samples_to_do)
+                samples = samples_to_do;
+
+            decode_psx_frame(data + f * bytes_per_frame, frame_offset + f * bytes_per_frame, outbuf, channelspacing, first_sample, samples, is_badflags, extended_mode, &hist1, &hist2);
+
+            outbuf += samples * channelspacing;
+            samples_to_do -= samples;
+            first_sample = 0;
+        }
+
+        frame_offset += frames_size;
+    }
+
     stream->adpcm_history1_32 = hist1;
     stream->adpcm_history2_32 = hist2;
 }
@@ -125,7 +165,8 @@ void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing,
  *
  * Uses int/float math depending on config (PC/other code may be int, PS3 float). */
 void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int frame_size, int config) {
-    uint8_t frame[0x50] = {0};
+    uint8_t frame_buf[0x50] = {0};
+    const uint8_t* frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -144,7 +185,7 @@ void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int cha
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
 
@@ -185,7 +226,8 @@ void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int cha
 
 /* PS-ADPCM from Pivotal games, exactly like psx_cfg but with float math (reverse engineered from the exe) */
 void decode_psx_pivotal(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int frame_size) {
-    uint8_t frame[0x50] = {0};
+    uint8_t frame_buf[0x50] = {0};
+    const uint8_t* frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -202,7 +244,7 @@ void decode_psx_pivotal(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channels
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = read_streamfile_view(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
 
@@ -12,6 +12,13 @@ typedef struct {
     float fbuf[RELIC_SAMPLES_PER_FRAME * RELIC_MAX_CHANNELS];
 
     int32_t discard;
+
+    /* state at loop start, since seeking needs to decode from the beginning */
+    relic_handle_t* loop_handle;
+    float loop_fbuf[RELIC_SAMPLES_PER_FRAME * RELIC_MAX_CHANNELS];
+    decode_state_t loop_ds;
+    int32_t loop_discard;
+    bool loop_saved;
 } relic_codec_data;
 
 
@@ -20,6 +27,7 @@ static void free_relic(void* priv_data) {
     if (!data) return;
 
     relic_free(data->handle);
+    relic_free(data->loop_handle);
     free(data);
 }
 
@@ -88,6 +96,7 @@ static void reset_relic(void* priv_data) {
 
     relic_reset(data->handle);
     data->discard = 0;
+    data->loop_saved = false;
 }
 
 static void seek_relic(VGMSTREAM* v, int32_t num_sample) {
@@ -98,6 +107,40 @@ static void seek_relic(VGMSTREAM* v, int32_t num_sample) {
     data->discard = num_sample;
 }
 
+static bool snapshot_relic(VGMSTREAM* v) {
+    relic_codec_data* data = v->codec_data;
+    decode_state_t* ds = v->decode_state;
+    if (!data) return false;
+
+    if (!data->loop_handle) {
+        data->loop_handle = relic_clone(data->handle);
+        if (!data->loop_handle)
+            return false;
+    }
+    else {
+        relic_copy(data->loop_handle, data->handle);
+    }
+
+    /* pending samples in ds point to fbuf */
+    memcpy(data->loop_fbuf, data->fbuf, sizeof(data->fbuf));
+    data->loop_ds = *ds;
+    data->loop_discard = data->discard;
+    data->loop_saved = true;
+    return true;
+}
+
+static bool restore_relic(VGMSTREAM* v) {
+    relic_codec_data* data = v->codec_data;
+    decode_state_t* ds = v->decode_state;
+    if (!data || !data->loop_saved) return false;
+
+    relic_copy(data->handle, data->loop_handle);
+    memcpy(data->fbuf, data->loop_fbuf, sizeof(data->fbuf));
+    *ds = data->loop_ds;
+    data->discard = data->loop_discard;
+    return true;
+}
+
 int32_t relic_bytes_to_samples(size_t bytes, int channels, int bitrate) {
     int frame_size = bitrate / 8;
     if (channels <= 0 || frame_size <= 0)
@@ -111,4 +154,6 @@ const codec_info_t relic_decoder = {
     .free = free_relic,
     .reset = reset_relic,
     .seek = seek_relic,
+    .snapshot = snapshot_relic,
+    .restore = restore_relic,
 };
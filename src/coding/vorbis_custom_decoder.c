@@ -24,7 +24,7 @@ void free_vorbis_custom(void* priv_data) {
     vorbis_info_clear(&data->vi);
 
     free(data->buffer);
-    free(data->fbuf);
+    free(data->planes);
     free(data);
 }
 
@@ -165,9 +165,9 @@ static int copy_samples(VGMSTREAM* v) {
 
     //TODO: helper?
     //TODO: maybe should init in init_vorbis_custom but right now not all vorbises pass channels
-    if (data->fbuf == NULL) {
-        data->fbuf = malloc(VORBIS_CALL_SAMPLES * sizeof(float) * v->channels);
-        if (!data->fbuf) return -1;
+    if (data->planes == NULL) {
+        data->planes = calloc(v->channels, sizeof(void*));
+        if (!data->planes) return -1;
     }
 
     // get PCM samples from libvorbis buffers
@@ -180,10 +180,10 @@ static int copy_samples(VGMSTREAM* v) {
     if (samples == 0)
         return 0;
 
-    // vorbis's planar buffer to interleaved buffer
-    sbuf_init_flt(&ds->sbuf, data->fbuf, samples, v->channels);
+    // use vorbis's planar buffers directly (data stays until next vorbis_synthesis_blockin)
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, data->planes, samples, v->channels);
     ds->sbuf.filled = samples;
-    sbuf_interleave(&ds->sbuf, pcm);
+    sbuf_set_planes(&ds->sbuf, pcm);
 
     // mark consumed samples from the buffer
     //  (non-consumed samples are returned in next vorbis_synthesis_pcmout calls)
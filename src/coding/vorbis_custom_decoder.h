@@ -24,7 +24,7 @@ struct vorbis_custom_codec_data {
 
     uint8_t* buffer;            /* internal raw data buffer */
     size_t buffer_size;
-    float* fbuf;
+    void** planes;              /* current vorbis buffers per channel (not owned) */
 
     int current_discard;        /* for looping purposes */
 
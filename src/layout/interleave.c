@@ -1,6 +1,7 @@
 #include "layout.h"
 #include "../vgmstream.h"
 #include "../base/decode.h"
+#include "../coding/coding.h"
 
 
 typedef struct {
@@ -138,6 +139,39 @@ static void update_offsets(layout_config_t* layout, VGMSTREAM* vgmstream, int* p
 }
 
 
+/* PCM interleaved every sample, decoded like a flat layout (all channels at once) instead of
+ * one sample per block. Offsets aren't moved, so samples_into_block is the position from start. */
+static rc_t render_layout_interleave_pcm(sbuf_t* sdst, VGMSTREAM* vgmstream) {
+    int samples_this_block = vgmstream->num_samples; /* do all samples if possible */
+
+    while (sdst->filled < sdst->samples) {
+
+        if (vgmstream->loop_flag && decode_do_loop(vgmstream)) {
+            /* handle looping */
+            continue;
+        }
+
+        int samples_to_do = decode_get_samples_to_do(samples_this_block, 1, vgmstream);
+        if (samples_to_do > sdst->samples - sdst->filled)
+            samples_to_do = sdst->samples - sdst->filled;
+
+        if (samples_to_do <= 0) {
+            VGM_LOG_ONCE("INTERLEAVE: wrong samples_to_do\n");
+            return RC_LAYOUT_ERROR;
+        }
+
+        sample_t* buf = sdst->buf;
+        buf += sdst->filled * vgmstream->channels;
+        decode_pcm_frame_interleaved(vgmstream, buf, vgmstream->samples_into_block, samples_to_do);
+        sdst->filled += samples_to_do;
+
+        vgmstream->current_sample += samples_to_do;
+        vgmstream->samples_into_block += samples_to_do;
+    }
+
+    return RC_RENDER_OK;
+}
+
 /* Decodes samples for interleaved streams.
  * Data has interleaved chunks per channel, and once one is decoded the layout moves offsets,
  * skipping other chunks (essentially a simplified variety of blocked layout).
@@ -145,6 +179,10 @@ static void update_offsets(layout_config_t* layout, VGMSTREAM* vgmstream, int* p
 rc_t render_layout_interleave(sbuf_t* sdst, VGMSTREAM* vgmstream) {
     layout_config_t layout = {0};
 
+    /* blocks of one sample; offsets stay contiguous between blocks so this is consistent between calls */
+    if (pcm_is_frame_interleaved(vgmstream))
+        return render_layout_interleave_pcm(sdst, vgmstream);
+
     if (!setup_helper(&layout, vgmstream)) {
         VGM_LOG_ONCE("INTERLEAVE: wrong config found\n");
         return RC_LAYOUT_ERROR;
@@ -10,13 +10,103 @@
 #define VGMSTREAM_LAYER_SAMPLE_BUFFER 8192
 
 
+static void render_layers(sbuf_t* sdst, layered_layout_data* data, int samples_to_do) {
+    sbuf_t ssrc_tmp;
+    sbuf_t* ssrc = &ssrc_tmp;
+
+    int ch = 0;
+    for (int current_layer = 0; current_layer < data->layer_count; current_layer++) {
+        VGMSTREAM* vl = data->layers[current_layer];
+
+        // layers may have their own number of channels/format (buf is as big as needed)
+        sfmt_t format = mixing_get_input_sample_type(vl);
+        sbuf_init(ssrc, format, data->buffer, samples_to_do, vl->channels);
+
+        rc_t rc = render_main(ssrc, vl);
+
+        //TODO: handle when some layers stop before others
+        if (rc < 0) {
+            VGM_LOG("LAYERED: render error\n");
+            sbuf_silence_rest(ssrc);
+        }
+
+
+        // mix layer samples to main samples
+        sbuf_copy_layers(sdst, ssrc, ch, samples_to_do);
+        ch += ssrc->channels;
+    }
+}
+
+/* each layer has its own buf when rendering in parallel */
+static bool setup_layer_buffers(layered_layout_data* data) {
+    if (data->layer_buffer)
+        return true;
+
+    size_t total_size = 0;
+    for (int i = 0; i < data->layer_count; i++) {
+        int input_channels;
+        mixing_info(data->layers[i], &input_channels, NULL);
+        int sample_size = sfmt_get_sample_size(mixing_get_input_sample_type(data->layers[i]));
+        total_size += VGMSTREAM_LAYER_SAMPLE_BUFFER * input_channels * sample_size;
+    }
+
+    data->layer_sbufs = calloc(data->layer_count, sizeof(sbuf_t));
+    data->layer_buffer = malloc(total_size);
+    if (!data->layer_sbufs || !data->layer_buffer) {
+        free(data->layer_sbufs);
+        free(data->layer_buffer);
+        data->layer_sbufs = NULL;
+        data->layer_buffer = NULL;
+        data->pool = NULL; /* render normally */
+        return false;
+    }
+
+    return true;
+}
+
+static void render_layer_job(void* arg, int index) {
+    layered_layout_data* data = arg;
+    sbuf_t* ssrc = &data->layer_sbufs[index];
+
+    rc_t rc = render_main(ssrc, data->layers[index]);
+
+    if (rc < 0) {
+        VGM_LOG("LAYERED: render error\n");
+        sbuf_silence_rest(ssrc);
+    }
+}
+
+/* layers are independent (own SFs and codec state), so they can be rendered at once then mixed in order */
+static void render_layers_pool(sbuf_t* sdst, layered_layout_data* data, int samples_to_do) {
+    uint8_t* buf = data->layer_buffer;
+
+    for (int current_layer = 0; current_layer < data->layer_count; current_layer++) {
+        VGMSTREAM* vl = data->layers[current_layer];
+        int input_channels;
+        mixing_info(vl, &input_channels, NULL);
+
+        sfmt_t format = mixing_get_input_sample_type(vl);
+        sbuf_init(&data->layer_sbufs[current_layer], format, buf, samples_to_do, vl->channels);
+        buf += VGMSTREAM_LAYER_SAMPLE_BUFFER * input_channels * sfmt_get_sample_size(format);
+    }
+
+    thread_pool_run(data->pool, render_layer_job, data, data->layer_count);
+
+    int ch = 0;
+    for (int current_layer = 0; current_layer < data->layer_count; current_layer++) {
+        sbuf_t* ssrc = &data->layer_sbufs[current_layer];
+
+        sbuf_copy_layers(sdst, ssrc, ch, samples_to_do);
+        ch += ssrc->channels;
+    }
+}
+
+
 /* Decodes samples for layered streams.
  * Each decoded vgmstream 'layer' (which may have different codecs and number of channels)
  * is mixed into a final buffer, creating a single super-vgmstream. */
 rc_t render_layout_layered(sbuf_t* sdst, VGMSTREAM* vgmstream) {
     layered_layout_data* data = vgmstream->layout_data;
-    sbuf_t ssrc_tmp;
-    sbuf_t* ssrc = &ssrc_tmp;
 
     int samples_per_frame = VGMSTREAM_LAYER_SAMPLE_BUFFER;
     int samples_this_block = vgmstream->num_samples; /* do all samples if possible */
@@ -45,27 +135,10 @@ rc_t render_layout_layered(sbuf_t* sdst, VGMSTREAM* vgmstream) {
 
         //TODO: extract only up to min filled as different layers may fill differently
         /* decode all layers */
-        int ch = 0;
-        for (int current_layer = 0; current_layer < data->layer_count; current_layer++) {
-            VGMSTREAM* vl = data->layers[current_layer];
-
-            // layers may have their own number of channels/format (buf is as big as needed)
-            sfmt_t format = mixing_get_input_sample_type(vl);
-            sbuf_init(ssrc, format, data->buffer, samples_to_do, vl->channels);
-
-            rc_t rc = render_main(ssrc, vl);
-
-            //TODO: handle when some layers stop before others
-            if (rc < 0) {
-                VGM_LOG("LAYERED: render error\n");
-                sbuf_silence_rest(ssrc);
-            }
-
-
-            // mix layer samples to main samples
-            sbuf_copy_layers(sdst, ssrc, ch, samples_to_do);
-            ch += ssrc->channels;
-        }
+        if (data->pool && setup_layer_buffers(data))
+            render_layers_pool(sdst, data, samples_to_do);
+        else
+            render_layers(sdst, data, samples_to_do);
 
         sdst->filled += samples_to_do;
         vgmstream->current_sample += samples_to_do;
@@ -89,6 +162,26 @@ void seek_layout_layered(VGMSTREAM* vgmstream, int32_t seek_sample) {
     vgmstream->samples_into_block = seek_sample;
 }
 
+/* sets a pool to render top-most layers in parallel (including layers inside segments).
+ * Nested layers are rendered inside their parent's job as usual. Pool may be used at the same time
+ * by other threads (ex. segment preroll), in which case one of them renders its layers serially. */
+void setup_layout_layered_pool(VGMSTREAM* vgmstream, thread_pool_t* pool) {
+    if (!vgmstream)
+        return;
+
+    if (vgmstream->layout_type == layout_layered) {
+        layered_layout_data* data = vgmstream->layout_data;
+        if (data->layer_count > 1)
+            data->pool = pool;
+    }
+    else if (vgmstream->layout_type == layout_segmented) {
+        segmented_layout_data* data = vgmstream->layout_data;
+        for (int i = 0; i < data->segment_count; i++) {
+            setup_layout_layered_pool(data->segments[i], pool);
+        }
+    }
+}
+
 void loop_layout_layered(VGMSTREAM* vgmstream, int32_t loop_sample) {
     layered_layout_data* data = vgmstream->layout_data;
 
@@ -225,6 +318,8 @@ void free_layout_layered(layered_layout_data* data) {
     }
     free(data->layers);
     free(data->buffer);
+    free(data->layer_buffer);
+    free(data->layer_sbufs);
     free(data);
 }
 
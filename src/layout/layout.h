@@ -5,6 +5,7 @@
 #include "../vgmstream.h"
 #include "../util/reader_sf.h"
 #include "../util/log.h"
+#include "../util/thread_pool.h"
 #include "../base/sbuf.h"
 #include "../base/rc.h"
 
@@ -26,6 +27,9 @@ typedef struct {
     int output_channels;    // resulting channels (after mixing, if applied)
     bool mixed_channels;    // segments have different number of channels //TODO remove
     sfmt_t fmt;
+
+    struct segmented_preroll_t* preroll; // decodes start of next segment in the background (optional)
+    struct segmented_lazy_t* lazy;       // reopens segments on demand (optional)
 } segmented_layout_data;
 
 rc_t render_layout_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream);
@@ -35,6 +39,10 @@ void free_layout_segmented(segmented_layout_data* data);
 void reset_layout_segmented(segmented_layout_data* data);
 void seek_layout_segmented(VGMSTREAM* vgmstream, int32_t seek_sample);
 void loop_layout_segmented(VGMSTREAM* vgmstream, int32_t loop_sample);
+void setup_layout_segmented_preroll(VGMSTREAM* vgmstream);
+/* Suspends segments that aren't playing and reopens them from filenames[i]/subsongs[i] (relative to sf) when needed.
+ * Segments with a NULL filename are kept open. Must be called after setup_layout_segmented. */
+bool setup_layout_segmented_lazy(segmented_layout_data* data, STREAMFILE* sf, const char** filenames, const int* subsongs);
 
 
 /* layered layout */
@@ -48,6 +56,10 @@ typedef struct {
     int external_looping;   // don't loop using per-layer loops, but layout's own looping
     int curr_layer;         // helper
     sfmt_t fmt;
+
+    thread_pool_t* pool;    // if set, layers are rendered in parallel into their own bufs (not owned)
+    void* layer_buffer;     // all layer bufs when using pool
+    sbuf_t* layer_sbufs;
 } layered_layout_data;
 
 rc_t render_layout_layered(sbuf_t* sbuf, VGMSTREAM* vgmstream);
@@ -57,6 +69,7 @@ void free_layout_layered(layered_layout_data* data);
 void reset_layout_layered(layered_layout_data* data);
 void seek_layout_layered(VGMSTREAM* vgmstream, int32_t seek_sample);
 void loop_layout_layered(VGMSTREAM* vgmstream, int32_t loop_sample);
+void setup_layout_layered_pool(VGMSTREAM* vgmstream, thread_pool_t* pool);
 
 
 /* blocked layouts */
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "layout.h"
 #include "../vgmstream.h"
 #include "../base/seek.h"
@@ -5,11 +6,273 @@
 #include "../base/mixing.h"
 #include "../base/play_state.h"
 #include "../base/render.h"
+#include "../util/threads.h"
+#include "../util/sf_utils.h"
+#include "../vgmstream_init.h"
 
 #define VGMSTREAM_MAX_SEGMENTS 1024
 #define VGMSTREAM_SEGMENT_SAMPLE_BUFFER 8192
 
 
+/* Optional lazy opening: in long playlists (ex. TXTP with hundreds of segments) keeping every segment's
+ * decoder and files open wastes memory and file handles, so segments that aren't playing are suspended
+ * (see vgmstream_suspend) and reopened from their source when needed. Reopens are done by whoever
+ * is going to decode the segment (main thread or preroll worker), serialized as both share the base SF. */
+typedef struct {
+    char* filename;         // NULL if segment can't be reopened
+    int subsong;
+    bool failed;            // reopen was tried and failed (segment can't be decoded)
+} segmented_source_t;
+
+typedef struct segmented_lazy_t {
+    STREAMFILE* sf;         // base for relative filenames
+    segmented_source_t* sources;
+    vgm_mutex_t* mutex;     // for sf and suspend/resume
+} segmented_lazy_t;
+
+/* reopens segment if suspended, returns false if it can't be decoded */
+static bool lazy_resume(segmented_layout_data* data, int segment) {
+    VGMSTREAM* vs = data->segments[segment];
+    if (!vs->suspended)
+        return true;
+
+    segmented_lazy_t* lazy = data->lazy;
+    if (!lazy || !lazy->sources[segment].filename)
+        return false;
+    segmented_source_t* source = &lazy->sources[segment];
+
+    vgm_mutex_lock(lazy->mutex);
+
+    bool resumed = false;
+    STREAMFILE* temp_sf = NULL;
+    if (!source->failed)
+        temp_sf = open_streamfile_by_absname(lazy->sf, source->filename);
+    if (temp_sf) {
+        temp_sf->stream_index = source->subsong;
+
+        VGMSTREAM* new_vs = detect_vgmstream_format_id(temp_sf, vs->format_id);
+        close_streamfile(temp_sf);
+        if (new_vs)
+            resumed = vgmstream_resume(vs, new_vs);
+    }
+
+    bool logged = source->failed;
+    if (!resumed)
+        source->failed = true;
+
+    vgm_mutex_unlock(lazy->mutex);
+
+    if (!resumed && !logged) {
+        // file may have been moved/changed while playing
+        vgm_logi("SEGMENTED: can't reopen segment %i (%s#%i)\n", segment, source->filename, source->subsong);
+    }
+
+    return resumed;
+}
+
+/* closes a segment that won't be played for a while */
+static void lazy_suspend(segmented_layout_data* data, int segment) {
+    if (!data->lazy || !data->lazy->sources[segment].filename)
+        return;
+
+    // segments may be repeated, can't touch the one being played
+    VGMSTREAM* vs = data->segments[segment];
+    if (vs == data->segments[data->current_segment])
+        return;
+
+    vgm_mutex_lock(data->lazy->mutex);
+    vgmstream_suspend(vs);
+    vgm_mutex_unlock(data->lazy->mutex);
+}
+
+static void lazy_free(segmented_lazy_t* lazy, int segment_count) {
+    if (!lazy)
+        return;
+
+    if (lazy->sources) {
+        for (int i = 0; i < segment_count; i++) {
+            free(lazy->sources[i].filename);
+        }
+    }
+    free(lazy->sources);
+    close_streamfile(lazy->sf);
+    vgm_mutex_free(lazy->mutex);
+    free(lazy);
+}
+
+
+/* Optional preroll: while a segment plays, a worker thread resets the next one and decodes its first
+ * samples, so segment changes don't stall on heavy codec setup (ex. FFmpeg/Vorbis init, MPEG delay).
+ * Main thread only uses the current segment and the worker only the next one, and anything that moves
+ * segments around (seek/loop/reset) waits for the worker first. */
+typedef struct segmented_preroll_t {
+    vgm_thread_t* thread;
+    vgm_sem_t* sem_request;
+    vgm_sem_t* sem_done;
+    bool pending;           // worker is decoding 'segment'
+    bool exit;
+    bool failed;            // no threads, segments are decoded as usual
+
+    int segment;            // segment in sbuf, -1 if none
+    bool active;            // sbuf belongs to current segment and is being consumed
+    sbuf_t sbuf;
+    void* buffer;
+} segmented_preroll_t;
+
+static void preroll_worker(void* arg) {
+    segmented_layout_data* data = arg;
+    segmented_preroll_t* preroll = data->preroll;
+
+    while (true) {
+        vgm_sem_wait(preroll->sem_request);
+        if (preroll->exit)
+            break;
+
+        VGMSTREAM* vs = data->segments[preroll->segment];
+        bool resumed = lazy_resume(data, preroll->segment);
+        reset_vgmstream(vs);
+
+        int samples = vgmstream_get_samples(vs);
+        if (samples > VGMSTREAM_SEGMENT_SAMPLE_BUFFER)
+            samples = VGMSTREAM_SEGMENT_SAMPLE_BUFFER;
+
+        sfmt_t segment_format = mixing_get_input_sample_type(vs);
+        sbuf_init(&preroll->sbuf, segment_format, preroll->buffer, samples, vs->channels);
+        if (resumed)
+            render_main(&preroll->sbuf, vs); // on errors keeps what was rendered, like regular segment decoding
+
+        vgm_sem_post(preroll->sem_done);
+    }
+}
+
+static void preroll_wait(segmented_preroll_t* preroll) {
+    if (!preroll->pending)
+        return;
+    vgm_sem_wait(preroll->sem_done);
+    preroll->pending = false;
+}
+
+/* forgets prerolled samples, for when segments may change externally */
+static void preroll_invalidate(segmented_layout_data* data) {
+    segmented_preroll_t* preroll = data->preroll;
+    if (!preroll)
+        return;
+
+    preroll_wait(preroll);
+    if (preroll->segment >= 0 && preroll->segment != data->current_segment)
+        lazy_suspend(data, preroll->segment);
+    preroll->segment = -1;
+    preroll->active = false;
+}
+
+/* starts decoding the segment after current (if not done and not in use) */
+static void preroll_request(segmented_layout_data* data) {
+    segmented_preroll_t* preroll = data->preroll;
+    if (!preroll || preroll->failed || preroll->pending || preroll->active)
+        return;
+
+    int next = data->current_segment + 1;
+    if (next >= data->segment_count || preroll->segment == next)
+        return;
+    // segments may be repeated, can't touch the one being played
+    if (data->segments[next] == data->segments[data->current_segment])
+        return;
+
+    if (!preroll->thread) {
+        preroll->thread = vgm_thread_create(preroll_worker, data);
+        if (!preroll->thread) {
+            preroll->failed = true;
+            return;
+        }
+    }
+
+    preroll->segment = next;
+    preroll->pending = true;
+    vgm_sem_post(preroll->sem_request);
+}
+
+/* called when current segment changes, returns true if prerolled (already reset) */
+static bool preroll_take(segmented_layout_data* data) {
+    segmented_preroll_t* preroll = data->preroll;
+    if (!preroll)
+        return false;
+
+    preroll_wait(preroll);
+    if (preroll->segment != data->current_segment) {
+        preroll->segment = -1;
+        preroll->active = false;
+        return false;
+    }
+
+    preroll->active = true;
+    return true;
+}
+
+/* copies prerolled samples of the current segment, returns samples done */
+static int preroll_copy(segmented_layout_data* data, sbuf_t* sbuf, int samples_to_do) {
+    segmented_preroll_t* preroll = data->preroll;
+    if (!preroll || !preroll->active)
+        return 0;
+
+    int samples = preroll->sbuf.filled;
+    if (samples > samples_to_do)
+        samples = samples_to_do;
+
+    sbuf_copy_segments(sbuf, &preroll->sbuf, samples);
+    sbuf_consume(&preroll->sbuf, samples);
+
+    if (preroll->sbuf.filled == 0) {
+        // segment continues normally from where the worker left it
+        preroll->active = false;
+        preroll_request(data);
+    }
+
+    return samples;
+}
+
+static void preroll_free(segmented_preroll_t* preroll) {
+    if (!preroll)
+        return;
+
+    if (preroll->thread) {
+        preroll_wait(preroll);
+        preroll->exit = true;
+        vgm_sem_post(preroll->sem_request);
+        vgm_thread_join(preroll->thread);
+    }
+    vgm_sem_free(preroll->sem_request);
+    vgm_sem_free(preroll->sem_done);
+    free(preroll->buffer);
+    free(preroll);
+}
+
+static bool preroll_init(segmented_layout_data* data) {
+    segmented_preroll_t* preroll = NULL;
+
+    if (data->preroll)
+        return true;
+
+    preroll = calloc(1, sizeof(segmented_preroll_t));
+    if (!preroll) goto fail;
+
+    preroll->segment = -1;
+    preroll->sem_request = vgm_sem_init(0);
+    preroll->sem_done = vgm_sem_init(0);
+    if (!preroll->sem_request || !preroll->sem_done) goto fail;
+
+    // same as data->buffer
+    int sample_size = sfmt_get_sample_size(data->fmt);
+    preroll->buffer = malloc(VGMSTREAM_SEGMENT_SAMPLE_BUFFER * data->input_channels * sample_size);
+    if (!preroll->buffer) goto fail;
+
+    data->preroll = preroll;
+    return true;
+fail:
+    preroll_free(preroll);
+    return false;
+}
+
+
 /* Decodes samples for segmented streams.
  * Chains together sequential vgmstreams, for data divided into separate sections or files
  * (like one part for intro and other for loop segments, which may even use different codecs). */
@@ -24,6 +287,11 @@ rc_t render_layout_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
         return RC_LAYOUT_ERROR;
     }
 
+    // in case of resets
+    lazy_resume(data, data->current_segment);
+
+    preroll_request(data);
+
     int current_channels = 0;
     VGMSTREAM* vs = data->segments[data->current_segment];
     mixing_info(vs, NULL, &current_channels);
@@ -47,6 +315,7 @@ rc_t render_layout_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
         /* detect segment change and restart (after loop, but before decode, to allow looping to kick in) */
         if (vgmstream->samples_into_block >= samples_this_block) {
             //;VGM_LOG("SEGMENTED: next segment\n");
+            int prev_segment = data->current_segment;
             data->current_segment++;
 
             if (data->current_segment >= data->segment_count) { /* when decoding more than num_samples */
@@ -55,7 +324,11 @@ rc_t render_layout_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
             }
 
             vs = data->segments[data->current_segment];
-            reset_vgmstream(vs); // in case of looping spanning multiple segments
+            if (!preroll_take(data)) {
+                lazy_resume(data, data->current_segment);
+                reset_vgmstream(vs); // in case of looping spanning multiple segments
+            }
+            lazy_suspend(data, prev_segment);
 
             samples_this_block = vgmstream_get_samples(vs);
             mixing_info(vs, NULL, &current_channels);
@@ -75,8 +348,25 @@ rc_t render_layout_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
             return RC_LAYOUT_ERROR;
         }
 
+        // use samples decoded in advance first
+        int preroll_done = preroll_copy(data, sbuf, samples_to_do);
+        if (preroll_done > 0) {
+            vgmstream->current_sample += preroll_done;
+            vgmstream->samples_into_block += preroll_done;
+            continue;
+        }
+
         vs = data->segments[data->current_segment];
 
+        // couldn't be reopened (logged in lazy_resume), keep timing so next segments play as usual
+        if (vs->suspended) {
+            sbuf_silence_part(sbuf, sbuf->filled, samples_to_do);
+            sbuf->filled += samples_to_do;
+            vgmstream->current_sample += samples_to_do;
+            vgmstream->samples_into_block += samples_to_do;
+            continue;
+        }
+
         sfmt_t segment_format = mixing_get_input_sample_type(vs);
         sbuf_init(ssrc, segment_format, data->buffer, samples_to_do, vs->channels);
 
@@ -113,6 +403,8 @@ void seek_layout_segmented(VGMSTREAM* vgmstream, int32_t seek_sample) {
     segmented_layout_data* data = vgmstream->layout_data;
     //;VGM_LOG("SEEK [segmented]: seek_sample=%i\n", seek_sample);
 
+    preroll_invalidate(data);
+
     int segment = 0;
     int total_samples = 0;
     while (total_samples < vgmstream->num_samples) {
@@ -128,8 +420,12 @@ void seek_layout_segmented(VGMSTREAM* vgmstream, int32_t seek_sample) {
             int32_t seek_relative = seek_sample - total_samples;
             //;VGM_LOG("SEEK [segmented]: found segment=%i, seek_relative=%i (total=%i, target=%i)\n", segment, seek_relative, total_samples, seek_sample);
 
-            seek_vgmstream(data->segments[segment], seek_relative);
+            int prev_segment = data->current_segment;
+            if (lazy_resume(data, segment))
+                seek_vgmstream(data->segments[segment], seek_relative);
             data->current_segment = segment;
+            if (prev_segment != segment)
+                lazy_suspend(data, prev_segment);
 
             vgmstream->current_sample = seek_sample; 
             vgmstream->samples_into_block = seek_relative; //relative to current segment
@@ -150,6 +446,68 @@ void loop_layout_segmented(VGMSTREAM* vgmstream, int32_t loop_sample) {
     //;VGM_LOG("SEGMENTED: loop layout done: segment=%i, into=%i\n", data->current_segment, vgmstream->samples_into_block);
 }
 
+/* enables preroll in top-most segments (including segments inside layers).
+ * Nested segments are decoded inside their parent's thread as usual. */
+void setup_layout_segmented_preroll(VGMSTREAM* vgmstream) {
+    if (!vgmstream)
+        return;
+
+    if (vgmstream->layout_type == layout_segmented) {
+        segmented_layout_data* data = vgmstream->layout_data;
+        if (data->segment_count > 1)
+            preroll_init(data);
+    }
+    else if (vgmstream->layout_type == layout_layered) {
+        layered_layout_data* data = vgmstream->layout_data;
+        for (int i = 0; i < data->layer_count; i++) {
+            setup_layout_segmented_preroll(data->layers[i]);
+        }
+    }
+}
+
+bool setup_layout_segmented_lazy(segmented_layout_data* data, STREAMFILE* sf, const char** filenames, const int* subsongs) {
+    segmented_lazy_t* lazy = NULL;
+
+    if (!data || !sf || !filenames || !subsongs || data->lazy)
+        return false;
+
+    lazy = calloc(1, sizeof(segmented_lazy_t));
+    if (!lazy) goto fail;
+
+    lazy->sources = calloc(data->segment_count, sizeof(segmented_source_t));
+    if (!lazy->sources) goto fail;
+
+    lazy->sf = reopen_streamfile(sf, 0);
+    if (!lazy->sf) goto fail;
+
+    lazy->mutex = vgm_mutex_init();
+    if (!lazy->mutex) goto fail;
+
+    for (int i = 0; i < data->segment_count; i++) {
+        // only simple streams can be suspended
+        if (!filenames[i] || data->segments[i]->layout_data)
+            continue;
+
+        size_t len = strlen(filenames[i]) + 1;
+        lazy->sources[i].filename = malloc(len);
+        if (!lazy->sources[i].filename) goto fail;
+        memcpy(lazy->sources[i].filename, filenames[i], len);
+        lazy->sources[i].subsong = subsongs[i];
+    }
+
+    data->lazy = lazy;
+
+    for (int i = 0; i < data->segment_count; i++) {
+        if (i != data->current_segment)
+            lazy_suspend(data, i);
+    }
+
+    return true;
+fail:
+    lazy_free(lazy, data->segment_count);
+    return false;
+}
+
 
 segmented_layout_data* init_layout_segmented(int segment_count) {
     segmented_layout_data* data = NULL;
@@ -277,6 +635,9 @@ void free_layout_segmented(segmented_layout_data* data) {
     if (!data)
         return;
 
+    // stop before closing segments
+    preroll_free(data->preroll);
+
     for (int i = 0; i < data->segment_count; i++) {
         bool is_repeat = false;
 
@@ -292,6 +653,7 @@ void free_layout_segmented(segmented_layout_data* data) {
             continue;
         close_vgmstream(data->segments[i]);
     }
+    lazy_free(data->lazy, data->segment_count);
     free(data->segments);
     free(data->buffer);
     free(data);
@@ -301,6 +663,8 @@ void reset_layout_segmented(segmented_layout_data* data) {
     if (!data)
         return;
 
+    preroll_invalidate(data);
+
     for (int i = 0; i < data->segment_count; i++) {
         reset_vgmstream(data->segments[i]);
     }
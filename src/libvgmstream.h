@@ -73,7 +73,7 @@
  * - vgmstream's features are mostly stable, but this API may be tweaked from time to time
  */
 #define LIBVGMSTREAM_API_VERSION_MAJOR 0x01    // breaking API/ABI changes
-#define LIBVGMSTREAM_API_VERSION_MINOR 0x01    // compatible API/ABI changes
+#define LIBVGMSTREAM_API_VERSION_MINOR 0x02    // compatible API/ABI changes
 #define LIBVGMSTREAM_API_VERSION_PATCH 0x00    // fixes
 
 /* Current API version, for dynamic checks. returns hex value: 0xMMmmpppp = MM-major, mm-minor, pppp-patch
@@ -207,8 +207,25 @@ typedef struct {
 
     libvgmstream_sfmt_t force_sfmt;         // forces output buffer to be remixed into some sample format
 
-  //int format_id;                          // force a format (for example when loading new subsong of the same archive, for a minuscule speed up)
-  //                                        // ** only applies when called before _open_stream
+    int format_id;                          // try this format first (for example when loading new subsongs of the same archive, to skip detection)
+                                            // ** use format->format_id from a previous _open_stream; 0 = not set (regular detection)
+                                            // ** falls back to regular detection if that format rejects the file
+                                            // ** only applies when called before _open_stream
+
+    bool profile_detection;                 // save time and reads done by each format tried during _open_stream
+                                            // ** slightly slower, mainly for testing (see libvgmstream_get_detection)
+
+    bool read_ahead;                        // read file data ahead in a background thread while playing (for slow storage)
+                                            // ** only applies when called before _open_stream
+                                            // ** libsf doesn't need to be thread-safe, but must not be shared with other threads
+
+    int layer_threads;                      // render layers of multi-layer files in parallel using up to N threads (<0 = number of CPUs)
+                                            // ** 0/1 = disabled (default); only applies when called before _open_stream
+                                            // ** libsf must be safe to use from multiple threads, as each layer opens and reads its own files
+
+    bool segment_preroll;                   // decode start of the next segment of multi-segment files in a background thread
+                                            // ** avoids stalls when changing segments with heavy codecs (for low latency playback)
+                                            // ** only applies when called before _open_stream; same libsf requirements as layer_threads
 
 } libvgmstream_config_t;
 
@@ -269,6 +286,61 @@ LIBVGMSTREAM_API void libvgmstream_reset(libvgmstream_t* lib);
 LIBVGMSTREAM_API libvgmstream_t* libvgmstream_create(libstreamfile_t* libsf, int subsong, libvgmstream_config_t* cfg);
 
 
+/* info of a format tried during _open_stream (when config's profile_detection is set) */
+typedef struct {
+    int format_id;                          // format's ID (same as format->format_id when accepted)
+    bool accepted;                          // format recognized the file (last entry)
+    int64_t time_us;                        // time spent parsing (microseconds)
+    int64_t reads;                          // read calls done to the file
+    int64_t bytes;                          // bytes read
+    int64_t seeks;                          // reads that don't start where the previous one ended
+    int64_t rebuffers;                      // estimated buffer refills (reads outside the last buffered window)
+                                            // ** reads done to companion files aren't counted
+} libvgmstream_detection_t;
+
+/* Gets formats tried during last _open_stream, in order, if config's profile_detection was set.
+ * - returns number of entries (may be 0), or < 0 on error
+ * - also valid if _open_stream failed (file not recognised)
+ * - entries are valid until next _open_stream or _free
+ */
+LIBVGMSTREAM_API int libvgmstream_get_detection(libvgmstream_t* lib, const libvgmstream_detection_t** p_entries);
+
+
+/* IO stats of one layer of vgmstream's internal IO (see libvgmstream_io_stats_t) */
+typedef struct {
+    const char* type;                       // layer type ("stdio", "buffer", "clamp", "api", etc; "mixed" if files differ, NULL if unknown)
+    int64_t reads;                          // read calls (including internal zero-copy reads)
+    int64_t bytes;                          // bytes returned
+    int64_t hits;                           // reads done from the layer's internal buffers
+    int64_t misses;                         // buffer refills (reads passed to the layer below or to the OS)
+    int64_t seeks;                          // reads that don't start where the previous one ended
+    int64_t reopens;                        // files opened from this layer
+} libvgmstream_io_layer_t;
+
+#define LIBVGMSTREAM_IO_MAX_LAYERS  16
+
+typedef struct {
+    int files;                              // files summed (channels often share one)
+    int depth;                              // wrapper depth, from the decoder to the actual IO (may be bigger than max layers)
+    libvgmstream_io_layer_t layers[LIBVGMSTREAM_IO_MAX_LAYERS]; // per layer, top (decoder side) to bottom (IO side)
+} libvgmstream_io_stack_t;
+
+/* IO done by vgmstream, layer by layer: comparing a layer's bytes/reads with the one below shows which one
+ * causes extra reads (for example a format that reads small values all over the file).
+ * - 'api' layers are calls made to the libstreamfile_t, layers below are only visible with libstreamfile_open_from_*
+ * - reads done to companion files aren't counted
+ */
+typedef struct {
+    libvgmstream_io_stack_t open;           // file passed to _open_stream, while parsing
+    libvgmstream_io_stack_t decode;         // files used to decode, so far
+} libvgmstream_io_stats_t;
+
+/* Gets current stream's IO stats (always enabled)
+ * - returns < 0 on error
+ */
+LIBVGMSTREAM_API int libvgmstream_get_io_stats(libvgmstream_t* lib, libvgmstream_io_stats_t* stats);
+
+
 /*****************************************************************************/
 /* HELPERS */
 
@@ -286,6 +358,15 @@ typedef enum {
 */
 LIBVGMSTREAM_API void libvgmstream_set_log(libvgmstream_loglevel_t level, void (*callback)(int level, const char* str));
 
+/* Enables a global cache of decryption keys found by key searches (encrypted HCA/ADX/FSB), so reopening files
+ * or other files in the same bank are faster. Optionally found keys are loaded and saved to a text file.
+ * - cache is set globally rather than per libvgmstream_t; call before opening streams (not thread-safe)
+ * - call with enable = false to disable and free the cache
+ * - filename may be NULL to only cache in memory
+ * - returns false on errors
+ */
+LIBVGMSTREAM_API bool libvgmstream_set_key_cache(bool enable, const char* filename);
+
 
 /* Returns a list of supported extensions (WARNING: it's pretty big), such as "adx", "dsp", etc.
  * Mainly for plugins that want to know which extensions are supported.
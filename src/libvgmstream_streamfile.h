@@ -55,6 +55,11 @@ LIBVGMSTREAM_API void libstreamfile_close(libstreamfile_t* libsf);
  * Note that this must be closed with libstreamfile_close(...) */
 LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_stdio(const char* filename);
 
+/* base libstreamfile using memory-mapped IO (falls back to STDIO if file can't be mapped).
+ * Faster for big local files with many channels, as all reopens share the same mapping.
+ * Note that this must be closed with libstreamfile_close(...) */
+LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_mmap(const char* filename);
+
 /* base libstreamfile using a FILE (cached); the filename is needed as metadata */
 LIBVGMSTREAM_API libstreamfile_t* libstreamfile_open_from_file(void* file, const char* filename);
 
@@ -8,6 +8,8 @@
 #include "../coding/coding.h"
 #include "../util/cri_keys.h"
 #include "../util/companion_files.h"
+#include "../util/key_cache.h"
+#include "../util/reader_put.h"
 
 
 #ifdef VGM_DEBUG_OUTPUT
@@ -451,6 +453,32 @@ static bool validate_adx_key(adx_keytest_t* keytest, uint16_t xor, uint16_t mul,
     return true;
 }
 
+/* test keys found before, either for this file or others (same bank) */
+static bool find_adx_key_cache(STREAMFILE* sf, adx_keytest_t* keytest, const char* id, uint16_t subkey, uint16_t* xor_start, uint16_t* xor_mult, uint16_t* xor_add) {
+    uint8_t key[0x06];
+
+    for (int i = -1; i < 4; i++) {
+        size_t key_size = (i < 0) ?
+            key_cache_get(sf, id, subkey, key, sizeof(key)) :
+            key_cache_get_recent(id, i, key, sizeof(key));
+        if (key_size != sizeof(key))
+            continue;
+
+        uint16_t key_xor = get_u16be(key + 0x00);
+        uint16_t key_mul = get_u16be(key + 0x02);
+        uint16_t key_add = get_u16be(key + 0x04);
+        if (!validate_adx_key(keytest, key_xor, key_mul, key_add))
+            continue;
+
+        *xor_start = key_xor;
+        *xor_mult = key_mul;
+        *xor_add = key_add;
+        return true;
+    }
+
+    return false;
+}
+
 /* ADX key detection works by reading XORed ADPCM 16-bit scales in frames, and un-XORing with keys in
  * a list. If resulting values are within the expected range for N scales we accept that key. */
 static bool find_adx_key(STREAMFILE* sf, uint8_t type, uint16_t* xor_start, uint16_t* xor_mult, uint16_t* xor_add, uint16_t subkey) {
@@ -471,6 +499,12 @@ static bool find_adx_key(STREAMFILE* sf, uint8_t type, uint16_t* xor_start, uint
     if (keytest.bruteframe_count == 0)
         goto done;
 
+    const char* cache_id = (type == 8) ? "adx8" : "adx9";
+    if (find_adx_key_cache(sf, &keytest, cache_id, subkey, xor_start, xor_mult, xor_add)) {
+        rc = true;
+        goto done;
+    }
+
     /* try to guess key */
     {
         const adxkey_info* keys = NULL;
@@ -549,6 +583,12 @@ static bool find_adx_key(STREAMFILE* sf, uint8_t type, uint16_t* xor_start, uint
             *xor_mult = key_mul;
             *xor_add = key_add;
             rc = true;
+
+            uint8_t key[0x06];
+            put_u16be(key + 0x00, key_xor);
+            put_u16be(key + 0x02, key_mul);
+            put_u16be(key + 0x04, key_add);
+            key_cache_add(sf, cache_id, subkey, key, sizeof(key));
             break;
         }
 
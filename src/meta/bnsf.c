@@ -153,43 +153,43 @@ fail:
 }
 
 #ifdef VGM_USE_G7221
-static inline void test_key(STREAMFILE* sf, off_t start, g7221_codec_data* data, const char* key, int keylen, int* p_best_score, uint8_t* p_best_key) {
-    uint8_t tmpkey[24];
-    int score;
+/* keystrings are 0-padded to 192-bit */
+static bool add_key(uint8_t* keys, int* p_keys_count, const char* key, int keylen) {
+    if (keylen > S14_KEY_SIZE)
+        return false;
+
+    uint8_t* dst = keys + (*p_keys_count) * S14_KEY_SIZE;
+    memcpy(dst, key, keylen);
+    memset(dst + keylen, 0, S14_KEY_SIZE - keylen);
+    (*p_keys_count)++;
+    return true;
+}
 
-    if (keylen > sizeof(tmpkey))
+/* tests keys in threads, updating best key */
+static void test_keys(STREAMFILE* sf, off_t start, g7221_codec_data* data, const uint8_t* keys, int keys_count, int* p_best_score, uint8_t* p_best_key) {
+    int index = test_key_list_g7221(data, start, sf, keys, keys_count, p_best_score);
+    if (index < 0)
         return;
-    memcpy(tmpkey, key, keylen);
-    memset(tmpkey + keylen, 0, sizeof(tmpkey) - keylen);
-
-    //;VGM_LOG("BNSF: test key=%.24s\n", tmpkey);
-    set_key_g7221(data, tmpkey);
-
-    score = test_key_g7221(data, start, sf);
-    if (score < 0) return;
 
-    if (*p_best_score <= 0 || (score < *p_best_score && score > 0)) {
-        *p_best_score = score;
-        memcpy(p_best_key, key, keylen);
-        memset(p_best_key + keylen, 0, sizeof(tmpkey) - keylen);
-    }
+    memcpy(p_best_key, keys + index * S14_KEY_SIZE, S14_KEY_SIZE);
 }
 
 static void find_bnsf_key(STREAMFILE* sf, off_t start, g7221_codec_data* data, uint8_t* best_key) {
     const size_t keys_length = sizeof(s14key_list) / sizeof(bnsfkey_info);
     int best_score = -1;
-    int i;
+    int keys_count = 0;
 
+    uint8_t* keys = malloc(keys_length * S14_KEY_SIZE);
+    if (!keys) return;
 
-    for (i = 0; i < keys_length; i++) {
+    for (int i = 0; i < keys_length; i++) {
         const char* key = s14key_list[i].key;
-        int keylen = strlen(key);
-
-        test_key(sf, start, data, key, keylen, &best_score, best_key);
-        if (best_score == 1)
-            break;
+        add_key(keys, &keys_count, key, strlen(key));
     }
 
+    test_keys(sf, start, data, keys, keys_count, &best_score, best_key);
+    free(keys);
+
     VGM_ASSERT(best_score > 0, "BNSF: best key=%.24s (score=%i)\n", best_key, best_score);
     vgm_asserti(best_score < 0 , "BNSF: decryption key not found\n");
 }
@@ -197,9 +197,13 @@ static void find_bnsf_key(STREAMFILE* sf, off_t start, g7221_codec_data* data, u
 #define BNSF_MIN_KEY_LEN 3
 
 #ifdef BNSF_BRUTEFORCE
+#define BNSF_BATCH_KEYS 0x10000
+
 /* bruteforce keys in a string list extracted from executables or files near sound data, trying variations. */
 static void bruteforce_bnsf_key(STREAMFILE* sf, off_t start, g7221_codec_data* data, uint8_t* best_key) {
     STREAMFILE* sf_keys = NULL;
+    uint8_t* keys = NULL;
+    int keys_count = 0;
     int best_score = -1;
     int i, j;
     char line[1024];
@@ -213,10 +217,15 @@ static void bruteforce_bnsf_key(STREAMFILE* sf, off_t start, g7221_codec_data* d
     sf_keys = open_streamfile_by_filename(sf, "keys.txt");
     if (!sf_keys) goto done;
 
+    /* variations are tested in batches (a line may have more) */
+    keys = malloc(BNSF_BATCH_KEYS * S14_KEY_SIZE);
+    if (!keys) goto done;
+
     keys_size = get_streamfile_size(sf_keys);
 
+    /* perfect keys stop the search (later keys can't be better) */
     offset = 0x00;
-    while (offset < keys_size) {
+    while (offset < keys_size && best_score != 1) {
         int line_len;
 
         bytes = read_line(line, sizeof(line), offset, sf_keys, &line_ok);
@@ -230,19 +239,24 @@ static void bruteforce_bnsf_key(STREAMFILE* sf, off_t start, g7221_codec_data* d
                 int keylen = j - i;
                 const char* key = &line[i];
 
-                test_key(sf, start, data, key, keylen, &best_score, best_key);
-                if (best_score == 1) {
-                    VGM_ASSERT(best_score > 0, "BNSF: good key=%.24s (score=%i)\n", best_key, best_score);
-                    //goto done;
+                if (!add_key(keys, &keys_count, key, keylen))
+                    continue;
+
+                if (keys_count == BNSF_BATCH_KEYS) {
+                    test_keys(sf, start, data, keys, keys_count, &best_score, best_key);
+                    keys_count = 0;
                 }
             }
         }
     }
 
+    test_keys(sf, start, data, keys, keys_count, &best_score, best_key);
+
 done:
     VGM_ASSERT(best_score > 0, "BNSF: best key=%.24s (score=%i)\n", best_key, best_score);
     VGM_ASSERT(best_score < 0, "BNSF: key not found\n");
 
+    free(keys);
     close_streamfile(sf_keys);
 }
 #endif
@@ -1,10 +1,12 @@
 #include "meta.h"
 #include "../util/companion_files.h"
+#include "../util/key_cache.h"
 #include "fsb_keys.h"
 #include "fsb_encrypted_streamfile.h"
 
 
 static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* key, size_t key_size, uint8_t flags);
+static VGMSTREAM* test_fsbkey_cache(STREAMFILE* sf);
 
 /* fully encrypted FSBs */
 VGMSTREAM* init_vgmstream_fsb_encrypted(STREAMFILE* sf) {
@@ -33,13 +35,25 @@ VGMSTREAM* init_vgmstream_fsb_encrypted(STREAMFILE* sf) {
     }
 
 
+    /* try keys found before (this file or others in the same bank) */
+    vgmstream = test_fsbkey_cache(sf);
+
     /* try all keys until one works */
     if (!vgmstream) {
         for (int i = 0; i < fsbkey_list_count; i++) {
             fsbkey_info entry = fsbkey_list[i];
 
             vgmstream = test_fsbkey(sf, (const uint8_t*)entry.key, entry.key_size, entry.flags);
-            if (vgmstream) break;
+            if (vgmstream) {
+                /* cached as flags + key */
+                uint8_t buf[1 + FSB_KEY_MAX];
+                if (entry.key_size <= FSB_KEY_MAX) {
+                    buf[0] = entry.flags;
+                    memcpy(buf + 1, entry.key, entry.key_size);
+                    key_cache_add(sf, "fsb", 0, buf, 1 + entry.key_size);
+                }
+                break;
+            }
         }
     }
 
@@ -89,3 +103,21 @@ static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* key, size_t key_siz
     
     return vc;
 }
+
+static VGMSTREAM* test_fsbkey_cache(STREAMFILE* sf) {
+    uint8_t buf[1 + FSB_KEY_MAX];
+
+    for (int i = -1; i < 4; i++) {
+        size_t size = (i < 0) ?
+            key_cache_get(sf, "fsb", 0, buf, sizeof(buf)) :
+            key_cache_get_recent("fsb", i, buf, sizeof(buf));
+        if (size <= 1)
+            continue;
+
+        VGMSTREAM* vgmstream = test_fsbkey(sf, buf + 1, size - 1, buf[0]);
+        if (vgmstream)
+            return vgmstream;
+    }
+
+    return NULL;
+}
@@ -5,6 +5,8 @@
 #include "../util/channel_mappings.h"
 #include "../util/companion_files.h"
 #include "../util/cri_keys.h"
+#include "../util/key_cache.h"
+#include "../util/reader_put.h"
 
 #ifdef VGM_DEBUG_OUTPUT
   //#define HCA_BRUTEFORCE
@@ -104,35 +106,57 @@ fail:
 }
 
 
+/* test keys found before: this file's key if it still looks valid, or a perfect key from others (same bank) */
+static bool find_hca_key_cache(STREAMFILE* sf, hca_codec_data* hca_data, hca_keytest_t* hk) {
+    uint8_t key[0x08];
+
+    for (int i = -1; i < 4; i++) {
+        size_t key_size = (i < 0) ?
+            key_cache_get(sf, "hca", hk->subkey, key, sizeof(key)) :
+            key_cache_get_recent("hca", i, key, sizeof(key));
+        if (key_size != sizeof(key))
+            continue;
+
+        hca_keytest_t tmp = *hk; /* keep test state for the list */
+        tmp.key = get_u64be(key);
+        test_hca_key(hca_data, &tmp);
+        if (tmp.best_score <= 0 || (i >= 0 && tmp.best_score != 1))
+            continue;
+
+        hk->best_key = tmp.best_key;
+        hk->best_score = tmp.best_score;
+        return true;
+    }
+
+    return false;
+}
+
 /* try to find the decryption key from a list */
-static bool find_hca_key(hca_codec_data* hca_data, uint64_t* p_keycode, uint16_t subkey) {
+static bool find_hca_key(STREAMFILE* sf, hca_codec_data* hca_data, uint64_t* p_keycode, uint16_t subkey) {
     const size_t keys_length = sizeof(hcakey_list) / sizeof(hcakey_list[0]);
     hca_keytest_t hk = {0};
+    uint64_t* keys = NULL;
 
     hk.best_key = 0xCC55463930DBE1AB; /* defaults to PSO2 key, most common */ 
     hk.subkey = subkey;
 
+    if (find_hca_key_cache(sf, hca_data, &hk))
+        goto done;
+
+    /* tested in parallel (subkey variations in hcakey_list aren't used) */
+    keys = malloc(keys_length * sizeof(uint64_t));
+    if (!keys) goto done;
     for (int i = 0; i < keys_length; i++) {
-        hk.key = hcakey_list[i].key;
-
-        test_hca_key(hca_data, &hk);
-        if (hk.best_score == 1)
-            goto done;
-
-#if 0
-        {
-            size_t subkeys_size = hcakey_list[i].subkeys_size;
-            const uint16_t* subkeys = hcakey_list[i].subkeys;
-            if (subkeys_size <= 0 || subkey != 0)
-                continue;
-            for (int j = 0; j < subkeys_size; j++) {
-                hk.subkey = subkeys[j];
-                test_hca_key(hca_data, &hk);
-                if (hk.best_score == 1)
-                    goto done;
-            }
-        }
-#endif
+        keys[i] = hcakey_list[i].key;
+    }
+
+    test_hca_key_list(hca_data, &hk, keys, keys_length);
+    free(keys);
+
+    if (hk.best_score > 0) {
+        uint8_t key[0x08];
+        put_u64be(key, hk.best_key);
+        key_cache_add(sf, "hca", subkey, key, sizeof(key));
     }
 
 done:
@@ -164,7 +188,7 @@ static void load_hca_key(hca_codec_data* hca_data, uint64_t* p_keycode, uint16_t
     }
 #ifdef HCA_BRUTEFORCE
     else if (true) {
-        bool ok = find_hca_key(hca_data, &keycode, subkey);
+        bool ok = find_hca_key(sf, hca_data, &keycode, subkey);
         if (!ok)
             bruteforce_hca_key(sf, hca_data, &keycode, subkey);
     }
@@ -173,7 +197,7 @@ static void load_hca_key(hca_codec_data* hca_data, uint64_t* p_keycode, uint16_t
         if (key_size == 0x02) { // AWB subkey only (but don't do this)
             subkey = get_u16be(keybuf+0x00);
         }            
-        find_hca_key(hca_data, &keycode, subkey);
+        find_hca_key(sf, hca_data, &keycode, subkey);
     }
 
     *p_keycode = keycode;
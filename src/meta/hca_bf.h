@@ -5,9 +5,12 @@
 #include "meta.h"
 #include "../coding/coding.h"
 #include "../util/reader_text.h"
+#include "../util/timer.h"
 
 #ifdef HCA_BRUTEFORCE
-#define HCA_BF_CHUNK 0x48000008 //~1GB (int), extra size for keys in between chunks
+#define HCA_BF_CHUNK 0x1000008 //extra size for keys in between chunks
+#define HCA_BF_BATCH_KEYS 0x40000 //keys tested at once in threads
+#define HCA_BF_SET_BITS 22 //32MB, cleared when half full (so some dupes may be tested again)
 
 static void bruteforce_process_result(hca_keytest_t* hk, unsigned long long* p_keycode) {
     *p_keycode = hk->best_key;
@@ -20,6 +23,115 @@ static void bruteforce_process_result(hca_keytest_t* hk, unsigned long long* p_k
     }
 }
 
+/* Candidates are deduplicated (exes have lots of repeated values, more so in 32-bit modes) then tested in
+ * batches with the threaded key list test. Results are the same as testing one by one. */
+typedef struct {
+    hca_codec_data* hca_data;
+    hca_keytest_t hk;
+
+    uint64_t* keys;
+    int count;
+
+    uint64_t* set;      /* open addressing, 0 = empty (0 keys aren't tested) */
+    size_t set_count;
+
+    int64_t tested;
+    int64_t dupes;
+    int64_t start_us;
+    int64_t log_us;
+} hbf_batch_t;
+
+static bool hbf_batch_init(hbf_batch_t* hb, hca_codec_data* hca_data, uint16_t subkey) {
+    memset(hb, 0, sizeof(hbf_batch_t));
+    hb->hca_data = hca_data;
+    hb->hk.subkey = subkey;
+
+    hb->keys = malloc(HCA_BF_BATCH_KEYS * sizeof(uint64_t));
+    hb->set = calloc(1 << HCA_BF_SET_BITS, sizeof(uint64_t));
+    if (!hb->keys || !hb->set) {
+        VGM_LOG("HCA BF: can't alloc batch\n");
+        return false;
+    }
+
+    hb->start_us = timer_get_us();
+    hb->log_us = hb->start_us;
+    return true;
+}
+
+static void hbf_batch_free(hbf_batch_t* hb) {
+    free(hb->keys);
+    free(hb->set);
+}
+
+static void hbf_batch_log(hbf_batch_t* hb, bool force) {
+    int64_t now_us = timer_get_us();
+    if (!force && now_us - hb->log_us < 1000000)
+        return;
+    hb->log_us = now_us;
+
+    int64_t elapsed_ms = (now_us - hb->start_us) / 1000;
+    int64_t keys_per_sec = elapsed_ms > 0 ? hb->tested * 1000 / elapsed_ms : 0;
+    VGM_LOG("HCA BF: tested %"PRId64" keys (%"PRId64" dupes) in %"PRId64"ms, %"PRId64" keys/s\n",
+            hb->tested, hb->dupes, elapsed_ms, keys_per_sec);
+}
+
+/* returns true if a perfect key was found */
+static bool hbf_batch_flush(hbf_batch_t* hb) {
+    if (hb->count == 0)
+        return hb->hk.best_score == 1;
+
+    test_hca_key_list(hb->hca_data, &hb->hk, hb->keys, hb->count);
+    hb->tested += hb->count;
+    hb->count = 0;
+
+    return hb->hk.best_score == 1;
+}
+
+static bool hbf_is_dupe(hbf_batch_t* hb, uint64_t key) {
+    const size_t mask = (1 << HCA_BF_SET_BITS) - 1;
+
+    if (hb->set_count >= (mask + 1) / 2) {
+        memset(hb->set, 0, (mask + 1) * sizeof(uint64_t));
+        hb->set_count = 0;
+    }
+
+    size_t pos = (key * 0x9E3779B97F4A7C15ULL) >> (64 - HCA_BF_SET_BITS);
+    while (hb->set[pos] != 0) {
+        if (hb->set[pos] == key)
+            return true;
+        pos = (pos + 1) & mask;
+    }
+
+    hb->set[pos] = key;
+    hb->set_count++;
+    return false;
+}
+
+/* returns true if a perfect key was found */
+static bool hbf_batch_add(hbf_batch_t* hb, uint64_t key, bool dedupe) {
+    if (key == 0)
+        return false;
+    if (dedupe && hbf_is_dupe(hb, key)) {
+        hb->dupes++;
+        return false;
+    }
+
+    hb->keys[hb->count++] = key;
+    if (hb->count < HCA_BF_BATCH_KEYS)
+        return false;
+
+    bool found = hbf_batch_flush(hb);
+    hbf_batch_log(hb, false);
+    return found;
+}
+
+static void hbf_batch_done(hbf_batch_t* hb, unsigned long long* p_keycode) {
+    hbf_batch_flush(hb);
+    hbf_batch_log(hb, true);
+    bruteforce_process_result(&hb->hk, p_keycode);
+}
+
+
 const char* hbf_info[] = {
     "64LE",
     "64BE",
@@ -39,30 +151,30 @@ typedef enum {
 } hbf_type_t;
 
 /* Bruteforce binary keys in executables and similar files, mainly for some mobile games.
- * Kinda slow but acceptable for ~100MB exes, not very optimized. Unity usually has keys
+ * Acceptable for ~100MB exes (keys are tested in threads). Unity usually has keys
  * in plaintext (inside levelX or other base files) instead though, use test below. */
 static void bruteforce_hca_key_bin_type(STREAMFILE* sf, hca_codec_data* hca_data, unsigned long long* p_keycode, uint16_t subkey, hbf_type_t type) {
     STREAMFILE* sf_keys = NULL;
     uint8_t* buf = NULL;
-    uint64_t keys_offset;
-    uint32_t keys_limit;
+    uint64_t keys_offset, keys_size;
     int pos, step, key_size;
-    uint64_t key = 0, old_key = 0;
-    hca_keytest_t hk = {0};
+    uint64_t key = 0;
+    hbf_batch_t hb;
 
-    hk.subkey = subkey;
     *p_keycode = 0;
 
-    /* load whole file in memory for performance (exes with keys shouldn't be too big) */
     sf_keys = open_streamfile_by_filename(sf, "keys.bin");
     if (!sf_keys) return;
 
     const char* type_info = hbf_info[type];
     VGM_LOG("HCA BF: using keys.bin (%s mode)\n", type_info);
 
+    if (!hbf_batch_init(&hb, hca_data, subkey))
+        goto done;
+
     buf = malloc(HCA_BF_CHUNK);
     if (!buf) {
-        VGM_LOG("HCA BF: key file too big!\n");
+        VGM_LOG("HCA BF: can't alloc chunk\n");
         goto done;
     }
 
@@ -87,64 +199,50 @@ static void bruteforce_hca_key_bin_type(STREAMFILE* sf, hca_codec_data* hca_data
         default: goto done;
     }
 
-    /* main read */
+    /* main read (chunks overlap so keys in between are tested) */
+    keys_size = get_streamfile_size(sf_keys);
     keys_offset = 0;
-    keys_limit = 0;
-    pos = 0;
-    while (true) {
-        /* read new chunk */
-        if (pos + key_size >= keys_limit) {
-            if (keys_offset + keys_limit == get_streamfile_size(sf_keys))
-                break;
-            if (keys_limit >= 8)
-                keys_offset += keys_limit - 8;
-
-            VGM_LOG("HCA BF: reading %llx + ...\n", (long long)keys_offset);
-            keys_limit = read_streamfile(buf, keys_offset, HCA_BF_CHUNK, sf_keys);
-            if (keys_limit < key_size)
-                break;
-            keys_limit -= key_size;
-            pos = 0;
-        }
+    while (keys_offset + key_size <= keys_size) {
+        int bytes = read_streamfile(buf, keys_offset, HCA_BF_CHUNK, sf_keys);
+        if (bytes < key_size)
+            break;
+        int keys_limit = bytes - key_size + 1;
 
-        if (pos % 0x1000000 == 0) {
-            uint64_t pos_out = keys_offset + pos;
-            VGM_LOG("HCA BF: pos %llx...\n", (long long)pos_out);
-        }
+        VGM_LOG("HCA BF: pos %llx / %llx...\n", (long long)keys_offset, (long long)keys_size);
 
+        bool found = false;
+        for (pos = 0; pos < keys_limit; pos += step) {
 #ifdef HCA_BF_IGNORE_BAD_KEYS
-        if (!is_good_key(buf + pos, int_size)) {
-            pos += step;
-            continue;
-        }
+            if (!is_good_key(buf + pos, int_size))
+                continue;
 #endif
 
-        /* keys are usually u64le but other orders may exist */
-        switch(type) {
-            case HBF_TYPE_64LE_1: key = get_u64le(buf + pos); break;
-            case HBF_TYPE_64BE_1: key = get_u64be(buf + pos); break;
-            case HBF_TYPE_32LE_1: key = get_u32le(buf + pos); break;
-            case HBF_TYPE_32BE_1: key = get_u32be(buf + pos); break;
-            //case HBF_TYPE_64LE_4: key = get_u64le(buf + pos); break;
-            //case HBF_TYPE_64BE_4: key = get_u64be(buf + pos); break;
-            //case HBF_TYPE_32LE_4: key = get_u32le(buf + pos); break;
-            //case HBF_TYPE_32BE_4: key = get_u32be(buf + pos); break;
-            default: goto done;
+            /* keys are usually u64le but other orders may exist */
+            switch(type) {
+                case HBF_TYPE_64LE_1: key = get_u64le(buf + pos); break;
+                case HBF_TYPE_64BE_1: key = get_u64be(buf + pos); break;
+                case HBF_TYPE_32LE_1: key = get_u32le(buf + pos); break;
+                case HBF_TYPE_32BE_1: key = get_u32be(buf + pos); break;
+                //case HBF_TYPE_64LE_4: key = get_u64le(buf + pos); break;
+                //case HBF_TYPE_64BE_4: key = get_u64be(buf + pos); break;
+                //case HBF_TYPE_32LE_4: key = get_u32le(buf + pos); break;
+                //case HBF_TYPE_32BE_4: key = get_u32be(buf + pos); break;
+                default: goto done;
+            }
+
+            found = hbf_batch_add(&hb, key, true);
+            if (found)
+                break;
         }
-        pos += step;
 
-        if (key == 0 || key == old_key)
-            continue;
-        old_key = key;
-
-        hk.key = key;
-        test_hca_key(hca_data, &hk);
-        if (hk.best_score == 1)
-            goto done;
+        if (found)
+            break;
+        keys_offset += pos;
     }
 
+    hbf_batch_done(&hb, p_keycode);
 done:
-    bruteforce_process_result(&hk, p_keycode);
+    hbf_batch_free(&hb);
     close_streamfile(sf_keys);
     free(buf);
 
@@ -167,17 +265,14 @@ static void bruteforce_hca_key_bin(STREAMFILE* sf, hca_codec_data* hca_data, uns
 /* same as the above but for txt lines. */
 static void bruteforce_hca_key_txt(STREAMFILE* sf, hca_codec_data* hca_data, unsigned long long* p_keycode, uint16_t subkey) {
     STREAMFILE* sf_keys = NULL;
-    uint8_t* buf = NULL;
-    uint32_t keys_size, bytes;
+    uint32_t keys_size;
     char line[1024];
-    int i = 0, pos;
+    int pos;
     uint64_t key = 0;
-    hca_keytest_t hk = {0};
+    hbf_batch_t hb;
 
-    hk.subkey = subkey;
     *p_keycode = 0;
 
-    /* load whole file in memory for performance (exes with keys shouldn't be too big) */
     sf_keys = open_streamfile_by_filename(sf, "keys.txt");
     if (!sf_keys) return;
 
@@ -185,14 +280,8 @@ static void bruteforce_hca_key_txt(STREAMFILE* sf, hca_codec_data* hca_data, uns
 
     keys_size = get_streamfile_size(sf_keys);
 
-    buf = malloc(keys_size);
-    if (!buf) {
-        VGM_LOG("HCA BF: key file too big!\n");
+    if (!hbf_batch_init(&hb, hca_data, subkey))
         goto done;
-    }
-
-    bytes = read_streamfile(buf, 0, keys_size, sf_keys);
-    if (bytes != keys_size) goto done;
 
     VGM_LOG("HCA BF: start .txt\n");
 
@@ -208,22 +297,14 @@ static void bruteforce_hca_key_txt(STREAMFILE* sf, hca_codec_data* hca_data, uns
         count = sscanf(line, "%" SCNd64, &key);
         if (count != 1) continue;
 
-        VGM_ASSERT(pos % 10000 == 0, "HCA BF: count %i...\n", i);
-
-        if (key == 0)
-            continue;
-        i++;
-
-        hk.key = key;
-        test_hca_key(hca_data, &hk);
-        if (hk.best_score == 1)
-            goto done;
+        if (hbf_batch_add(&hb, key, true))
+            break;
     }
 
+    hbf_batch_done(&hb, p_keycode);
 done:
-    bruteforce_process_result(&hk, p_keycode);
+    hbf_batch_free(&hb);
     close_streamfile(sf_keys);
-    free(buf);
 
     VGM_LOG("HCA BF: done\n\n");
 }
@@ -233,13 +314,10 @@ static void bruteforce_hca_key_num(STREAMFILE* sf, hca_codec_data* hca_data, uns
     STREAMFILE* sf_keys = NULL;
     uint32_t keys_size;
     uint64_t min, max;
-    uint64_t key = 0;
-    hca_keytest_t hk = {0};
+    hbf_batch_t hb;
 
-    hk.subkey = subkey;
     *p_keycode = 0;
 
-    /* load whole file in memory for performance (exes with keys shouldn't be too big) */
     sf_keys = open_streamfile_by_filename(sf, "keys.num");
     if (!sf_keys) return;
 
@@ -247,7 +325,7 @@ static void bruteforce_hca_key_num(STREAMFILE* sf, hca_codec_data* hca_data, uns
 
     keys_size = get_streamfile_size(sf_keys);
 
-    /* don't set too high as it does ~70000 keys per second, do the math */
+    /* don't set too high (see keys/s in the log), do the math */
     if (keys_size < 0x10) {
         min = 0;
         max = 0xFFFFFFFF;
@@ -257,22 +335,21 @@ static void bruteforce_hca_key_num(STREAMFILE* sf, hca_codec_data* hca_data, uns
         max = read_u64be(0x08, sf_keys);
     }
 
+    if (!hbf_batch_init(&hb, hca_data, subkey))
+        goto done;
+
     VGM_LOG("HCA BF: start .num\n");
 
+    /* numbers are unique already */
     while (min < max) {
-        key = min;
-
+        if (hbf_batch_add(&hb, min, false))
+            break;
         min++;
-        VGM_ASSERT(min % 0x100000 == 0, "HCA BF: count %x...\n", (uint32_t)min);
-
-        hk.key = key;
-        test_hca_key(hca_data, &hk);
-        if (hk.best_score == 1)
-            goto done;
     }
 
+    hbf_batch_done(&hb, p_keycode);
 done:
-    bruteforce_process_result(&hk, p_keycode);
+    hbf_batch_free(&hb);
     close_streamfile(sf_keys);
 
     VGM_LOG("HCA BF: done\n\n");
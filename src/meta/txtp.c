@@ -59,6 +59,7 @@ void txtp_clean(txtp_header_t* txtp) {
     }
 
     free(txtp->vgmstream);
+    free(txtp->source);
     free(txtp->group);
     free(txtp->entry);
     free(txtp);
@@ -21,6 +21,8 @@
 #define TXTP_GROUP_REPEAT 'R'
 #define TXTP_POSITION_LOOPS 'L'
 
+#define TXTP_LAZY_SEGMENTS_MIN 16 /* segment groups this big only keep open segments that are playing */
+
 #define TXTP_BODY_INTRO 1
 #define TXTP_BODY_MAIN 2
 #define TXTP_BODY_OUTRO 3
@@ -127,6 +129,13 @@ typedef struct {
 
 } txtp_group_t;
 
+/* where each opened entry came from, to reopen it later (entries are reordered when grouping) */
+typedef struct {
+    VGMSTREAM* vgmstream;
+    char filename[TXTP_FILENAME_MAX];
+    int subsong;
+} txtp_source_t;
+
 typedef struct {
     txtp_entry_t* entry;
     size_t entry_count;
@@ -140,6 +149,10 @@ typedef struct {
     VGMSTREAM** vgmstream;
     size_t vgmstream_count;
 
+    txtp_source_t* source;
+    size_t source_count;
+    STREAMFILE* sf; /* .txtp (not owned) */
+
     uint32_t loop_start_segment;
     uint32_t loop_end_segment;
     bool is_loop_keep;
@@ -6,6 +6,7 @@
 #include "../base/mixing.h"
 #include "../base/plugins.h"
 #include "../util/layout_utils.h"
+#include "../vgmstream_init.h"
 
 
 /*******************************************************************************/
@@ -223,6 +224,9 @@ static bool is_silent(const char* fn) {
 /* open all entries and apply settings to resulting VGMSTREAMs */
 static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
     bool has_silents = false;
+    STREAMFILE* temp_sf = NULL;
+    const char* temp_filename = NULL;
+    int temp_format_id = 0;
 
 
     if (txtp->entry_count == 0)
@@ -233,10 +237,12 @@ static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
 
     txtp->vgmstream_count = txtp->entry_count;
 
+    txtp->source = calloc(txtp->entry_count, sizeof(txtp_source_t));
+    if (!txtp->source) goto fail;
+
 
     /* open all entry files first as they'll be modified by modes */
     for (int i = 0; i < txtp->vgmstream_count; i++) {
-        STREAMFILE* temp_sf = NULL;
         const char* filename = txtp->entry[i].filename;
 
         /* silent entry ignore */
@@ -246,22 +252,37 @@ static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
             continue;
         }
 
-        temp_sf = open_streamfile_by_absname(sf, filename);
-        if (!temp_sf) {
-            vgm_logi("TXTP: cannot open %s\n", filename);
-            goto fail;
+        /* big TXTP usually list many subsongs of the same file, so keep it open and try its format first */
+        if (!temp_sf || strcmp(temp_filename, filename) != 0) {
+            close_streamfile(temp_sf);
+            temp_filename = filename;
+            temp_format_id = 0;
+
+            temp_sf = open_streamfile_by_absname(sf, filename);
+            if (!temp_sf) {
+                vgm_logi("TXTP: cannot open %s\n", filename);
+                goto fail;
+            }
         }
         temp_sf->stream_index = txtp->entry[i].subsong;
 
-        txtp->vgmstream[i] = init_vgmstream_from_STREAMFILE(temp_sf);
-        close_streamfile(temp_sf);
+        txtp->vgmstream[i] = detect_vgmstream_format_id(temp_sf, temp_format_id);
         if (!txtp->vgmstream[i]) {
             vgm_logi("TXTP: cannot parse %s#%i\n", filename, txtp->entry[i].subsong);
             goto fail;
         }
+        temp_format_id = txtp->vgmstream[i]->format_id;
+
+        /* info to reopen later */
+        txtp_source_t* source = &txtp->source[txtp->source_count++];
+        source->vgmstream = txtp->vgmstream[i];
+        snprintf(source->filename, sizeof(source->filename), "%s", filename);
+        source->subsong = txtp->entry[i].subsong;
 
         apply_settings(txtp->vgmstream[i], &txtp->entry[i]);
     }
+    close_streamfile(temp_sf);
+    temp_sf = NULL;
 
     if (has_silents) {
         if (!parse_silents(txtp))
@@ -270,6 +291,7 @@ static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
 
     return true;
 fail:
+    close_streamfile(temp_sf);
     return false;
 }
 
@@ -323,6 +345,36 @@ static bool find_loop_anchors(txtp_header_t* txtp, int position, int count, int*
 }
 
 
+/* long segment groups only keep the playing segment open, others are reopened from their source when needed */
+static void setup_group_segment_lazy(txtp_header_t* txtp, segmented_layout_data* data_s) {
+    const char** filenames = NULL;
+    int* subsongs = NULL;
+
+    if (data_s->segment_count < TXTP_LAZY_SEGMENTS_MIN || !txtp->sf)
+        return;
+
+    filenames = calloc(data_s->segment_count, sizeof(const char*));
+    subsongs = calloc(data_s->segment_count, sizeof(int));
+    if (!filenames || !subsongs) goto done;
+
+    /* segments without source (silences, groups) are kept as-is */
+    for (int i = 0; i < data_s->segment_count; i++) {
+        for (int j = 0; j < txtp->source_count; j++) {
+            if (txtp->source[j].vgmstream == data_s->segments[i]) {
+                filenames[i] = txtp->source[j].filename;
+                subsongs[i] = txtp->source[j].subsong;
+                break;
+            }
+        }
+    }
+
+    /* not fatal, segments just stay open */
+    setup_layout_segmented_lazy(data_s, txtp->sf, filenames, subsongs);
+done:
+    free(filenames);
+    free(subsongs);
+}
+
 static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int position, int count) {
     VGMSTREAM* vgmstream = NULL;
     segmented_layout_data* data_s = NULL;
@@ -398,6 +450,8 @@ static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int posit
     vgmstream = allocate_segmented_vgmstream(data_s, loop_flag, loop_start - 1, loop_end - 1);
     if (!vgmstream) goto fail;
 
+    setup_group_segment_lazy(txtp, data_s);
+
     /* custom meta name if all parts don't match */
     for (int i = 0; i < count; i++) {
         if (vgmstream->meta_type != data_s->segments[i]->meta_type) {
@@ -652,6 +706,8 @@ fail:
 bool txtp_process(txtp_header_t* txtp, STREAMFILE* sf) {
     bool ok;
 
+    txtp->sf = sf;
+
     /* process files in the .txtp */
     ok = parse_entries(txtp, sf);
     if (!ok) goto fail;
@@ -7,6 +7,20 @@ STREAMFILE* open_streamfile(STREAMFILE* sf, const char* pathname) {
     return sf->open(sf, pathname, STREAMFILE_DEFAULT_BUFFER_SIZE);
 }
 
+int get_streamfile_stats(STREAMFILE* sf, sf_stats_t* layers, int max_layers) {
+    int depth = 0;
+
+    while (sf) {
+        if (layers && depth < max_layers)
+            layers[depth] = sf->stats;
+        depth++;
+
+        sf = sf->stats_inner;
+    }
+
+    return depth;
+}
+
 STREAMFILE* reopen_streamfile(STREAMFILE* sf, size_t buffer_size) {
     char pathname[PATH_LIMIT];
 
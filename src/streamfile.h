@@ -19,6 +19,7 @@
 #include <sys/types.h>
 #include "streamtypes.h"
 #include "util.h"
+#include "util/block_cache.h"
 
 
 /* MSVC fixes (though mingw uses MSVCRT but not MSC_VER, maybe use AND?) */
@@ -47,6 +48,19 @@ typedef int64_t offv_t; //off64_t
  * Value can be adjusted freely but 8k is a good enough compromise. */
 #define STREAMFILE_DEFAULT_BUFFER_SIZE 0x8000
 
+/* IO stats kept by every STREAMFILE layer (cheap counters, always on; see get_streamfile_stats) */
+typedef struct {
+    const char* type;       /* layer name ("stdio", "buffer", "clamp", etc), NULL if unknown */
+    int64_t reads;          /* read calls (including views) */
+    int64_t bytes;          /* bytes returned */
+    int64_t hits;           /* reads fully done from internal buffers */
+    int64_t misses;         /* buffer refills (reads done to the inner SF or OS) */
+    int64_t seeks;          /* reads that don't start where the previous one ended */
+    int64_t reopens;        /* SFs opened from this one */
+
+    offv_t next_offset;     /* internal */
+} sf_stats_t;
+
 /* struct representing a file with callbacks. Code should use STREAMFILEs and not std C functions
  * to do file operations, as plugins may need to provide their own callbacks.
  * Reads from arbitrary offsets, meaning internally may need fseek equivalents during reads. */
@@ -69,6 +83,14 @@ typedef struct _STREAMFILE {
     /* free current STREAMFILE */
     void (*close)(struct _STREAMFILE* sf);
 
+    /* optional: get a pointer to 'length' bytes at 'offset' in internal buffers, or NULL (see get_streamfile_view) */
+    const uint8_t* (*get_view)(struct _STREAMFILE* sf, offv_t offset, size_t length);
+
+    /* IO stats of this SF, updated by implementations */
+    sf_stats_t stats;
+    /* wrapped SF (for stats), NULL if this SF does IO itself */
+    struct _STREAMFILE* stats_inner;
+
     /* Substream selection for formats with subsongs.
      * Not ideal here, but it was the simplest way to pass to all init_vgmstream_x functions. */
     int stream_index; /* 0=default/auto (first), 1=first, N=Nth */
@@ -86,6 +108,10 @@ STREAMFILE* open_stdio_streamfile(const char* filename);
 /* Opens a standard STREAMFILE from a pre-opened FILE. */
 STREAMFILE* open_stdio_streamfile_by_file(FILE* file, const char* filename);
 
+/* Opens a STREAMFILE that memory-maps a local file, with reopens of the same file sharing the mapping.
+ * Falls back to stdio if the file can't be mapped (or on systems without mmap). */
+STREAMFILE* open_mmap_streamfile(const char* filename);
+
 /* Opens a STREAMFILE that does buffered IO.
  * Can be used when the underlying IO may be slow (like when using custom IO).
  * Buffer size is optional. */
@@ -126,6 +152,35 @@ STREAMFILE* open_fakename_streamfile_f(STREAMFILE* sf, const char* fakename, con
 STREAMFILE* open_multifile_streamfile(STREAMFILE** sfs, size_t sfs_size);
 STREAMFILE* open_multifile_streamfile_f(STREAMFILE** sfs, size_t sfs_size);
 
+/* Opens a STREAMFILE that keeps the first and last window_size bytes in memory (loaded on first access).
+ * Can be used when many small reads are expected at both ends of the file (like format detection).
+ * Calls to open won't use prefetch. Window size is optional. */
+STREAMFILE* open_prefetch_streamfile(STREAMFILE* sf, size_t window_size);
+STREAMFILE* open_prefetch_streamfile_f(STREAMFILE* sf, size_t window_size);
+
+/* Opens a STREAMFILE that caches reads in block_count aligned blocks of block_size (0 for defaults),
+ * evicting the least recently used block when full. Unlike the standard single buffer, interleaved reads
+ * (tables at the start + data at the end, or channels sharing one SF) don't keep rebuffering the same areas.
+ * Stats is optional (must outlive the SF), and shared by SFs reopened from this one. */
+STREAMFILE* open_cache_streamfile(STREAMFILE* sf, int block_count, size_t block_size, block_cache_stats_t* stats);
+STREAMFILE* open_cache_streamfile_f(STREAMFILE* sf, int block_count, size_t block_size, block_cache_stats_t* stats);
+
+/* Opens a STREAMFILE that does buffered IO, and once reads look sequential loads the next buffer
+ * in a background thread (if threads are available), for slow IO during playback.
+ * Calls to open also use read-ahead. Buffer size is optional. */
+STREAMFILE* open_readahead_streamfile(STREAMFILE* sf, size_t buf_size);
+STREAMFILE* open_readahead_streamfile_f(STREAMFILE* sf, size_t buf_size);
+
+/* Opens a STREAMFILE for profiling, that mimics a default buffered SF: its stats' misses/hits estimate
+ * buffer refills of reads done through it, regardless of inner SFs (that may read whole files at once).
+ * Calls to open won't count reads of the new SF (meant for profiling a single file). */
+STREAMFILE* open_counter_streamfile(STREAMFILE* sf);
+STREAMFILE* open_counter_streamfile_f(STREAMFILE* sf);
+
+/* Gets stats of each layer, from sf (top) to the SF doing IO (bottom), into layers (up to max_layers).
+ * Returns the number of layers (wrapper depth), which may be higher than max_layers. */
+int get_streamfile_stats(STREAMFILE* sf, sf_stats_t* layers, int max_layers);
+
 /* Opens a STREAMFILE from a (path)+filename.
  * Just a wrapper, to avoid having to access the STREAMFILE's callbacks directly. */
 STREAMFILE* open_streamfile(STREAMFILE* sf, const char* pathname);
@@ -146,6 +201,34 @@ static inline size_t read_streamfile(uint8_t* dst, offv_t offset, size_t length,
     return sf->read(sf, dst, offset, length);
 }
 
+/* Get a read-only pointer to 'length' bytes at 'offset' inside the SF's own buffer/mapping (may refill it),
+ * avoiding a copy. Returns NULL if the SF can't (unsupported, EOF, bigger than buffer, etc), so callers
+ * must fall back to read_streamfile. The pointer is only valid until the next call to the SF. */
+static inline const uint8_t* get_streamfile_view(offv_t offset, size_t length, STREAMFILE* sf) {
+    if (!sf->get_view)
+        return NULL;
+    return sf->get_view(sf, offset, length);
+}
+
+/* Same as read_streamfile but returns a view of the data if possible, or 'dst' after reading into it
+ * (even on partial reads, for decoders that ignore EOF errors). */
+static inline const uint8_t* read_streamfile_view(uint8_t* dst, offv_t offset, size_t length, STREAMFILE* sf) {
+    const uint8_t* view = get_streamfile_view(offset, length, sf);
+    if (view)
+        return view;
+    sf->read(sf, dst, offset, length);
+    return dst;
+}
+
+/* updates IO stats after a read or view (for SF implementations, hits/misses are updated separately) */
+static inline void update_streamfile_stats(sf_stats_t* stats, offv_t offset, size_t bytes) {
+    stats->reads++;
+    stats->bytes += bytes;
+    if (offset != stats->next_offset)
+        stats->seeks++;
+    stats->next_offset = offset + bytes;
+}
+
 /* return file size */
 static inline size_t get_streamfile_size(STREAMFILE* sf) {
     return sf->get_size(sf);
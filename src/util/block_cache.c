@@ -0,0 +1,223 @@
+#include <stdlib.h>
+#include <string.h>
+#include "block_cache.h"
+
+/* values can be adjusted freely, vgmstream usually needs a few areas at once (header/tables + one per channel) */
+#define BLOCK_CACHE_DEFAULT_COUNT 4
+#define BLOCK_CACHE_DEFAULT_SIZE 0x8000
+#define BLOCK_CACHE_MAX_COUNT 64
+
+typedef struct {
+    int64_t offset;         /* block start (aligned), -1 if unused */
+    size_t valid_size;      /* may be smaller than block size near EOF */
+    uint64_t last_used;     /* LRU tick */
+    uint8_t* buf;
+} cache_block_t;
+
+struct block_cache_t {
+    cache_block_t* blocks;
+    int block_count;
+    size_t block_size;
+    uint8_t* data;          /* all block bufs */
+    int64_t file_size;
+
+    uint64_t tick;
+    int last_block;         /* last used block (most reads hit the same one) */
+
+    block_cache_read_t read;
+    void* arg;
+
+    block_cache_stats_t* stats;
+    block_cache_stats_t stats_internal;
+};
+
+
+block_cache_t* block_cache_init(int block_count, size_t block_size, int64_t file_size, block_cache_read_t read, void* arg, block_cache_stats_t* stats) {
+    block_cache_t* cache = NULL;
+
+    if (!read || file_size < 0)
+        return NULL;
+    if (block_count <= 0)
+        block_count = BLOCK_CACHE_DEFAULT_COUNT;
+    if (block_count > BLOCK_CACHE_MAX_COUNT)
+        block_count = BLOCK_CACHE_MAX_COUNT;
+    if (block_size == 0)
+        block_size = BLOCK_CACHE_DEFAULT_SIZE;
+
+    cache = calloc(1, sizeof(block_cache_t));
+    if (!cache) goto fail;
+
+    cache->blocks = calloc(block_count, sizeof(cache_block_t));
+    if (!cache->blocks) goto fail;
+
+    cache->data = malloc(block_count * block_size);
+    if (!cache->data) goto fail;
+
+    for (int i = 0; i < block_count; i++) {
+        cache->blocks[i].offset = -1;
+        cache->blocks[i].buf = cache->data + i * block_size;
+    }
+
+    cache->block_count = block_count;
+    cache->block_size = block_size;
+    cache->file_size = file_size;
+    cache->read = read;
+    cache->arg = arg;
+    cache->stats = stats ? stats : &cache->stats_internal;
+
+    return cache;
+fail:
+    block_cache_free(cache);
+    return NULL;
+}
+
+void block_cache_free(block_cache_t* cache) {
+    if (!cache)
+        return;
+    free(cache->blocks);
+    free(cache->data);
+    free(cache);
+}
+
+const block_cache_stats_t* block_cache_get_stats(block_cache_t* cache) {
+    if (!cache)
+        return NULL;
+    return cache->stats;
+}
+
+
+static cache_block_t* find_block(block_cache_t* cache, int64_t block_offset) {
+    if (cache->blocks[cache->last_block].offset == block_offset)
+        return &cache->blocks[cache->last_block];
+
+    for (int i = 0; i < cache->block_count; i++) {
+        if (cache->blocks[i].offset == block_offset) {
+            cache->last_block = i;
+            return &cache->blocks[i];
+        }
+    }
+
+    return NULL;
+}
+
+static cache_block_t* load_block(block_cache_t* cache, int64_t block_offset) {
+    int pos = 0;
+
+    /* pick an unused block, or the least recently used one */
+    for (int i = 0; i < cache->block_count; i++) {
+        if (cache->blocks[i].offset < 0) {
+            pos = i;
+            break;
+        }
+        if (cache->blocks[i].last_used < cache->blocks[pos].last_used)
+            pos = i;
+    }
+
+    cache_block_t* block = &cache->blocks[pos];
+    if (block->offset >= 0)
+        cache->stats->evictions++;
+    cache->stats->misses++;
+
+    size_t to_read = cache->block_size;
+    if (block_offset + to_read > cache->file_size)
+        to_read = cache->file_size - block_offset;
+
+    block->valid_size = cache->read(cache->arg, block->buf, block_offset, to_read);
+    cache->stats->bytes += block->valid_size;
+    if (block->valid_size == 0) {
+        block->offset = -1;
+        return NULL;
+    }
+
+    block->offset = block_offset;
+    cache->last_block = pos;
+    return block;
+}
+
+const uint8_t* block_cache_get_view(block_cache_t* cache, int64_t offset, size_t length) {
+    if (!cache || offset < 0 || offset + length > cache->file_size)
+        return NULL;
+
+    int64_t block_offset = offset - (offset % cache->block_size);
+    size_t block_into = offset - block_offset;
+    if (block_into + length > cache->block_size)
+        return NULL;
+
+    cache_block_t* block = find_block(cache, block_offset);
+    if (block) {
+        cache->stats->hits++;
+    }
+    else {
+        block = load_block(cache, block_offset);
+        if (!block)
+            return NULL;
+    }
+    block->last_used = ++cache->tick;
+
+    if (block_into + length > block->valid_size)
+        return NULL;
+    return block->buf + block_into;
+}
+
+size_t block_cache_read(block_cache_t* cache, uint8_t* dst, int64_t offset, size_t length) {
+    size_t read_total = 0;
+
+    if (!cache || !dst || length == 0 || offset < 0)
+        return 0;
+
+    while (length > 0) {
+        if (offset >= cache->file_size)
+            break;
+
+        int64_t block_offset = offset - (offset % cache->block_size);
+        size_t block_into = offset - block_offset;
+
+        cache_block_t* block = find_block(cache, block_offset);
+
+        /* reads of whole blocks go directly to dst, as caching them would just evict more useful blocks */
+        if (!block && block_into == 0 && length >= cache->block_size) {
+            size_t to_read = length - (length % cache->block_size);
+            size_t bytes = cache->read(cache->arg, dst, offset, to_read);
+
+            cache->stats->bypasses += to_read / cache->block_size;
+            cache->stats->bytes += bytes;
+            read_total += bytes;
+            if (bytes < to_read)
+                break;
+
+            offset += bytes;
+            dst += bytes;
+            length -= bytes;
+            continue;
+        }
+
+        if (block) {
+            cache->stats->hits++;
+        }
+        else {
+            block = load_block(cache, block_offset);
+            if (!block)
+                break;
+        }
+        block->last_used = ++cache->tick;
+
+        if (block_into >= block->valid_size)
+            break;
+
+        size_t bytes = block->valid_size - block_into;
+        if (bytes > length)
+            bytes = length;
+
+        memcpy(dst, block->buf + block_into, bytes);
+        read_total += bytes;
+        offset += bytes;
+        dst += bytes;
+        length -= bytes;
+
+        /* give up on partial blocks (EOF) */
+        if (block->valid_size < cache->block_size)
+            break;
+    }
+
+    return read_total;
+}
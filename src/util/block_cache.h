@@ -0,0 +1,35 @@
+#ifndef _BLOCK_CACHE_H
+#define _BLOCK_CACHE_H
+#include <stdint.h>
+#include <stddef.h>
+
+/* N-way read cache of fixed-size (aligned) blocks with LRU eviction, for IO backends that
+ * otherwise keep a single buffer window and rebuffer on interleaved reads. */
+
+typedef struct {
+    int64_t hits;           /* blocks found in cache */
+    int64_t misses;         /* blocks loaded into cache */
+    int64_t evictions;      /* misses that replaced a used block */
+    int64_t bypasses;       /* blocks read directly into dst (big reads) */
+    int64_t bytes;          /* bytes read from the underlying IO */
+} block_cache_stats_t;
+
+typedef struct block_cache_t block_cache_t;
+
+/* reads up to length bytes at offset into dst, returns bytes done (less on EOF/errors) */
+typedef size_t (*block_cache_read_t)(void* arg, uint8_t* dst, int64_t offset, size_t length);
+
+/* Creates a cache of block_count blocks of block_size bytes (0 for defaults).
+ * Stats may point to an external struct (must outlive the cache), or NULL to use internal ones. */
+block_cache_t* block_cache_init(int block_count, size_t block_size, int64_t file_size, block_cache_read_t read, void* arg, block_cache_stats_t* stats);
+void block_cache_free(block_cache_t* cache);
+
+size_t block_cache_read(block_cache_t* cache, uint8_t* dst, int64_t offset, size_t length);
+
+/* Returns a pointer to cached data if offset + length is inside a single block (loading it if needed), or NULL.
+ * Only valid until the next call. */
+const uint8_t* block_cache_get_view(block_cache_t* cache, int64_t offset, size_t length);
+
+const block_cache_stats_t* block_cache_get_stats(block_cache_t* cache);
+
+#endif
@@ -6,6 +6,8 @@
 #define UTF_MAX_STRINGS_SIZE    0x80000     // arbitrary max (known max is ~0x20000)
 #define UTF_MAX_COLUMNS         256         // arbitrary max (~100 is not uncommon for .acb)
 #define UTF_MAX_ROWS            128000      // arbitrary max (unlikely but maybe for many subsongs)
+#define UTF_MAX_ROWS_BUF_SIZE   0x800000    // arbitrary max for preloaded rows (typically 0x10000~0x50000)
+#define UTF_COLUMN_HASH_SIZE    512         // power of 2, at least 2x UTF_MAX_COLUMNS
 #define COLUMN_BITMASK_FLAG     0xF0
 #define COLUMN_BITMASK_TYPE     0x0F
 
@@ -36,8 +38,11 @@ enum column_type_t {
 typedef struct {
     uint8_t flag;
     uint8_t type;
+    uint8_t value_size;
     const char* name;
     uint32_t offset;
+
+    void* values;               // decoded row values as a typed array (on first access)
 } utf_column_t;
 
 /* @UTF table sections
@@ -74,9 +79,42 @@ struct utf_context {
     uint32_t strings_size;
     char* string_table;
     const char* table_name;
+
+    /* column name to index+1 (0 = empty slot) */
+    uint16_t column_hash[UTF_COLUMN_HASH_SIZE];
+
+    /* rows section, loaded on first row column access (NULL + rows_failed if too big/unreadable) */
+    uint8_t* rows_buf;
+    uint32_t rows_buf_size;
+    bool rows_failed;
 };
 
 
+static uint32_t utf_hash_name(const char* name) {
+    uint32_t hash = 0x811c9dc5;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static void utf_hash_column(utf_context* utf, int column) {
+    const char* name = utf->schema[column].name;
+    if (!name)
+        return;
+
+    uint32_t pos = utf_hash_name(name) & (UTF_COLUMN_HASH_SIZE - 1);
+    while (utf->column_hash[pos]) {
+        // repeated names resolve to the first column, same as a linear search
+        if (strcmp(utf->schema[utf->column_hash[pos] - 1].name, name) == 0)
+            return;
+        pos = (pos + 1) & (UTF_COLUMN_HASH_SIZE - 1);
+    }
+    utf->column_hash[pos] = column + 1;
+}
+
+
 /* @UTF table context creation */
 utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const char** p_row_name) {
     utf_context* utf = NULL;
@@ -246,6 +284,7 @@ utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const
                     vgm_logi("@UTF: unknown column type\n");
                     goto fail;
             }
+            utf->schema[i].value_size = value_size;
 
             if (utf->schema[i].flag & COLUMN_FLAG_NAME) {
                 utf->schema[i].name = utf->string_table + name_offset;
@@ -280,6 +319,17 @@ utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const
                 // Should be 'row_column_offset > utf->row_width', but after HCA v3 was added UTFs Header-row's
                 // last columns point to blank data after row_width rather than using COLUMN_FLAG_DEFAULT (bug?).
             }
+
+            utf_hash_column(utf, i);
+        }
+
+        // last row may read past rows_size (see above), so buffer must cover that too
+        if (utf->rows > 0) {
+            uint64_t rows_buf_size = (uint64_t)(utf->rows - 1) * utf->row_width + row_column_offset;
+            if (rows_buf_size > UTF_MAX_ROWS_BUF_SIZE || rows_buf_size > utf->table_size - utf->rows_offset)
+                utf->rows_failed = true;
+            else
+                utf->rows_buf_size = rows_buf_size;
         }
     }
 
@@ -306,27 +356,86 @@ fail:
 void utf_close(utf_context* utf) {
     if (!utf) return;
 
+    if (utf->schema) {
+        for (int i = 0; i < utf->columns; i++) {
+            free(utf->schema[i].values);
+        }
+    }
     free(utf->string_table);
     free(utf->schema_buf);
     free(utf->schema);
+    free(utf->rows_buf);
     free(utf);
 }
 
 
 int utf_get_column(utf_context* utf, const char* column_name) {
+    if (!column_name)
+        return -1;
 
     /* find target column */
-    for (int i = 0; i < utf->columns; i++) {
-        utf_column_t* col = &utf->schema[i];
-
-        if (col->name == NULL || strcmp(col->name, column_name) != 0)
-            continue;
-        return i;
+    uint32_t pos = utf_hash_name(column_name) & (UTF_COLUMN_HASH_SIZE - 1);
+    while (utf->column_hash[pos]) {
+        int column = utf->column_hash[pos] - 1;
+        if (strcmp(utf->schema[column].name, column_name) == 0)
+            return column;
+        pos = (pos + 1) & (UTF_COLUMN_HASH_SIZE - 1);
     }
 
     return -1;
 }
 
+/* Decodes all rows of a column into a typed array (VLDATA as offset+size pairs), so callers that
+ * walk thousands of rows (like .acb cues) don't do a streamfile read per value. Returns NULL
+ * if rows can't be preloaded, in which case values are read from the streamfile as usual. */
+static void* utf_load_column(utf_context* utf, utf_column_t* col) {
+    if (col->values)
+        return col->values;
+    if (utf->rows_failed || utf->rows <= 0)
+        return NULL;
+
+    if (!utf->rows_buf) {
+        utf->rows_buf = malloc(utf->rows_buf_size);
+        if (!utf->rows_buf) goto fail;
+
+        int bytes = read_streamfile(utf->rows_buf, utf->table_offset + utf->rows_offset, utf->rows_buf_size, utf->sf);
+        if (bytes != utf->rows_buf_size) goto fail;
+    }
+
+    col->values = malloc(utf->rows * col->value_size);
+    if (!col->values) goto fail;
+
+    const uint8_t* buf = utf->rows_buf + col->offset;
+    for (int i = 0; i < utf->rows; i++) {
+        switch (col->value_size) {
+            case 0x01: ((uint8_t*)col->values)[i] = get_u8(buf); break;
+            case 0x02: ((uint16_t*)col->values)[i] = get_u16be(buf); break;
+            case 0x04: ((uint32_t*)col->values)[i] = get_u32be(buf); break;
+            case 0x08:
+                if (col->type == COLUMN_TYPE_VLDATA) {
+                    ((uint32_t*)col->values)[i * 2 + 0] = get_u32be(buf + 0x00);
+                    ((uint32_t*)col->values)[i * 2 + 1] = get_u32be(buf + 0x04);
+                }
+                else {
+                    ((uint64_t*)col->values)[i] = get_u64be(buf);
+                }
+                break;
+            default:
+                goto fail;
+        }
+        buf += utf->row_width;
+    }
+
+    return col->values;
+fail:
+    free(col->values);
+    col->values = NULL;
+    free(utf->rows_buf);
+    utf->rows_buf = NULL;
+    utf->rows_failed = true;
+    return NULL;
+}
+
 typedef struct {
     enum column_type_t type;
     union {
@@ -354,6 +463,39 @@ typedef struct {
     } value;
 } utf_result_t;
 
+static bool utf_query_values(utf_context* utf, int row, utf_column_t* col, void* values, utf_result_t* result) {
+    switch (col->type) {
+        case COLUMN_TYPE_UINT8:  result->value.u8  = ((uint8_t*)values)[row]; break;
+        case COLUMN_TYPE_SINT8:  result->value.s8  = ((uint8_t*)values)[row]; break;
+        case COLUMN_TYPE_UINT16: result->value.u16 = ((uint16_t*)values)[row]; break;
+        case COLUMN_TYPE_SINT16: result->value.s16 = ((uint16_t*)values)[row]; break;
+        case COLUMN_TYPE_UINT32: result->value.u32 = ((uint32_t*)values)[row]; break;
+        case COLUMN_TYPE_SINT32: result->value.s32 = ((uint32_t*)values)[row]; break;
+        case COLUMN_TYPE_UINT64: result->value.u64 = ((uint64_t*)values)[row]; break;
+        case COLUMN_TYPE_SINT64: result->value.s64 = ((uint64_t*)values)[row]; break;
+        case COLUMN_TYPE_FLOAT: {
+            uint32_t bits = ((uint32_t*)values)[row];
+            memcpy(&result->value.flt, &bits, sizeof(bits));
+            break;
+        }
+        case COLUMN_TYPE_STRING: {
+            uint32_t name_offset = ((uint32_t*)values)[row];
+            if (name_offset > utf->strings_size)
+                return false;
+            result->value.str = utf->string_table + name_offset;
+            break;
+        }
+        case COLUMN_TYPE_VLDATA:
+            result->value.data.offset = ((uint32_t*)values)[row * 2 + 0];
+            result->value.data.size   = ((uint32_t*)values)[row * 2 + 1];
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
 static bool utf_query(utf_context* utf, int row, int column, utf_result_t* result) {
 
     if (row >= utf->rows || row < 0)
@@ -375,6 +517,10 @@ static bool utf_query(utf_context* utf, int row, int column, utf_result_t* resul
             data_offset = utf->table_offset + utf->schema_offset + col->offset;
     }
     else if (col->flag & COLUMN_FLAG_ROW) {
+        void* values = utf_load_column(utf, col);
+        if (values)
+            return utf_query_values(utf, row, col, values, result);
+
         data_offset = utf->table_offset + utf->rows_offset + row * utf->row_width + col->offset;
     }
     else {
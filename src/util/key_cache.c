@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "key_cache.h"
+#include "threads.h"
+#include "log.h"
+
+#define KEY_CACHE_ID_MAX    8
+#define KEY_CACHE_HASH_SIZE 0x1000
+#define KEY_CACHE_RECENT    8       /* for all types */
+#define KEY_CACHE_LINE_MAX  (0x40 + KEY_CACHE_MAX_SIZE * 2)
+
+typedef struct {
+    char id[KEY_CACHE_ID_MAX];
+    uint16_t subkey;
+    uint64_t file_size;
+    uint64_t hash;
+    uint8_t key[KEY_CACHE_MAX_SIZE];
+    size_t key_size;
+} key_entry_t;
+
+typedef struct {
+    key_entry_t* entries;
+    int count;
+    int capacity;
+
+    int recent[KEY_CACHE_RECENT];   /* entry indexes, most recent first */
+    int recent_count;
+
+    char* filename;
+    vgm_mutex_t* mutex;
+} key_cache_t;
+
+static key_cache_t* cache = NULL;
+
+
+/* FNV-1a, enough to tell files apart */
+static uint64_t get_hash(const uint8_t* buf, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (int i = 0; i < size; i++) {
+        hash ^= buf[i];
+        hash *= 0x100000001B3;
+    }
+    return hash;
+}
+
+static bool get_fingerprint(STREAMFILE* sf, const char* id, uint16_t subkey, key_entry_t* entry) {
+    uint8_t buf[KEY_CACHE_HASH_SIZE];
+
+    if (!sf || !id || strlen(id) >= KEY_CACHE_ID_MAX)
+        return false;
+
+    size_t file_size = get_streamfile_size(sf);
+    size_t size = file_size < sizeof(buf) ? file_size : sizeof(buf);
+    if (read_streamfile(buf, 0x00, size, sf) != size)
+        return false;
+
+    strcpy(entry->id, id);
+    entry->subkey = subkey;
+    entry->file_size = file_size;
+    entry->hash = get_hash(buf, size);
+    return true;
+}
+
+static bool is_same_file(const key_entry_t* a, const key_entry_t* b) {
+    return a->file_size == b->file_size && a->hash == b->hash && a->subkey == b->subkey && strcmp(a->id, b->id) == 0;
+}
+
+static bool is_same_key(const key_entry_t* a, const key_entry_t* b) {
+    return a->key_size == b->key_size && memcmp(a->key, b->key, a->key_size) == 0 && strcmp(a->id, b->id) == 0;
+}
+
+static void add_recent(int index) {
+    const key_entry_t* entry = &cache->entries[index];
+
+    /* remove older entry with the same key so different keys stay around */
+    int count = 0;
+    for (int i = 0; i < cache->recent_count; i++) {
+        if (is_same_key(&cache->entries[cache->recent[i]], entry))
+            continue;
+        cache->recent[count++] = cache->recent[i];
+    }
+    if (count >= KEY_CACHE_RECENT)
+        count = KEY_CACHE_RECENT - 1;
+
+    memmove(cache->recent + 1, cache->recent, count * sizeof(int));
+    cache->recent[0] = index;
+    cache->recent_count = count + 1;
+}
+
+static bool add_entry(const key_entry_t* entry) {
+    if (cache->count >= cache->capacity) {
+        int new_capacity = cache->capacity ? cache->capacity * 2 : 64;
+        key_entry_t* new_entries = realloc(cache->entries, new_capacity * sizeof(key_entry_t));
+        if (!new_entries)
+            return false;
+        cache->entries = new_entries;
+        cache->capacity = new_capacity;
+    }
+
+    cache->entries[cache->count] = *entry;
+    add_recent(cache->count);
+    cache->count++;
+    return true;
+}
+
+
+/* text lines: "(id) (subkey) (file size) (hash) (key hex)" */
+static void load_file(const char* filename) {
+    char line[KEY_CACHE_LINE_MAX];
+    char hex[KEY_CACHE_MAX_SIZE * 2 + 1];
+
+    FILE* file = fopen(filename, "r");
+    if (!file)
+        return; /* created on first save */
+
+    while (fgets(line, sizeof(line), file)) {
+        key_entry_t entry = {0};
+        unsigned int subkey;
+        unsigned long long file_size, hash;
+
+        int count = sscanf(line, "%7s %x %llx %llx %512s", entry.id, &subkey, &file_size, &hash, hex);
+        if (count != 5)
+            continue;
+
+        size_t hex_size = strlen(hex);
+        if (hex_size % 2 != 0 || hex_size / 2 > KEY_CACHE_MAX_SIZE)
+            continue;
+
+        bool ok = true;
+        for (int i = 0; i < hex_size / 2; i++) {
+            unsigned int value;
+            if (sscanf(hex + i * 2, "%2x", &value) != 1) {
+                ok = false;
+                break;
+            }
+            entry.key[i] = value;
+        }
+        if (!ok)
+            continue;
+
+        entry.subkey = subkey;
+        entry.file_size = file_size;
+        entry.hash = hash;
+        entry.key_size = hex_size / 2;
+        if (!add_entry(&entry))
+            break;
+    }
+
+    fclose(file);
+}
+
+static void save_entry(const key_entry_t* entry) {
+    if (!cache->filename)
+        return;
+
+    FILE* file = fopen(cache->filename, "a");
+    if (!file) {
+        VGM_LOG("KEY CACHE: can't write %s\n", cache->filename);
+        return;
+    }
+
+    fprintf(file, "%s %04x %llx %016llx ", entry->id, entry->subkey, (unsigned long long)entry->file_size, (unsigned long long)entry->hash);
+    for (int i = 0; i < entry->key_size; i++) {
+        fprintf(file, "%02x", entry->key[i]);
+    }
+    fprintf(file, "\n");
+
+    fclose(file);
+}
+
+
+bool key_cache_init(const char* filename) {
+    key_cache_free();
+
+    cache = calloc(1, sizeof(key_cache_t));
+    if (!cache) goto fail;
+
+    cache->mutex = vgm_mutex_init();
+    if (!cache->mutex) goto fail;
+
+    if (filename) {
+        cache->filename = malloc(strlen(filename) + 1);
+        if (!cache->filename) goto fail;
+        strcpy(cache->filename, filename);
+
+        load_file(filename);
+    }
+
+    return true;
+fail:
+    key_cache_free();
+    return false;
+}
+
+void key_cache_free(void) {
+    if (!cache)
+        return;
+
+    vgm_mutex_free(cache->mutex);
+    free(cache->filename);
+    free(cache->entries);
+    free(cache);
+    cache = NULL;
+}
+
+size_t key_cache_get(STREAMFILE* sf, const char* id, uint16_t subkey, uint8_t* key, size_t key_size) {
+    key_entry_t entry;
+    size_t done = 0;
+
+    if (!cache)
+        return 0;
+    if (!get_fingerprint(sf, id, subkey, &entry))
+        return 0;
+
+    vgm_mutex_lock(cache->mutex);
+    /* last entry wins, in case a file's key was updated */
+    for (int i = cache->count - 1; i >= 0; i--) {
+        const key_entry_t* found = &cache->entries[i];
+        if (!is_same_file(found, &entry))
+            continue;
+
+        if (found->key_size <= key_size) {
+            memcpy(key, found->key, found->key_size);
+            done = found->key_size;
+        }
+        break;
+    }
+    vgm_mutex_unlock(cache->mutex);
+
+    return done;
+}
+
+size_t key_cache_get_recent(const char* id, int index, uint8_t* key, size_t key_size) {
+    size_t done = 0;
+
+    if (!cache || !id)
+        return 0;
+
+    vgm_mutex_lock(cache->mutex);
+    for (int i = 0; i < cache->recent_count; i++) {
+        const key_entry_t* found = &cache->entries[cache->recent[i]];
+        if (strcmp(found->id, id) != 0)
+            continue;
+
+        if (index > 0) {
+            index--;
+            continue;
+        }
+
+        if (found->key_size <= key_size) {
+            memcpy(key, found->key, found->key_size);
+            done = found->key_size;
+        }
+        break;
+    }
+    vgm_mutex_unlock(cache->mutex);
+
+    return done;
+}
+
+void key_cache_add(STREAMFILE* sf, const char* id, uint16_t subkey, const uint8_t* key, size_t key_size) {
+    key_entry_t entry;
+
+    if (!cache || key_size > KEY_CACHE_MAX_SIZE)
+        return;
+    if (!get_fingerprint(sf, id, subkey, &entry))
+        return;
+
+    memcpy(entry.key, key, key_size);
+    entry.key_size = key_size;
+
+    vgm_mutex_lock(cache->mutex);
+    bool cached = false;
+    for (int i = cache->count - 1; i >= 0; i--) {
+        if (!is_same_file(&cache->entries[i], &entry))
+            continue;
+
+        cached = is_same_key(&cache->entries[i], &entry);
+        if (cached)
+            add_recent(i);
+        break;
+    }
+
+    if (!cached && add_entry(&entry))
+        save_entry(&entry);
+    vgm_mutex_unlock(cache->mutex);
+}
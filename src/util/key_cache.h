@@ -0,0 +1,30 @@
+#ifndef _KEY_CACHE_H
+#define _KEY_CACHE_H
+
+#include "../streamfile.h"
+
+/* Optional process-wide cache of keys found by key searches of encrypted formats (HCA/ADX/FSB), so reopening
+ * files or other subsongs/files of the same bank don't need to test the whole key list again.
+ *
+ * Files are identified by a fingerprint (file size + hash of the first 0x1000 bytes + subkey) and each format
+ * stores its key in whatever form it needs. Formats should treat cached keys as candidates to test first
+ * (a fingerprint could rarely match a different file). Last found keys are also kept as candidates for new
+ * files, since banks usually share one key. */
+
+#define KEY_CACHE_MAX_SIZE 0x100
+
+/* Enables the cache, also loading and saving found keys to a text file if filename is set (may be NULL).
+ * Not thread-safe, should be called before opening files (cache functions are thread-safe after that). */
+bool key_cache_init(const char* filename);
+void key_cache_free(void);
+
+/* Copies the cached key of type id for this file. Returns key size, or 0 if not found/disabled. */
+size_t key_cache_get(STREAMFILE* sf, const char* id, uint16_t subkey, uint8_t* key, size_t key_size);
+
+/* Copies the Nth (0 = last) key of type id found in any file. Returns key size, or 0 if not found/disabled. */
+size_t key_cache_get_recent(const char* id, int index, uint8_t* key, size_t key_size);
+
+/* Saves key of type id that decrypted this file. */
+void key_cache_add(STREAMFILE* sf, const char* id, uint16_t subkey, const uint8_t* key, size_t key_size);
+
+#endif
@@ -10,30 +10,40 @@
 static inline int16_t read_16bitLE(off_t offset, STREAMFILE* sf) {
     uint8_t buf[2];
 
+    const uint8_t* view = get_streamfile_view(offset, 2, sf);
+    if (view) return get_s16le(view);
     if (read_streamfile(buf,offset,2,sf)!=2) return -1;
     return get_s16le(buf);
 }
 static inline int16_t read_16bitBE(off_t offset, STREAMFILE* sf) {
     uint8_t buf[2];
 
+    const uint8_t* view = get_streamfile_view(offset, 2, sf);
+    if (view) return get_s16be(view);
     if (read_streamfile(buf,offset,2,sf)!=2) return -1;
     return get_s16be(buf);
 }
 static inline int32_t read_32bitLE(off_t offset, STREAMFILE* sf) {
     uint8_t buf[4];
 
+    const uint8_t* view = get_streamfile_view(offset, 4, sf);
+    if (view) return get_s32le(view);
     if (read_streamfile(buf,offset,4,sf)!=4) return -1;
     return get_s32le(buf);
 }
 static inline int32_t read_32bitBE(off_t offset, STREAMFILE* sf) {
     uint8_t buf[4];
 
+    const uint8_t* view = get_streamfile_view(offset, 4, sf);
+    if (view) return get_s32be(view);
     if (read_streamfile(buf,offset,4,sf)!=4) return -1;
     return get_s32be(buf);
 }
 static inline int64_t read_s64le(off_t offset, STREAMFILE* sf) {
     uint8_t buf[8];
 
+    const uint8_t* view = get_streamfile_view(offset, 8, sf);
+    if (view) return get_s64le(view);
     if (read_streamfile(buf,offset,8,sf)!=8) return -1;
     return get_s64le(buf);
 }
@@ -42,6 +52,8 @@ static inline uint64_t read_u64le(off_t offset, STREAMFILE* sf) { return (uint64
 static inline int64_t read_s64be(off_t offset, STREAMFILE* sf) {
     uint8_t buf[8];
 
+    const uint8_t* view = get_streamfile_view(offset, 8, sf);
+    if (view) return get_s64be(view);
     if (read_streamfile(buf,offset,8,sf)!=8) return -1;
     return get_s64be(buf);
 }
@@ -50,6 +62,8 @@ static inline uint64_t read_u64be(off_t offset, STREAMFILE* sf) { return (uint64
 static inline int8_t read_8bit(off_t offset, STREAMFILE* sf) {
     uint8_t buf[1];
 
+    const uint8_t* view = get_streamfile_view(offset, 1, sf);
+    if (view) return view[0];
     if (read_streamfile(buf,offset,1,sf)!=1) return -1;
     return buf[0];
 }
@@ -69,6 +83,8 @@ static inline uint32_t read_u32be(off_t offset, STREAMFILE* sf) { return (uint32
 static inline float read_f32be(off_t offset, STREAMFILE* sf) {
     uint8_t buf[4];
 
+    const uint8_t* view = get_streamfile_view(offset, 4, sf);
+    if (view) return get_f32be(view);
     if (read_streamfile(buf, offset, sizeof(buf), sf) != sizeof(buf))
         return -1;
     return get_f32be(buf);
@@ -76,6 +92,8 @@ static inline float read_f32be(off_t offset, STREAMFILE* sf) {
 static inline float read_f32le(off_t offset, STREAMFILE* sf) {
     uint8_t buf[4];
 
+    const uint8_t* view = get_streamfile_view(offset, 4, sf);
+    if (view) return get_f32le(view);
     if (read_streamfile(buf, offset, sizeof(buf), sf) != sizeof(buf))
         return -1;
     return get_f32le(buf);
@@ -84,6 +102,8 @@ static inline float read_f32le(off_t offset, STREAMFILE* sf) {
 static inline double read_d64be(off_t offset, STREAMFILE* sf) {
     uint8_t buf[8];
 
+    const uint8_t* view = get_streamfile_view(offset, 8, sf);
+    if (view) return get_d64be(view);
     if (read_streamfile(buf, offset, sizeof(buf), sf) != sizeof(buf))
         return -1;
     return get_d64be(buf);
@@ -92,6 +112,8 @@ static inline double read_d64be(off_t offset, STREAMFILE* sf) {
 static inline double read_d64le(off_t offset, STREAMFILE* sf) {
     uint8_t buf[8];
 
+    const uint8_t* view = get_streamfile_view(offset, 8, sf);
+    if (view) return get_d64le(view);
     if (read_streamfile(buf, offset, sizeof(buf), sf) != sizeof(buf))
         return -1;
     return get_d64le(buf);
@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include "thread_pool.h"
+#include "threads.h"
+
+#define THREAD_POOL_MAX_THREADS 64
+
+/* jobs of one thread_pool_run call (lives in the caller's stack) */
+typedef struct {
+    thread_pool_job_t job;
+    void* arg;
+    int count;
+    int next;                   /* next job index, under mutex */
+} thread_pool_batch_t;
+
+struct thread_pool_t {
+    vgm_thread_t* threads[THREAD_POOL_MAX_THREADS];
+    int thread_count;           /* workers (not including caller) */
+
+    vgm_mutex_t* mutex;
+    vgm_sem_t* sem_start;       /* one post per worker that should look for jobs */
+    vgm_sem_t* sem_done;        /* one post per worker that found no more jobs */
+
+    thread_pool_batch_t* batch; /* batch that owns the workers (NULL if idle), under mutex */
+    bool exit;
+};
+
+
+static bool get_next_job(thread_pool_t* pool, thread_pool_batch_t* batch, int* p_index) {
+    bool found = false;
+
+    vgm_mutex_lock(pool->mutex);
+    if (batch->next < batch->count) {
+        *p_index = batch->next;
+        batch->next++;
+        found = true;
+    }
+    vgm_mutex_unlock(pool->mutex);
+
+    return found;
+}
+
+static void do_jobs(thread_pool_t* pool, thread_pool_batch_t* batch) {
+    int index;
+    while (get_next_job(pool, batch, &index)) {
+        batch->job(batch->arg, index);
+    }
+}
+
+static void thread_pool_worker(void* arg) {
+    thread_pool_t* pool = arg;
+
+    while (true) {
+        vgm_sem_wait(pool->sem_start);
+        if (pool->exit)
+            break;
+
+        /* only woken by the batch's owner, that waits for us before releasing it */
+        vgm_mutex_lock(pool->mutex);
+        thread_pool_batch_t* batch = pool->batch;
+        vgm_mutex_unlock(pool->mutex);
+
+        do_jobs(pool, batch);
+        vgm_sem_post(pool->sem_done);
+    }
+}
+
+
+thread_pool_t* thread_pool_init(int threads) {
+    thread_pool_t* pool = NULL;
+
+    if (threads <= 0)
+        threads = vgm_thread_get_cpus();
+    if (threads > THREAD_POOL_MAX_THREADS + 1)
+        threads = THREAD_POOL_MAX_THREADS + 1;
+    if (threads <= 1)
+        return NULL;
+
+    pool = calloc(1, sizeof(thread_pool_t));
+    if (!pool) goto fail;
+
+    pool->mutex = vgm_mutex_init();
+    pool->sem_start = vgm_sem_init(0);
+    pool->sem_done = vgm_sem_init(0);
+    if (!pool->mutex || !pool->sem_start || !pool->sem_done) goto fail;
+
+    for (int i = 0; i < threads - 1; i++) {
+        pool->threads[i] = vgm_thread_create(thread_pool_worker, pool);
+        if (!pool->threads[i])
+            break; /* use what we got */
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) goto fail;
+
+    return pool;
+fail:
+    thread_pool_free(pool);
+    return NULL;
+}
+
+static void run_jobs(thread_pool_job_t job, void* arg, int count) {
+    for (int i = 0; i < count; i++) {
+        job(arg, i);
+    }
+}
+
+void thread_pool_run(thread_pool_t* pool, thread_pool_job_t job, void* arg, int count) {
+    if (count <= 0)
+        return;
+
+    if (!pool || count == 1) {
+        run_jobs(job, arg, count);
+        return;
+    }
+
+    thread_pool_batch_t batch = {
+        .job = job,
+        .arg = arg,
+        .count = count,
+        .next = 0,
+    };
+
+    /* workers serve one batch at a time; other callers (another thread or a job
+     * calling back into the pool) do their own jobs rather than wait */
+    vgm_mutex_lock(pool->mutex);
+    bool busy = pool->batch != NULL;
+    if (!busy)
+        pool->batch = &batch;
+    vgm_mutex_unlock(pool->mutex);
+
+    if (busy) {
+        run_jobs(job, arg, count);
+        return;
+    }
+
+    int wakes = count - 1; /* caller takes one */
+    if (wakes > pool->thread_count)
+        wakes = pool->thread_count;
+
+    for (int i = 0; i < wakes; i++) {
+        vgm_sem_post(pool->sem_start);
+    }
+
+    do_jobs(pool, &batch);
+
+    /* workers may still be running their last job */
+    for (int i = 0; i < wakes; i++) {
+        vgm_sem_wait(pool->sem_done);
+    }
+
+    vgm_mutex_lock(pool->mutex);
+    pool->batch = NULL;
+    vgm_mutex_unlock(pool->mutex);
+}
+
+int thread_pool_get_threads(thread_pool_t* pool) {
+    if (!pool)
+        return 1;
+    return pool->thread_count + 1;
+}
+
+void thread_pool_free(thread_pool_t* pool) {
+    if (!pool)
+        return;
+
+    pool->exit = true;
+    for (int i = 0; i < pool->thread_count; i++) {
+        vgm_sem_post(pool->sem_start);
+    }
+    for (int i = 0; i < pool->thread_count; i++) {
+        vgm_thread_join(pool->threads[i]);
+    }
+
+    vgm_mutex_free(pool->mutex);
+    vgm_sem_free(pool->sem_start);
+    vgm_sem_free(pool->sem_done);
+    free(pool);
+}
+
+
+static thread_pool_t* shared_pool;
+static int shared_claimed;
+static int shared_ready;
+
+thread_pool_t* thread_pool_get_shared(void) {
+    /* atomic ops order the pool's creation before its use in other threads */
+    if (vgm_atomic_add(&shared_ready, 0))
+        return shared_pool;
+
+    /* first caller creates it; others do their work alone meanwhile rather than wait */
+    if (vgm_atomic_add(&shared_claimed, 1) != 1)
+        return NULL;
+
+    shared_pool = thread_pool_init(0);
+    vgm_atomic_add(&shared_ready, 1);
+    return shared_pool;
+}
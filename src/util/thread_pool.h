@@ -0,0 +1,32 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+/* Fixed set of worker threads that run batches of independent jobs (ex. one per layer).
+ * The calling thread also takes jobs, so a pool of N threads uses N-1 workers.
+ *
+ * A pool may be shared: if thread_pool_run is called while another batch is using the workers
+ * (from another thread, or from inside a job) the new batch runs in the calling thread instead. */
+
+typedef struct thread_pool_t thread_pool_t;
+
+/* called once per job index (0..count-1), from any thread */
+typedef void (*thread_pool_job_t)(void* arg, int index);
+
+/* Creates a pool for N threads (<= 0 = number of CPUs). Returns NULL on error or if it wouldn't use
+ * more than one thread, so callers must be able to do the work themselves. */
+thread_pool_t* thread_pool_init(int threads);
+
+/* Runs job(arg, i) for all i < count and waits until all are done. Pool may be NULL or busy (runs in current thread). */
+void thread_pool_run(thread_pool_t* pool, thread_pool_job_t job, void* arg, int count);
+
+/* Number of threads that may run jobs at once (1 if pool is NULL). */
+int thread_pool_get_threads(thread_pool_t* pool);
+
+void thread_pool_free(thread_pool_t* pool);
+
+/* Process-wide pool (one thread per CPU) for work that isn't tied to a stream (ex. key searches), created
+ * on first use and kept until exit since thread creation isn't free. Returns NULL if unavailable, or while
+ * another thread is still creating it. Must not be passed to thread_pool_free. */
+thread_pool_t* thread_pool_get_shared(void);
+
+#endif
@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include "threads.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    #define VGM_DISABLE_THREADS
+#endif
+
+#if defined(VGM_DISABLE_THREADS)
+    /* nothing */
+#elif defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #define USE_THREADS_WIN32
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #define USE_THREADS_PTHREAD
+#endif
+
+
+#if defined(USE_THREADS_WIN32)
+
+struct vgm_thread_t {
+    HANDLE handle;
+    void (*func)(void* arg);
+    void* arg;
+};
+
+struct vgm_mutex_t {
+    CRITICAL_SECTION cs;
+};
+
+struct vgm_sem_t {
+    HANDLE handle;
+};
+
+static DWORD WINAPI thread_main(LPVOID param) {
+    vgm_thread_t* thread = param;
+    thread->func(thread->arg);
+    return 0;
+}
+
+vgm_thread_t* vgm_thread_create(void (*func)(void* arg), void* arg) {
+    vgm_thread_t* thread = calloc(1, sizeof(vgm_thread_t));
+    if (!thread) return NULL;
+
+    thread->func = func;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+    if (!thread->handle) {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void vgm_thread_join(vgm_thread_t* thread) {
+    if (!thread)
+        return;
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+int vgm_thread_get_cpus(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+vgm_mutex_t* vgm_mutex_init(void) {
+    vgm_mutex_t* mutex = calloc(1, sizeof(vgm_mutex_t));
+    if (!mutex) return NULL;
+    InitializeCriticalSection(&mutex->cs);
+    return mutex;
+}
+
+void vgm_mutex_lock(vgm_mutex_t* mutex) {
+    EnterCriticalSection(&mutex->cs);
+}
+
+void vgm_mutex_unlock(vgm_mutex_t* mutex) {
+    LeaveCriticalSection(&mutex->cs);
+}
+
+void vgm_mutex_free(vgm_mutex_t* mutex) {
+    if (!mutex)
+        return;
+    DeleteCriticalSection(&mutex->cs);
+    free(mutex);
+}
+
+vgm_sem_t* vgm_sem_init(int count) {
+    vgm_sem_t* sem = calloc(1, sizeof(vgm_sem_t));
+    if (!sem) return NULL;
+
+    sem->handle = CreateSemaphore(NULL, count, 0x7FFFFFFF, NULL);
+    if (!sem->handle) {
+        free(sem);
+        return NULL;
+    }
+    return sem;
+}
+
+void vgm_sem_wait(vgm_sem_t* sem) {
+    WaitForSingleObject(sem->handle, INFINITE);
+}
+
+void vgm_sem_post(vgm_sem_t* sem) {
+    ReleaseSemaphore(sem->handle, 1, NULL);
+}
+
+void vgm_sem_free(vgm_sem_t* sem) {
+    if (!sem)
+        return;
+    CloseHandle(sem->handle);
+    free(sem);
+}
+
+int vgm_atomic_add(int* value, int add) {
+    return InterlockedExchangeAdd((volatile LONG*)value, add) + add;
+}
+
+#elif defined(USE_THREADS_PTHREAD)
+
+struct vgm_thread_t {
+    pthread_t handle;
+    void (*func)(void* arg);
+    void* arg;
+};
+
+struct vgm_mutex_t {
+    pthread_mutex_t mutex;
+};
+
+/* unnamed POSIX semaphores aren't available in all systems (Mac), so use a mutex + cond */
+struct vgm_sem_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;
+};
+
+static void* thread_main(void* param) {
+    vgm_thread_t* thread = param;
+    thread->func(thread->arg);
+    return NULL;
+}
+
+vgm_thread_t* vgm_thread_create(void (*func)(void* arg), void* arg) {
+    vgm_thread_t* thread = calloc(1, sizeof(vgm_thread_t));
+    if (!thread) return NULL;
+
+    thread->func = func;
+    thread->arg = arg;
+    if (pthread_create(&thread->handle, NULL, thread_main, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void vgm_thread_join(vgm_thread_t* thread) {
+    if (!thread)
+        return;
+    pthread_join(thread->handle, NULL);
+    free(thread);
+}
+
+int vgm_thread_get_cpus(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+#else
+    return 1;
+#endif
+}
+
+vgm_mutex_t* vgm_mutex_init(void) {
+    vgm_mutex_t* mutex = calloc(1, sizeof(vgm_mutex_t));
+    if (!mutex) return NULL;
+
+    if (pthread_mutex_init(&mutex->mutex, NULL) != 0) {
+        free(mutex);
+        return NULL;
+    }
+    return mutex;
+}
+
+void vgm_mutex_lock(vgm_mutex_t* mutex) {
+    pthread_mutex_lock(&mutex->mutex);
+}
+
+void vgm_mutex_unlock(vgm_mutex_t* mutex) {
+    pthread_mutex_unlock(&mutex->mutex);
+}
+
+void vgm_mutex_free(vgm_mutex_t* mutex) {
+    if (!mutex)
+        return;
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+vgm_sem_t* vgm_sem_init(int count) {
+    vgm_sem_t* sem = calloc(1, sizeof(vgm_sem_t));
+    if (!sem) return NULL;
+
+    if (pthread_mutex_init(&sem->mutex, NULL) != 0) {
+        free(sem);
+        return NULL;
+    }
+    if (pthread_cond_init(&sem->cond, NULL) != 0) {
+        pthread_mutex_destroy(&sem->mutex);
+        free(sem);
+        return NULL;
+    }
+    sem->count = count;
+    return sem;
+}
+
+void vgm_sem_wait(vgm_sem_t* sem) {
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count <= 0) {
+        pthread_cond_wait(&sem->cond, &sem->mutex);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+void vgm_sem_post(vgm_sem_t* sem) {
+    pthread_mutex_lock(&sem->mutex);
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+void vgm_sem_free(vgm_sem_t* sem) {
+    if (!sem)
+        return;
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+}
+
+#if defined(__GNUC__) /* clang too */
+int vgm_atomic_add(int* value, int add) {
+    return __atomic_add_fetch(value, add, __ATOMIC_ACQ_REL);
+}
+#else
+static pthread_mutex_t atomic_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+int vgm_atomic_add(int* value, int add) {
+    pthread_mutex_lock(&atomic_mutex);
+    int result = (*value += add);
+    pthread_mutex_unlock(&atomic_mutex);
+    return result;
+}
+#endif
+
+#else
+
+/* no threads: sync objects are simple stubs so callers don't need to special-case them */
+struct vgm_mutex_t {
+    int dummy;
+};
+
+struct vgm_sem_t {
+    int count;
+};
+
+vgm_thread_t* vgm_thread_create(void (*func)(void* arg), void* arg) {
+    return NULL;
+}
+
+void vgm_thread_join(vgm_thread_t* thread) {
+}
+
+int vgm_thread_get_cpus(void) {
+    return 1;
+}
+
+vgm_mutex_t* vgm_mutex_init(void) {
+    return calloc(1, sizeof(vgm_mutex_t));
+}
+
+void vgm_mutex_lock(vgm_mutex_t* mutex) {
+}
+
+void vgm_mutex_unlock(vgm_mutex_t* mutex) {
+}
+
+void vgm_mutex_free(vgm_mutex_t* mutex) {
+    free(mutex);
+}
+
+vgm_sem_t* vgm_sem_init(int count) {
+    vgm_sem_t* sem = calloc(1, sizeof(vgm_sem_t));
+    if (!sem) return NULL;
+    sem->count = count;
+    return sem;
+}
+
+void vgm_sem_wait(vgm_sem_t* sem) {
+    sem->count--;
+}
+
+void vgm_sem_post(vgm_sem_t* sem) {
+    sem->count++;
+}
+
+void vgm_sem_free(vgm_sem_t* sem) {
+    free(sem);
+}
+
+int vgm_atomic_add(int* value, int add) {
+    *value += add;
+    return *value;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef _THREADS_H
+#define _THREADS_H
+#include <stdbool.h>
+
+/* Minimal threading helpers (win32 or pthreads).
+ * Threads are always optional: creation returns NULL when unsupported (ex. VGM_DISABLE_THREADS or
+ * emscripten without pthreads), so callers must fall back to doing the work in the current thread. */
+
+typedef struct vgm_thread_t vgm_thread_t;
+typedef struct vgm_mutex_t vgm_mutex_t;
+typedef struct vgm_sem_t vgm_sem_t;
+
+/* Starts a thread calling func(arg). Returns NULL on error or if threads aren't available. */
+vgm_thread_t* vgm_thread_create(void (*func)(void* arg), void* arg);
+
+/* Waits until thread's func returns and frees it. */
+void vgm_thread_join(vgm_thread_t* thread);
+
+/* Number of logical CPUs (1 if unknown or threads aren't available). */
+int vgm_thread_get_cpus(void);
+
+
+vgm_mutex_t* vgm_mutex_init(void);
+void vgm_mutex_lock(vgm_mutex_t* mutex);
+void vgm_mutex_unlock(vgm_mutex_t* mutex);
+void vgm_mutex_free(vgm_mutex_t* mutex);
+
+/* Counting semaphore, for signaling between threads (wait blocks until count > 0 then decrements). */
+vgm_sem_t* vgm_sem_init(int count);
+void vgm_sem_wait(vgm_sem_t* sem);
+void vgm_sem_post(vgm_sem_t* sem);
+void vgm_sem_free(vgm_sem_t* sem);
+
+/* Adds to value as a single operation (for refcounts shared between threads), returns the new value. */
+int vgm_atomic_add(int* value, int add);
+
+#endif
@@ -0,0 +1,30 @@
+#include "timer.h"
+
+#if defined(_WIN32) || defined(WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+int64_t timer_get_us(void) {
+    static LARGE_INTEGER frequency; // constant after boot, setting it multiple times is harmless
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (int64_t)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+           (int64_t)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+}
+
+#else
+#include <time.h>
+
+int64_t timer_get_us(void) {
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#endif
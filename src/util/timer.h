@@ -0,0 +1,9 @@
+#ifndef _TIMER_H
+#define _TIMER_H
+#include <stdint.h>
+
+/* Monotonic wall time in microseconds from some arbitrary point (only useful to calculate intervals).
+ * Mainly for profiling, as precision and cost of the call depends on the system. */
+int64_t timer_get_us(void);
+
+#endif
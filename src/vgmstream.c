@@ -267,6 +267,22 @@ void state_free(VGMSTREAM* vgmstream) {
     free(vgmstream->state);
 }
 
+static void close_channel_streamfiles(VGMSTREAM* vgmstream) {
+    for (int i = 0; i < vgmstream->channels; i++) {
+        if (vgmstream->ch[i].streamfile) {
+            close_streamfile(vgmstream->ch[i].streamfile);
+            /* Multiple channels might have the same streamfile. Find the others
+                * that are the same as this and clear them so they won't be closed again. */
+            for (int j = 0; j < vgmstream->channels; j++) {
+                if (i != j && vgmstream->ch[j].streamfile == vgmstream->ch[i].streamfile) {
+                    vgmstream->ch[j].streamfile = NULL;
+                }
+            }
+            vgmstream->ch[i].streamfile = NULL;
+        }
+    }
+}
+
 void close_vgmstream(VGMSTREAM* vgmstream) {
     if (!vgmstream)
         return;
@@ -282,19 +298,7 @@ void close_vgmstream(VGMSTREAM* vgmstream) {
 
 
     /* now that the special cases have had their chance, clean up the standard items */
-    for (int i = 0; i < vgmstream->channels; i++) {
-        if (vgmstream->ch[i].streamfile) {
-            close_streamfile(vgmstream->ch[i].streamfile);
-            /* Multiple channels might have the same streamfile. Find the others
-                * that are the same as this and clear them so they won't be closed again. */
-            for (int j = 0; j < vgmstream->channels; j++) {
-                if (i != j && vgmstream->ch[j].streamfile == vgmstream->ch[i].streamfile) {
-                    vgmstream->ch[j].streamfile = NULL;
-                }
-            }
-            vgmstream->ch[i].streamfile = NULL;
-        }
-    }
+    close_channel_streamfiles(vgmstream);
 
     mixer_free(vgmstream->mixer);
     state_free(vgmstream);
@@ -305,6 +309,65 @@ void close_vgmstream(VGMSTREAM* vgmstream) {
     free(vgmstream);
 }
 
+bool vgmstream_suspend(VGMSTREAM* vgmstream) {
+    if (!vgmstream || vgmstream->layout_data)
+        return false;
+    if (vgmstream->suspended)
+        return true;
+
+    /* back to the initial state so resets while suspended restore the same thing */
+    reset_vgmstream(vgmstream);
+
+    decode_free(vgmstream);
+    vgmstream->codec_data = NULL;
+    vgmstream->decode_state = NULL;
+
+    close_channel_streamfiles(vgmstream);
+    if (vgmstream->loop_ch) {
+        for (int i = 0; i < vgmstream->channels; i++) {
+            vgmstream->loop_ch[i].streamfile = NULL;
+        }
+    }
+
+    vgmstream->suspended = true;
+    setup_vgmstream(vgmstream); /* start_ch/vgmstream point to closed stuff otherwise */
+    return true;
+}
+
+bool vgmstream_resume(VGMSTREAM* vgmstream, VGMSTREAM* new_vgmstream) {
+    bool ok = false;
+
+    if (!vgmstream || !new_vgmstream || !vgmstream->suspended)
+        goto done;
+
+    /* config (loops, mixing, etc) may be different, but decoder state must be usable as-is */
+    if (new_vgmstream->layout_data
+            || new_vgmstream->channels != vgmstream->channels
+            || new_vgmstream->coding_type != vgmstream->coding_type
+            || new_vgmstream->layout_type != vgmstream->layout_type) {
+        VGM_LOG("VGMSTREAM: resumed stream doesn't match\n");
+        goto done;
+    }
+
+    /* take decoder and files (new_vgmstream is at its start state like the suspended one) */
+    memcpy(vgmstream->ch, new_vgmstream->ch, sizeof(VGMSTREAMCHANNEL) * vgmstream->channels);
+    for (int i = 0; i < new_vgmstream->channels; i++) {
+        new_vgmstream->ch[i].streamfile = NULL;
+    }
+
+    vgmstream->codec_data = new_vgmstream->codec_data;
+    vgmstream->decode_state = new_vgmstream->decode_state;
+    new_vgmstream->codec_data = NULL;
+    new_vgmstream->decode_state = NULL;
+
+    vgmstream->suspended = false;
+    setup_vgmstream(vgmstream);
+    ok = true;
+done:
+    close_vgmstream(new_vgmstream);
+    return ok;
+}
+
 void vgmstream_force_loop(VGMSTREAM* vgmstream, int loop_flag, int loop_start_sample, int loop_end_sample) {
     if (!vgmstream) return;
 
@@ -193,6 +193,7 @@ typedef struct {
     /* other config */
     bool allow_dual_stereo;         /* search for dual stereo (file_L.ext + file_R.ext = single stereo file) */
     int format_id;                  /* internal format ID */
+    bool suspended;                 /* decoder and files are closed until resumed (see vgmstream_suspend) */
 
 
     /* decoder config/state */
@@ -295,6 +296,14 @@ void vgmstream_set_loop_target(VGMSTREAM* vgmstream, int loop_target);
 
 void setup_vgmstream_play_state(VGMSTREAM* vgmstream);
 
+/* Closes the decoder and files of a simple (non-layout) VGMSTREAM, keeping its config/mixing/etc, to save
+ * memory and handles when it won't be played for a while. Must be resumed before decoding again. */
+bool vgmstream_suspend(VGMSTREAM* vgmstream);
+
+/* Resumes a suspended VGMSTREAM by taking the decoder and files of a newly opened copy of the same stream.
+ * The new VGMSTREAM is always closed. Returns false if it doesn't match (stream stays suspended). */
+bool vgmstream_resume(VGMSTREAM* vgmstream, VGMSTREAM* new_vgmstream);
+
 /* Return 1 if vgmstream detects from the filename that said file can be used even if doesn't physically exist */
 bool vgmstream_is_virtual_filename(const char* filename);
 
@@ -1,4 +1,5 @@
 #include "vgmstream_init.h"
+#include "util/timer.h"
 
 //typedef VGMSTREAM* (*init_vgmstream_t)(STREAMFILE*);
 
@@ -578,32 +579,307 @@ init_vgmstream_t init_vgmstream_functions[] = {
 #endif
 };
 
+/* Magic IDs that some parsers require at a fixed offset, checked before anything else (so they can't
+ * accept a file without them). Detection reads the header ID once and skips mismatching parsers without
+ * calling them, so most files only go through a fraction of the list (priority order stays the same).
+ * Entries must follow the same order as init_vgmstream_functions (checked in parallel as the list goes).
+ * Only add parsers whose ID check can't be bypassed (no extension-only or alt-ID paths). */
+typedef struct {
+    init_vgmstream_t init;
+    uint32_t offset;
+    const char* id;
+    const char* id_alt;     /* optional 2nd accepted ID */
+} format_signature_t;
+
+static const format_signature_t format_signatures[] = {
+    { init_vgmstream_brstm,                    0x00, "RSTM", NULL },
+    { init_vgmstream_brwav,                    0x00, "RWAV", NULL },
+    { init_vgmstream_bfwav,                    0x00, "FWAV", NULL },
+    { init_vgmstream_bcwav,                    0x00, "CWAV", NULL },
+    { init_vgmstream_rwar,                     0x00, "RWAR", NULL },
+    { init_vgmstream_nds_strm,                 0x00, "STRM", NULL },
+    { init_vgmstream_csmp,                     0x00, "CSMP", NULL },
+    { init_vgmstream_rfrm,                     0x00, "RFRM", NULL },
+    { init_vgmstream_cstr,                     0x00, "Cstr", NULL },
+    { init_vgmstream_sshd,                     0x00, "SShd", NULL },
+    { init_vgmstream_npsf,                     0x00, "NPSF", NULL },
+    { init_vgmstream_exst,                     0x00, "EXST", NULL },
+    { init_vgmstream_vag_aaap,                 0x00, "AAAp", NULL },
+    { init_vgmstream_caf,                      0x00, "CAF ", NULL },
+    { init_vgmstream_vpk,                      0x00, " KPV", NULL },
+    { init_vgmstream_genh,                     0x00, "GENH", NULL },
+    { init_vgmstream_aifc,                     0x00, "FORM", NULL },
+    { init_vgmstream_iivb,                     0x00, "BVII", NULL },
+    { init_vgmstream_riff,                     0x00, "RIFF", NULL },
+    { init_vgmstream_ea_crdf,                  0x00, "CRDF", NULL },
+    { init_vgmstream_hgc1,                     0x00, "hgC1", NULL },
+    { init_vgmstream_aus,                      0x00, "AUS ", NULL },
+    { init_vgmstream_fsb5,                     0x00, "FSB5", NULL },
+    { init_vgmstream_rwax,                     0x00, "RAWX", NULL },
+    { init_vgmstream_musc,                     0x00, "MUSC", NULL },
+    { init_vgmstream_filp,                     0x00, "FILp", NULL },
+    { init_vgmstream_ster,                     0x00, "STER", NULL },
+    { init_vgmstream_bg00,                     0x00, "BG00", NULL },
+    { init_vgmstream_dvi,                      0x00, "DVI.", NULL },
+    { init_vgmstream_rstm_rockstar,            0x00, "RSTM", NULL },
+    { init_vgmstream_aix,                      0x00, "AIXF", NULL },
+    { init_vgmstream_xmu,                      0x00, "XMU ", NULL },
+    { init_vgmstream_idvi,                     0x00, "IDVI", NULL },
+    { init_vgmstream_kraw,                     0x00, "kRAW", NULL },
+    { init_vgmstream_omu,                      0x00, "OMU ", NULL },
+    { init_vgmstream_idsp_ie,                  0x00, "IDSP", NULL },
+    { init_vgmstream_spsd,                     0x00, "SPSD", NULL },
+    { init_vgmstream_ubi_jade,                 0x00, "RIFF", NULL },
+    { init_vgmstream_riff_ima,                 0x00, "RIFF", NULL },
+    { init_vgmstream_knon,                     0x00, "KNON", NULL },
+    { init_vgmstream_gca,                      0x00, "GCA1", NULL },
+    { init_vgmstream_ish_isd,                  0x00, "I_SF", NULL },
+    { init_vgmstream_gsnd,                     0x00, "GSND", NULL },
+    { init_vgmstream_ydsp,                     0x00, "YDSP", NULL },
+    { init_vgmstream_vgs,                      0x00, "VgS!", NULL },
+    { init_vgmstream_gbts,                     0x00, "GbTs", NULL },
+    { init_vgmstream_baka,                     0x00, "BAKA", NULL },
+    { init_vgmstream_swav,                     0x00, "SWAV", NULL },
+    { init_vgmstream_smss,                     0x00, "SMSS", NULL },
+    { init_vgmstream_ads_midway,               0x00, "dhSS", NULL },
+    { init_vgmstream_hwas,                     0x00, "sawh", NULL },
+    { init_vgmstream_ssnd,                     0x00, "SSND", NULL },
+    { init_vgmstream_2dx9,                     0x00, "2DX9", NULL },
+    { init_vgmstream_gcub,                     0x00, "GCub", NULL },
+    { init_vgmstream_caff,                     0x00, "caff", NULL },
+    { init_vgmstream_dmsg,                     0x00, "RIFF", NULL },
+    { init_vgmstream_bnsf,                     0x00, "BNSF", NULL },
+    { init_vgmstream_smpl,                     0x00, "SMPL", NULL },
+    { init_vgmstream_mpds,                     0x00, "MPDS", NULL },
+    { init_vgmstream_lpcm_shade,               0x00, "LPCM", NULL },
+    { init_vgmstream_vms,                      0x00, "VMS ", NULL },
+    { init_vgmstream_cps,                      0x00, "CPS ", NULL },
+    { init_vgmstream_baf,                      0x00, "BANK", NULL },
+    { init_vgmstream_sndp,                     0x00, "SNDP", NULL },
+    { init_vgmstream_ras,                      0x00, "RAS_", NULL },
+    { init_vgmstream_xwav_new,                 0x00, "VAWX", NULL },
+    { init_vgmstream_xwav_old,                 0x00, "XWAV", NULL },
+    { init_vgmstream_hyperscan_kvag,           0x00, "KVAG", NULL },
+    { init_vgmstream_psnd,                     0x00, "PSND", NULL },
+    { init_vgmstream_adp_wildfire,             0x00, "ADP!", NULL },
+    { init_vgmstream_mtaf,                     0x00, "MTAF", NULL },
+    { init_vgmstream_alp,                      0x00, "ALP ", NULL },
+    { init_vgmstream_wpd,                      0x00, " DPW", NULL },
+    { init_vgmstream_mcss,                     0x00, "MCSS", NULL },
+    { init_vgmstream_2pfs,                     0x00, "2PFS", NULL },
+    { init_vgmstream_vbk,                      0x00, ".VBK", NULL },
+    { init_vgmstream_bcstm,                    0x00, "CSTM", NULL },
+    { init_vgmstream_madp,                     0x00, "MADP", NULL },
+    { init_vgmstream_ktss,                     0x00, "KTSS", NULL },
+    { init_vgmstream_vds_vdm,                  0x00, "VDS ", "VDM " },
+    { init_vgmstream_cxs,                      0x00, "CXS ", NULL },
+    { init_vgmstream_akb,                      0x00, "AKB ", NULL },
+    { init_vgmstream_akb2,                     0x00, "AKB2", NULL },
+    { init_vgmstream_pasx,                     0x00, "PASX", NULL },
+    { init_vgmstream_xma,                      0x00, "RIFF", NULL },
+    { init_vgmstream_sndx,                     0x00, "SXDF", "SXDS" },
+    { init_vgmstream_mpc3,                     0x00, "MPC3", NULL },
+    { init_vgmstream_ghs,                      0x00, "GHS ", NULL },
+    { init_vgmstream_va3,                      0x00, "!3AV", NULL },
+    { init_vgmstream_mta2,                     0x00, "MTA2", NULL },
+    { init_vgmstream_xa_04sw,                  0x00, "04SW", NULL },
+    { init_vgmstream_ea_bnk_fixed,             0x00, "BNKl", NULL },
+    { init_vgmstream_ea_map_mus,               0x00, "PFDx", NULL },
+    { init_vgmstream_ea_schl_fixed,            0x00, "SCHl", NULL },
+    { init_vgmstream_opus_nop,                 0x00, "sadf", NULL },
+    { init_vgmstream_opus_nus3,                0x00, "OPUS", NULL },
+    { init_vgmstream_vxn,                      0x00, "VoxN", NULL },
+    { init_vgmstream_ea_sbr,                   0x00, "SBKR", NULL },
+    { init_vgmstream_kma9,                     0x00, "KMA9", NULL },
+    { init_vgmstream_atsl,                     0x00, "ATSL", NULL },
+    { init_vgmstream_apa3,                     0x00, "APA3", NULL },
+    { init_vgmstream_sqex_sead,                0x00, "sabf", "mabf" },
+    { init_vgmstream_nxap,                     0x00, "NXAP", NULL },
+    { init_vgmstream_ea_wve_au00,              0x00, "VLC0", NULL },
+    { init_vgmstream_sthd,                     0x00, "STHD", NULL },
+    { init_vgmstream_ubi_lyn,                  0x00, "RIFF", NULL },
+    { init_vgmstream_ppst,                     0x00, "PPST", NULL },
+    { init_vgmstream_cks,                      0x00, "ckmk", NULL },
+    { init_vgmstream_ckb,                      0x00, "ckmk", NULL },
+    { init_vgmstream_hd3_bd3,                  0x00, "P3HD", NULL },
+    { init_vgmstream_sscf,                     0x00, "SSCF", NULL },
+    { init_vgmstream_msv,                      0x00, "MSVp", NULL },
+    { init_vgmstream_svgp,                     0x00, "SVGp", NULL },
+    { init_vgmstream_apc,                      0x00, "CRYO", NULL },
+    { init_vgmstream_wav2,                     0x00, "WAV2", NULL },
+    { init_vgmstream_sfxb,                     0x00, "SFXB", NULL },
+    { init_vgmstream_derf,                     0x00, "DERF", NULL },
+    { init_vgmstream_nxa1,                     0x00, "NXA1", NULL },
+    { init_vgmstream_xwma,                     0x00, "RIFF", NULL },
+    { init_vgmstream_wmsf,                     0x00, "WMSF", NULL },
+    { init_vgmstream_2msf,                     0x00, "2MSF", NULL },
+    { init_vgmstream_nwav,                     0x00, "NWAV", NULL },
+    { init_vgmstream_xpcm,                     0x00, "XPCM", NULL },
+    { init_vgmstream_msf_tamasoft,             0x00, "MSF ", NULL },
+    { init_vgmstream_opus_opusx,               0x00, "OPUS", NULL },
+    { init_vgmstream_ogg_opus,                 0x00, "OggS", NULL },
+    { init_vgmstream_gin,                      0x00, "Gnsu", "Octn" },
+    { init_vgmstream_ffdl,                     0x00, "FFDL", "mtxs" },
+    { init_vgmstream_strm_abylight,            0x00, "STRM", NULL },
+    { init_vgmstream_msf_konami,               0x00, "MSFC", NULL },
+    { init_vgmstream_xwma_konami,              0x00, "XWMA", "AMWX" },
+    { init_vgmstream_fsb5_fev_bank,            0x00, "RIFF", NULL },
+    { init_vgmstream_bwav,                     0x00, "BWAV", NULL },
+    { init_vgmstream_opus_prototype,           0x00, "OPUS", NULL },
+    { init_vgmstream_smk,                      0x00, "SMK2", "SMK4" },
+    { init_vgmstream_mzrt_v0,                  0x00, "mzrt", NULL },
+    { init_vgmstream_xavs,                     0x00, "XAVS", NULL },
+    { init_vgmstream_nub_idsp,                 0x00, "idsp", NULL },
+    { init_vgmstream_xwv_valve,                0x00, "XWV ", NULL },
+    { init_vgmstream_lrmd,                     0x00, "LRMD", NULL },
+    { init_vgmstream_ktsr,                     0x00, "KTSR", NULL },
+    { init_vgmstream_asrs,                     0x00, "ASRS", NULL },
+    { init_vgmstream_mups,                     0x00, "MUPS", NULL },
+    { init_vgmstream_ktsc,                     0x00, "KTSC", NULL },
+    { init_vgmstream_sdrh_old,                 0x00, "SDRH", NULL },
+    { init_vgmstream_opus_nsopus,              0x00, "EWNO", NULL },
+    { init_vgmstream_sbk,                      0x00, "RIFF", NULL },
+    { init_vgmstream_mzrt_v1,                  0x00, "mzrt", NULL },
+    { init_vgmstream_bsnf,                     0x00, "bsnf", NULL },
+    { init_vgmstream_sspr,                     0x00, "SSPR", NULL },
+    { init_vgmstream_piff_tpcm,                0x00, "PIFF", NULL },
+    { init_vgmstream_wxh_wxd,                  0x00, "WXH1", NULL },
+    { init_vgmstream_bnk_relic,                0x00, "BNK0", NULL },
+    { init_vgmstream_lopu_fb,                  0x00, "LOPU", NULL },
+    { init_vgmstream_lpcm_fb,                  0x00, "LPCM", NULL },
+    { init_vgmstream_wbk_nslb,                 0x00, "NSLB", NULL },
+    { init_vgmstream_ubi_ckd_cwav,             0x00, "RIFF", NULL },
+    { init_vgmstream_sspf,                     0x00, "SSPF", NULL },
+    { init_vgmstream_opus_rsnd,                0x00, "RSND", NULL },
+    { init_vgmstream_adm3,                     0x00, "ADM3", NULL },
+    { init_vgmstream_tt_ad,                    0x00, "FMT ", NULL },
+    { init_vgmstream_bw_riff_mp3,              0x00, "RIFF", NULL },
+    { init_vgmstream_sndz,                     0x00, "SNDZ", NULL },
+    { init_vgmstream_sscf_encrypted,           0x00, "SSCF", NULL },
+    { init_vgmstream_dic1,                     0x00, "DIC1", NULL },
+    { init_vgmstream_ssdd,                     0x00, "SSDD", NULL },
+    { init_vgmstream_adm2,                     0x00, "ADM2", NULL },
+    { init_vgmstream_chatterbox,               0x00, "!B0X", "CB03" },
+    { init_vgmstream_vas_rockstar,             0x00, "VAGs", "2AGs" },
+    { init_vgmstream_adp_ongakukan,            0x00, "RIFF", NULL },
+    { init_vgmstream_sdd,                      0x00, "DSBH", NULL },
+    { init_vgmstream_ka1a,                     0x00, "KA1A", NULL },
+    { init_vgmstream_pphd,                     0x00, "PPHD", NULL },
+    { init_vgmstream_xabp,                     0x00, "pBAX", NULL },
+    { init_vgmstream_i3ds,                     0x00, "i3DS", NULL },
+    { init_vgmstream_sdbs,                     0x00, "sdbs", NULL },
+    { init_vgmstream_skex,                     0x00, "SKEX", NULL },
+    { init_vgmstream_axhd,                     0x00, "AXHD", NULL },
+    { init_vgmstream_shaa,                     0x00, "SHAA", NULL },
+    { init_vgmstream_swar,                     0x00, "SWAR", NULL },
+    { init_vgmstream_mhwk,                     0x00, "MHWK", NULL },
+    { init_vgmstream_bcf1,                     0x00, "1FCB", NULL },
+    { init_vgmstream_ueba,                     0x00, "ABEU", NULL },
+    { init_vgmstream_ps2p,                     0x00, "ps2p", NULL },
+    { init_vgmstream_gcsp,                     0x00, "gcsp", NULL },
+    { init_vgmstream_plug,                     0x00, "PLUG", NULL },
+    { init_vgmstream_wmw,                      0x00, "WMW ", NULL },
+    { init_vgmstream_pxnd,                     0x00, "PXND", NULL },
+    { init_vgmstream_saud,                     0x00, "SAUD", NULL },
+    { init_vgmstream_opus_opns,                0x00, "OPNS", NULL },
+    { init_vgmstream_jaudio_baa,               0x00, "AA_<", NULL },
+    { init_vgmstream_rwsd,                     0x00, "RWSD", NULL },
+};
+
 #define LOCAL_ARRAY_LENGTH(array) (sizeof(array) / sizeof(array[0]))
 static const int init_vgmstream_count = LOCAL_ARRAY_LENGTH(init_vgmstream_functions);
+static const int format_signatures_count = LOCAL_ARRAY_LENGTH(format_signatures);
 
+static bool is_signature_valid(const format_signature_t* sig, STREAMFILE* sf, uint32_t header_id) {
+    uint32_t id = sig->offset == 0x00 ? header_id : read_u32be(sig->offset, sf);
 
-VGMSTREAM* detect_vgmstream_format(STREAMFILE* sf) {
-    if (!sf)
+    if (id == get_id32be(sig->id))
+        return true;
+    if (sig->id_alt && id == get_id32be(sig->id_alt))
+        return true;
+    return false;
+}
+
+
+/* calls a format's init function and validates the result */
+static VGMSTREAM* init_vgmstream_format(STREAMFILE* sf, int format_index) {
+    init_vgmstream_t init_vgmstream_function = init_vgmstream_functions[format_index];
+
+    /* call init function and see if valid VGMSTREAM was returned */
+    VGMSTREAM* vgmstream = init_vgmstream_function(sf);
+    if (!vgmstream)
         return NULL;
 
+    vgmstream->format_id = format_index + 1;
+
+    /* validate + setup vgmstream */
+    if (!prepare_vgmstream(vgmstream, sf)) {
+        /* keep trying if wasn't valid, as simpler formats may return a vgmstream by mistake */
+        close_vgmstream(vgmstream);
+        return NULL;
+    }
+
+    return vgmstream;
+}
+
+/* same as above but saves time and reads done by the format into the profile */
+static VGMSTREAM* init_vgmstream_format_profile(STREAMFILE* sf, int format_index, detect_profile_t* profile) {
+    if (!profile)
+        return init_vgmstream_format(sf, format_index);
+
+    if (profile->count >= init_vgmstream_count) /* shouldn't happen */
+        return NULL;
+    detect_profile_entry_t* entry = &profile->entries[profile->count];
+    profile->count++;
+
+    sf_stats_t start = profile->sf->stats;
+    int64_t time_start = timer_get_us();
+
+    VGMSTREAM* vgmstream = init_vgmstream_format(sf, format_index);
+
+    entry->format_id = format_index + 1;
+    entry->accepted = vgmstream != NULL;
+    entry->time_us = timer_get_us() - time_start;
+
+    const sf_stats_t* end = &profile->sf->stats;
+    entry->io.type = end->type;
+    entry->io.reads = end->reads - start.reads;
+    entry->io.bytes = end->bytes - start.bytes;
+    entry->io.hits = end->hits - start.hits;
+    entry->io.misses = end->misses - start.misses;
+    entry->io.seeks = end->seeks - start.seeks;
+    entry->io.reopens = end->reopens - start.reopens;
+
+    return vgmstream;
+}
+
+static VGMSTREAM* detect_vgmstream_format_internal(STREAMFILE* sf, int skip_index, detect_profile_t* profile) {
+
+    /* read once, most signatures use the same offset (returns -1 on small files, same as parsers would) */
+    uint32_t header_id = read_u32be(0x00, sf);
+    int signature_pos = 0;
+
     /* try a series of formats, see which works */
     for (int i = 0; i < init_vgmstream_count; i++) {
         init_vgmstream_t init_vgmstream_function = init_vgmstream_functions[i];
-    
-        /* call init function and see if valid VGMSTREAM was returned */
-        VGMSTREAM* vgmstream = init_vgmstream_function(sf);
-        if (!vgmstream)
-            continue;
 
-        vgmstream->format_id = i + 1;
+        /* prefilter parsers with a known magic ID */
+        if (signature_pos < format_signatures_count && format_signatures[signature_pos].init == init_vgmstream_function) {
+            const format_signature_t* sig = &format_signatures[signature_pos];
+            signature_pos++;
 
-        /* validate + setup vgmstream */
-        if (!prepare_vgmstream(vgmstream, sf)) {
-            /* keep trying if wasn't valid, as simpler formats may return a vgmstream by mistake */
-            close_vgmstream(vgmstream);
-            continue;
+            if (!is_signature_valid(sig, sf, header_id))
+                continue;
         }
 
+        /* already tried */
+        if (i == skip_index)
+            continue;
+
+        VGMSTREAM* vgmstream = init_vgmstream_format_profile(sf, i, profile);
+        if (!vgmstream)
+            continue;
+
         return vgmstream;
     }
 
@@ -611,6 +887,70 @@ VGMSTREAM* detect_vgmstream_format(STREAMFILE* sf) {
     return NULL;
 }
 
+static VGMSTREAM* detect_vgmstream_format_hint(STREAMFILE* sf, int format_id, detect_profile_t* profile) {
+    /* invalid/old IDs are ignored */
+    if (format_id <= 0 || format_id > init_vgmstream_count)
+        return detect_vgmstream_format_internal(sf, -1, profile);
+
+    VGMSTREAM* vgmstream = init_vgmstream_format_profile(sf, format_id - 1, profile);
+    if (vgmstream)
+        return vgmstream;
+
+    /* file may be something else (ID from another file or version) */
+    return detect_vgmstream_format_internal(sf, format_id - 1, profile);
+}
+
+static VGMSTREAM* detect_vgmstream_format_main(STREAMFILE* sf, int format_id, detect_profile_t* profile) {
+    STREAMFILE* sf_detect = NULL;
+
+    /* parsers mostly read small values near the start/end, keep those in memory until a format is found
+     * (wrapped so the passed SF isn't closed; formats reopen the file for decoding, so it won't be used after this) */
+    sf_detect = open_prefetch_streamfile_f(open_wrap_streamfile(sf), 0);
+    if (!sf_detect)
+        return NULL;
+
+    /* count reads done through this SF */
+    if (profile) {
+        profile->count = 0;
+        sf_detect = open_counter_streamfile_f(sf_detect);
+        if (!sf_detect)
+            return NULL;
+        profile->sf = sf_detect;
+    }
+
+    VGMSTREAM* vgmstream = detect_vgmstream_format_hint(sf_detect, format_id, profile);
+    if (profile)
+        profile->sf = NULL;
+
+    close_streamfile(sf_detect);
+    return vgmstream;
+}
+
+VGMSTREAM* detect_vgmstream_format(STREAMFILE* sf) {
+    if (!sf)
+        return NULL;
+
+    return detect_vgmstream_format_main(sf, 0, NULL);
+}
+
+VGMSTREAM* detect_vgmstream_format_id(STREAMFILE* sf, int format_id) {
+    if (!sf)
+        return NULL;
+
+    return detect_vgmstream_format_main(sf, format_id, NULL);
+}
+
+VGMSTREAM* detect_vgmstream_format_profile(STREAMFILE* sf, int format_id, detect_profile_t* profile) {
+    if (!sf || !profile || !profile->entries)
+        return NULL;
+
+    return detect_vgmstream_format_main(sf, format_id, profile);
+}
+
+int get_vgmstream_format_count(void) {
+    return init_vgmstream_count;
+}
+
 init_vgmstream_t get_vgmstream_format_init(int format_id) {
     // ID is expected to be from 1...N, to distinguish from 0 = not set
     if (format_id <= 0 || format_id > init_vgmstream_count)
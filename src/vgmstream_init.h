@@ -6,6 +6,28 @@
 
 bool prepare_vgmstream(VGMSTREAM* vgmstream, STREAMFILE* sf);
 VGMSTREAM* detect_vgmstream_format(STREAMFILE* sf);
+/* same as detect_vgmstream_format but tries format_id first (from a previous VGMSTREAM), for faster reopens */
+VGMSTREAM* detect_vgmstream_format_id(STREAMFILE* sf, int format_id);
 init_vgmstream_t get_vgmstream_format_init(int format_id);
+int get_vgmstream_format_count(void);
+
+
+/* info of a format tried during detection */
+typedef struct {
+    int format_id;
+    bool accepted;
+    int64_t time_us;        /* time spent in the format's init (includes validations) */
+    sf_stats_t io;          /* reads done to the main file (companion files aren't counted), misses = estimated buffer refills */
+} detect_profile_entry_t;
+
+typedef struct {
+    detect_profile_entry_t* entries;    /* must hold get_vgmstream_format_count() entries */
+    int count;                          /* formats tried, in order */
+
+    STREAMFILE* sf;                     /* internal */
+} detect_profile_t;
+
+/* same as detect_vgmstream_format_id, but saves time and reads done by each format tried (for profiling) */
+VGMSTREAM* detect_vgmstream_format_profile(STREAMFILE* sf, int format_id, detect_profile_t* profile);
 
 #endif